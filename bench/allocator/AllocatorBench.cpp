@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <malloc.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <afina/allocator/Error.h>
+#include <afina/allocator/Pointer.h>
+#include <afina/allocator/Pooled.h>
+#include <afina/allocator/Simple.h>
+#include <afina/allocator/SlabCache.h>
+
+using namespace Afina::Allocator;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Single step of the trace: slot gets new memory, gets resized or is freed
+struct op {
+    enum Kind : uint8_t { kAlloc, kRealloc, kFree } kind;
+    uint32_t slot;
+    uint32_t size;
+};
+
+struct trace {
+    const char *name;
+    uint32_t slots;
+    std::vector<op> ops;
+};
+
+// splitmix64, traces are the same from run to run
+struct Random {
+    uint64_t state;
+    uint64_t Next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    // Roughly log-uniform size in [min, max], small sizes are as frequent as in real heaps
+    uint32_t Size(uint32_t min, uint32_t max) {
+        double x = double(Next() >> 11) / double(1ull << 53);
+        return uint32_t(min * std::pow(double(max) / min, x));
+    }
+};
+
+// Items of a cache are replaced by new ones of random size, live set stays about the same
+trace CacheChurn(std::size_t ops) {
+    trace t{"cache churn", 20000, {}};
+    Random r{1};
+    std::vector<bool> live(t.slots);
+    for (std::size_t i = 0; i < ops; i++) {
+        uint32_t slot = r.Next() % t.slots;
+        if (live[slot]) {
+            t.ops.push_back(op{op::kFree, slot, 0});
+        }
+        t.ops.push_back(op{op::kAlloc, slot, r.Size(16, 2048)});
+        live[slot] = true;
+    }
+    return t;
+}
+
+// Buffers grow by appends until they are big enough to be sent and dropped
+trace GrowingAppends(std::size_t ops) {
+    trace t{"growing appends", 1000, {}};
+    Random r{2};
+    std::vector<uint32_t> size(t.slots);
+    for (std::size_t i = 0; i < ops; i++) {
+        uint32_t slot = r.Next() % t.slots;
+        if (size[slot] == 0) {
+            size[slot] = r.Size(16, 256);
+            t.ops.push_back(op{op::kAlloc, slot, size[slot]});
+        } else if (size[slot] > 64 * 1024) {
+            t.ops.push_back(op{op::kFree, slot, 0});
+            size[slot] = 0;
+        } else {
+            size[slot] += size[slot] / 2 + r.Size(1, 512);
+            t.ops.push_back(op{op::kRealloc, slot, size[slot]});
+        }
+    }
+    return t;
+}
+
+// Mostly small objects of random lifetime along with occasional big ones
+trace MixedSizes(std::size_t ops) {
+    trace t{"mixed sizes", 50000, {}};
+    Random r{3};
+    std::vector<bool> live(t.slots);
+    for (std::size_t i = 0; i < ops; i++) {
+        uint32_t slot = r.Next() % t.slots;
+        if (live[slot]) {
+            t.ops.push_back(op{op::kFree, slot, 0});
+            live[slot] = false;
+        } else {
+            uint32_t size = r.Next() % 32 == 0 ? r.Size(4096, 65536) : r.Size(16, 256);
+            t.ops.push_back(op{op::kAlloc, slot, size});
+            live[slot] = true;
+        }
+    }
+    return t;
+}
+
+// Writes memory the same way its user would, so that it becomes resident
+inline void Touch(void *p, std::size_t size) {
+    char *c = static_cast<char *>(p);
+    for (std::size_t i = 0; i < size; i += 4096) {
+        c[i] = char(i);
+    }
+    c[size - 1] = 1;
+}
+
+class Glibc {
+public:
+    using handle = void *;
+    static const char *Name() { return "glibc"; }
+
+    void *Alloc(handle &h, std::size_t size) { return h = std::malloc(size); }
+    void *Realloc(handle &h, std::size_t old, std::size_t size) { return h = std::realloc(h, size); }
+    void Free(handle &h, std::size_t size) {
+        std::free(h);
+        h = nullptr;
+    }
+
+    // Bytes heap took from the system
+    std::size_t Footprint() const {
+        struct mallinfo2 info = mallinfo2();
+        return info.arena + info.hblkhd;
+    }
+
+    std::string Dump() const { return ""; }
+};
+
+class SimpleArea {
+public:
+    using handle = Pointer;
+    static const char *Name() { return "Simple"; }
+
+    SimpleArea() : _size(1024ul * 1024 * 1024) {
+        _area = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (_area == MAP_FAILED) {
+            std::perror("mmap");
+            std::exit(1);
+        }
+        _simple = new Simple(_area, _size);
+    }
+
+    // Area is left to the process exit, the same as glibc heap
+    void *Alloc(handle &h, std::size_t size) {
+        Retry([&] { h = _simple->alloc(size); });
+        return h.get();
+    }
+    void *Realloc(handle &h, std::size_t old, std::size_t size) {
+        Retry([&] { _simple->realloc(h, size); });
+        return h.get();
+    }
+    void Free(handle &h, std::size_t size) { _simple->free(h); }
+
+    std::size_t Footprint() const {
+        std::string dump = _simple->dump();
+        std::size_t pos = dump.find("\"footprint\":");
+        return std::strtoull(dump.c_str() + pos + 12, nullptr, 10);
+    }
+
+    std::string Dump() const { return _simple->dump(); }
+
+private:
+    // Out of memory is handled by owner the way it is meant to: defragment and try again
+    template <typename F> void Retry(F f) {
+        try {
+            f();
+        } catch (AllocError &e) {
+            _simple->defrag();
+            f();
+        }
+    }
+
+    std::size_t _size;
+    void *_area;
+    Simple *_simple;
+};
+
+class Slab {
+public:
+    struct handle {
+        void *p = nullptr;
+    };
+    static const char *Name() { return "slab"; }
+
+    Slab() : _large(0) {}
+
+    void *Alloc(handle &h, std::size_t size) {
+        _large += size > kPooled ? size : 0;
+        return h.p = PoolAlloc(size);
+    }
+    void *Realloc(handle &h, std::size_t old, std::size_t size) {
+        void *p = PoolAlloc(size);
+        std::memcpy(p, h.p, std::min(old, size));
+        Free(h, old);
+        _large += size > kPooled ? size : 0;
+        return h.p = p;
+    }
+    void Free(handle &h, std::size_t size) {
+        _large -= size > kPooled ? size : 0;
+        PoolFree(h.p, size);
+        h.p = nullptr;
+    }
+
+    // Slabs in use along with big objects, which go to the heap
+    std::size_t Footprint() const {
+        SlabCache &cache = SlabCache::Instance();
+        return (cache.Slabs() - cache.FreeSlabs()) * SlabCache::kSlabSize + _large;
+    }
+
+    std::string Dump() const { return ""; }
+
+private:
+    static const std::size_t kPooled = 2048;
+    std::size_t _large;
+};
+
+// Resident set size of the process, current or the peak one
+std::size_t Rss(const char *field) {
+    FILE *f = std::fopen("/proc/self/status", "r");
+    char line[256];
+    std::size_t kb = 0;
+    while (f != nullptr && std::fgets(line, sizeof(line), f) != nullptr) {
+        if (std::strncmp(line, field, std::strlen(field)) == 0) {
+            kb = std::strtoull(line + std::strlen(field), nullptr, 10);
+        }
+    }
+    if (f != nullptr) {
+        std::fclose(f);
+    }
+    return kb * 1024;
+}
+
+template <typename A> void Replay(const trace &t, bool dump) {
+    // Peak RSS is counted from here
+    FILE *clear = std::fopen("/proc/self/clear_refs", "w");
+    if (clear != nullptr) {
+        std::fputs("5", clear);
+        std::fclose(clear);
+    }
+    std::size_t rss_before = Rss("VmRSS:");
+
+    A allocator;
+    std::vector<typename A::handle> handles(t.slots);
+    std::vector<uint32_t> sizes(t.slots);
+    std::vector<uint32_t> latency;
+    latency.reserve(t.ops.size());
+    std::size_t live = 0;
+
+    Clock::time_point start = Clock::now();
+    for (const op &o : t.ops) {
+        Clock::time_point begin = Clock::now();
+        void *p = nullptr;
+        switch (o.kind) {
+        case op::kAlloc:
+            p = allocator.Alloc(handles[o.slot], o.size);
+            break;
+        case op::kRealloc:
+            p = allocator.Realloc(handles[o.slot], sizes[o.slot], o.size);
+            break;
+        case op::kFree:
+            allocator.Free(handles[o.slot], sizes[o.slot]);
+            break;
+        }
+        latency.push_back(uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count()));
+
+        live -= sizes[o.slot];
+        sizes[o.slot] = o.kind == op::kFree ? 0 : o.size;
+        live += sizes[o.slot];
+        if (p != nullptr) {
+            Touch(p, o.size);
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::size_t p99 = latency.size() * 99 / 100;
+    std::nth_element(latency.begin(), latency.begin() + p99, latency.end());
+    std::size_t footprint = allocator.Footprint();
+    double fragmentation = footprint == 0 ? 0.0 : 1.0 - double(live) / double(footprint);
+
+    std::printf("  %-16s %-8s %8.2f Mops/s %8u ns p99 %8.1f MB peak RSS %6.3f fragmentation\n", t.name, A::Name(),
+                t.ops.size() / seconds / 1e6, latency[p99], (Rss("VmHWM:") - rss_before) / 1e6, fragmentation);
+    if (dump && !allocator.Dump().empty()) {
+        std::printf("%s\n", allocator.Dump().c_str());
+    }
+    std::fflush(stdout);
+}
+
+// Each allocator runs in its own process, so that peak RSS and heap state are not shared
+template <typename A> void Run(const trace &t, bool dump) {
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        Replay<A>(t, dump);
+        std::_Exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t ops = 1000000;
+    bool dump = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--dump") == 0) {
+            dump = true;
+        } else {
+            ops = std::strtoull(argv[i], nullptr, 10);
+        }
+    }
+
+    std::printf("Replaying %zu operations per trace:\n", ops);
+    for (auto make : {CacheChurn, GrowingAppends, MixedSizes}) {
+        trace t = make(ops);
+        Run<Glibc>(t, dump);
+        Run<SimpleArea>(t, dump);
+        Run<Slab>(t, dump);
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <afina/Executor.h>
+#include <afina/WorkStealingExecutor.h>
+
+using namespace Afina;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Fine grained task: few hundred nanoseconds of arithmetic. Result is kept to not let it be optimized out
+std::atomic<uint64_t> sink(0);
+std::atomic<std::size_t> done(0);
+void Work(uint64_t seed) {
+    uint64_t x = seed;
+    for (int i = 0; i < 64; i++) {
+        x = x * 6364136223846793005ull + 1442695040888963407ull;
+    }
+    sink.fetch_add(x & 1, std::memory_order_relaxed);
+    done.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Pools are made the same way: fixed number of threads, submitter waits while queue is full
+struct Central {
+    static const char *Name() { return "Executor"; }
+    Executor pool;
+    explicit Central(std::size_t threads) : pool("bench", threads, threads, 1 << 16, std::chrono::seconds(10)) {}
+};
+
+struct Stealing {
+    static const char *Name() { return "WorkStealingExecutor"; }
+    WorkStealingExecutor pool;
+    explicit Stealing(std::size_t threads) : pool("bench", threads) {}
+};
+
+// Splits range until leaves are single tasks, so that almost all tasks are submitted by pool threads
+template <typename P> void Split(P *pool, uint64_t from, uint64_t to) {
+    if (to - from == 1) {
+        Work(from);
+        return;
+    }
+    uint64_t middle = from + (to - from) / 2;
+    // Full queue can't be waited for from inside of the pool, half is run right away instead
+    if (!pool->Execute(Split<P>, pool, from, middle)) {
+        Split(pool, from, middle);
+    }
+    if (!pool->Execute(Split<P>, pool, middle, to)) {
+        Split(pool, middle, to);
+    }
+}
+
+// Returns millions of tasks per second
+template <typename P> double Run(std::size_t threads, std::size_t tasks, bool nested) {
+    P p(threads);
+    done.store(0);
+    Clock::time_point start = Clock::now();
+    if (nested) {
+        p.pool.Execute(Split<decltype(p.pool)>, &p.pool, 0, tasks);
+    } else {
+        for (std::size_t i = 0; i < tasks; i++) {
+            while (!p.pool.Execute(Work, i)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Pool can't be stopped right away: nested tasks submitted after stop would be refused
+    while (done.load(std::memory_order_relaxed) < tasks) {
+        std::this_thread::yield();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return tasks / seconds / 1e6;
+}
+
+// Nanoseconds per task to put it into the queue while the only thread is busy, one by one or in batches
+double Submit(std::size_t tasks, std::size_t batch) {
+    Executor pool("bench", 1, 1, tasks + 1, std::chrono::seconds(10));
+    std::atomic<bool> release(false);
+    pool.Execute([&release] {
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    });
+
+    std::vector<Task> buffer(batch);
+    Clock::time_point start = Clock::now();
+    for (std::size_t i = 0; i < tasks; i += batch) {
+        if (batch == 1) {
+            pool.Execute(Work, i);
+            continue;
+        }
+        for (std::size_t j = 0; j < batch; j++) {
+            buffer[j] = Task(std::bind(Work, i + j));
+        }
+        pool.ExecuteBatch(buffer.data(), batch);
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / tasks;
+
+    release.store(true);
+    pool.Stop(true);
+    return ns;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t tasks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::size_t> threads;
+    for (std::size_t n = 1; n < cores; n *= 2) {
+        threads.push_back(n);
+    }
+    threads.push_back(cores);
+
+    std::printf("Executor submission: %.1f ns per Execute, %.1f ns per task in ExecuteBatch of 64\n",
+                Submit(1 << 18, 1), Submit(1 << 18, 64));
+
+    std::printf("%zu tasks, Mtasks/s by threads:\n", tasks);
+    for (bool nested : {false, true}) {
+        std::printf("%s\n", nested ? "nested (tasks submitted by tasks)" : "flat (tasks submitted by one thread)");
+        for (std::size_t n : threads) {
+            double central = Run<Central>(n, tasks, nested);
+            double stealing = Run<Stealing>(n, tasks, nested);
+            std::printf("  %3zu threads: %-22s %8.2f  %-22s %8.2f\n", n, Central::Name(), central, Stealing::Name(),
+                        stealing);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <afina/Hash.h>
+
+using namespace Afina;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedNs(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// Key hash with explicitly given seed, so that "attacker" could know it
+struct SeededHash {
+    HashSeed seed;
+    std::size_t operator()(const std::string &key) const {
+        KeyHash h(seed);
+        h.Update(key.data(), key.size());
+        return h.Digest();
+    }
+};
+
+std::vector<std::string> MakeKeys(std::size_t n, std::size_t length) {
+    std::vector<std::string> keys;
+    keys.reserve(n);
+    for (std::size_t i = 0; i < n; i++) {
+        std::string key = "key:" + std::to_string(i * 2654435761u);
+        key.resize(length, '_');
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+template <typename F> void Throughput(const char *name, const std::vector<std::string> &keys, F hash) {
+    const int rounds = 20;
+    uint64_t sink = 0;
+
+    auto start = Clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (auto &key : keys) {
+            sink += hash(key);
+        }
+    }
+    double ns = ElapsedNs(start) / (rounds * keys.size());
+    std::printf("  %-24s %6.2f ns/key (%llx)\n", name, ns, (unsigned long long)(sink & 0xf));
+}
+
+// Inserts keys into index using given seed, returns time spent and the longest bucket
+void Flood(const char *name, const std::vector<std::string> &keys, HashSeed seed, std::size_t buckets) {
+    std::unordered_map<std::string, int, SeededHash> index(buckets, SeededHash{seed});
+
+    auto start = Clock::now();
+    for (auto &key : keys) {
+        index.emplace(key, 0);
+    }
+    double ms = ElapsedNs(start) / 1e6;
+
+    std::size_t longest = 0;
+    for (std::size_t i = 0; i < index.bucket_count(); i++) {
+        longest = std::max(longest, index.bucket_size(i));
+    }
+    std::printf("  %-24s %8.2f ms, longest bucket %zu of %zu keys\n", name, ms, longest, keys.size());
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::printf("Throughput on short keys:\n");
+    for (std::size_t length : {8, 16, 32}) {
+        std::vector<std::string> keys = MakeKeys(100000, length);
+        std::printf(" length %zu\n", length);
+        Throughput("std::hash (unkeyed)", keys, std::hash<std::string>());
+        Throughput("KeyHash (SipHash-1-3)", keys, [](const std::string &key) { return KeyHash::Of(key); });
+    }
+
+    // Attacker knows seed of the victim and searches keys that all land in the same bucket. Process with
+    // another random seed spreads the same keys evenly
+    const std::size_t n_keys = 4000;
+    const HashSeed known = {0x0123456789abcdefULL, 0xfedcba9876543210ULL};
+    const HashSeed secret = KeyHash::ProcessSeed();
+
+    std::size_t buckets = std::unordered_map<std::string, int, SeededHash>(n_keys).bucket_count();
+    SeededHash attacker{known};
+
+    std::vector<std::string> crafted;
+    for (uint64_t i = 0; crafted.size() < n_keys; i++) {
+        std::string key = "k" + std::to_string(i);
+        if (attacker(key) % buckets == 0) {
+            crafted.push_back(key);
+        }
+    }
+
+    std::printf("Hash flooding with %zu crafted keys, %zu buckets:\n", n_keys, buckets);
+    Flood("seed known to attacker", crafted, known, buckets);
+    Flood("random process seed", crafted, secret, buckets);
+    return 0;
+}
@@ -1,20 +1,38 @@
 #ifndef AFINA_THREADPOOL_H
 #define AFINA_THREADPOOL_H
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <string>
 #include <thread>
+#include <utility>
+#include <vector>
+
+#include <afina/Task.h>
 
 namespace Afina {
+namespace Concurrency {
+template <typename T> class MpmcRing;
+} // namespace Concurrency
 
 /**
  * # Thread pool
+ * Keeps at least low_watermark threads alive and grows up to high_watermark ones while tasks are waiting and
+ * no thread is free. Thread above low_watermark exits once it is idle for idle_time. Tasks are queued up to
+ * max_queue_size (rounded up to a power of two), after that Execute refuses new ones.
+ *
+ * Queue is a lock free ring of Task, so that submission takes neither lock nor memory while all threads are
+ * busy or pool is at its high watermark: mutex is only used to wake sleeping thread or start a new one.
+ *
+ * Each thread keeps histograms of queue depth it sees when takes a task, time task has waited in the queue and
+ * time it has been running. They are merged on demand by GetStats
  */
 class Executor {
+public:
     enum class State {
         // Threadpool is fully operational, tasks could be added and get executed
         kRun,
@@ -27,7 +45,8 @@ class Executor {
         kStopped
     };
 
-    Executor(std::string name, int size);
+    Executor(std::string name, std::size_t low_watermark, std::size_t high_watermark, std::size_t max_queue_size,
+             std::chrono::milliseconds idle_time);
     ~Executor();
 
     /**
@@ -40,26 +59,44 @@ class Executor {
 
     /**
      * Add function to be executed on the threadpool. Method returns true in case if task has been placed
-     * onto execution queue, i.e scheduled for execution and false otherwise.
+     * onto execution queue, i.e scheduled for execution and false otherwise: pool is stopping or queue is full.
      *
      * That function doesn't wait for function result. Function could always be written in a way to notify caller about
      * execution finished by itself
      */
     template <typename F, typename... Types> bool Execute(F &&func, Types... args) {
-        // Prepare "task"
-        auto exec = std::bind(std::forward<F>(func), std::forward<Types>(args)...);
-
-        std::unique_lock<std::mutex> lock(this->mutex);
-        if (state != State::kRun) {
-            return false;
-        }
-
-        // Enqueue new task
-        tasks.push_back(exec);
-        empty_condition.notify_one();
-        return true;
+        Task task(std::bind(std::forward<F>(func), std::forward<Types>(args)...));
+        return ExecuteBatch(&task, 1) == 1;
     }
 
+    /**
+     * Moves up to n tasks onto execution queue in order, stops at the first one which doesn't fit. Returns
+     * number of tasks placed, they are left empty. Sleeping threads are woken once for the whole batch
+     */
+    std::size_t ExecuteBatch(Task *tasks, std::size_t n);
+
+    // Number of threads alive at the moment
+    std::size_t Threads();
+
+    // Number of tasks waiting for a free thread
+    std::size_t Queued();
+
+    /**
+     * Appends pool statistics as name/value pairs prefixed by executor:<name>:, the same way as
+     * Storage::GetStats does. Times are in nanoseconds
+     */
+    void GetStats(std::vector<std::pair<std::string, std::string>> &stats);
+
+    /**
+     * Same as GetStats, rendered as a single line of space separated name=value pairs, e.g. for the log
+     */
+    std::string FormatStats();
+
+    /**
+     * Appends statistics of all the pools alive in the process
+     */
+    static void GetAllStats(std::vector<std::pair<std::string, std::string>> &stats);
+
 private:
     // No copy/move/assign allowed
     Executor(const Executor &);            // = delete;
@@ -72,6 +109,18 @@ private:
      */
     friend void perform(Executor *executor);
 
+    // Starts one more thread, mutex must be held
+    void StartThread();
+
+    // Wakes up to n sleeping threads and starts new ones if queue is still longer than number of free threads
+    void Wake(std::size_t n);
+
+    // Task along with the time it has been queued at
+    struct queued_task;
+
+    // Histograms of a single thread, see Executor.cpp
+    struct thread_stats;
+
     /**
      * Mutex to protect state below from concurrent modification
      */
@@ -83,19 +132,38 @@ private:
     std::condition_variable empty_condition;
 
     /**
-     * Vector of actual threads that perorm execution
+     * Conditional variable to await the last thread to exit in Stop
      */
-    std::vector<std::thread> threads;
+    std::condition_variable stop_condition;
 
     /**
      * Task queue
      */
-    std::deque<std::function<void()>> tasks;
+    std::unique_ptr<Concurrency::MpmcRing<queued_task>> tasks;
 
     /**
      * Flag to stop bg threads
      */
-    State state;
+    std::atomic<State> state;
+
+    // Pool name, threads are named after it
+    std::string _name;
+
+    std::size_t _low_watermark;
+    std::size_t _high_watermark;
+    std::chrono::milliseconds _idle_time;
+
+    // Threads alive and ones of them waiting for a task. Threads are detached, Stop waits for the counter instead.
+    // Changed under mutex, but read without it on submission
+    std::atomic<std::size_t> _threads;
+    std::atomic<std::size_t> _free_threads;
+
+    // Submissions in progress, threads don't exit on stop until they land in the queue
+    std::atomic<std::size_t> _submitting;
+
+    // Histograms of alive threads and the sum of ones exited, protected by mutex
+    std::vector<thread_stats *> _thread_stats;
+    std::unique_ptr<thread_stats> _exited_stats;
 };
 
 } // namespace Afina
@@ -0,0 +1,161 @@
+#ifndef AFINA_HASH_H
+#define AFINA_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace Afina {
+
+/**
+ * # Secret key of the keyed hash
+ */
+struct HashSeed {
+    uint64_t k0;
+    uint64_t k1;
+};
+
+/**
+ * # Streaming 64-bit keyed key hash
+ * Hash could be computed incrementally, byte by byte, as key arrives from the network. That allows
+ * protocol parser to get key hash for free during the single pass over input, so that storage never
+ * needs to walk over key bytes again to select shard or index bucket.
+ *
+ * Function is SipHash-1-3 keyed by the random per-process seed. Without knowing the seed client can't
+ * craft set of keys that fall into the same index bucket, and keys found to collide in one process
+ * are spread evenly in another one.
+ *
+ * Bytes are packed into 64-bit little-endian words and each full word is mixed into the state, so the
+ * result is the same regardless of how key was splitted between Update calls.
+ */
+class KeyHash {
+public:
+    KeyHash() : _seed(ProcessSeed()) { Reset(); }
+    explicit KeyHash(const HashSeed &seed) : _seed(seed) { Reset(); }
+
+    /**
+     * Random seed of the current process, generated once on the first call. Must be called at startup
+     * so that hashes never change during process lifetime
+     */
+    static const HashSeed &ProcessSeed();
+
+    /**
+     * Forget all consumed bytes, so that instance could be reused for the next key
+     */
+    inline void Reset() {
+        _v0 = _seed.k0 ^ 0x736f6d6570736575ULL;
+        _v1 = _seed.k1 ^ 0x646f72616e646f6dULL;
+        _v2 = _seed.k0 ^ 0x6c7967656e657261ULL;
+        _v3 = _seed.k1 ^ 0x7465646279746573ULL;
+        _word = 0;
+        _len = 0;
+    }
+
+    /**
+     * Consume next byte of the key
+     */
+    inline void Update(char c) {
+        _word |= uint64_t(uint8_t(c)) << ((_len & 7) * 8);
+        if ((++_len & 7) == 0) {
+            Compress(_word);
+            _word = 0;
+        }
+    }
+
+    /**
+     * Consume next size bytes of the key
+     */
+    inline void Update(const char *data, size_t size) {
+        // Complete word started by previous calls
+        while (size > 0 && (_len & 7) != 0) {
+            Update(*data++);
+            size--;
+        }
+
+        // Then go a word at a time
+        for (; size >= 8; data += 8, size -= 8) {
+            uint64_t m;
+            std::memcpy(&m, data, sizeof(m));
+            Compress(m);
+            _len += 8;
+        }
+
+        // Word is aligned here, so tail could be copied at once
+        if (size > 0) {
+            std::memcpy(&_word, data, size);
+            _len += size;
+        }
+    }
+
+    /**
+     * Returns hash of all bytes consumed so far. Doesn't change internal state
+     */
+    inline uint64_t Digest() const {
+        uint64_t v0 = _v0, v1 = _v1, v2 = _v2, v3 = _v3;
+        uint64_t b = (_len << 56) | _word;
+
+        v3 ^= b;
+        Round(v0, v1, v2, v3);
+        v0 ^= b;
+
+        v2 ^= 0xff;
+        Round(v0, v1, v2, v3);
+        Round(v0, v1, v2, v3);
+        Round(v0, v1, v2, v3);
+        return v0 ^ v1 ^ v2 ^ v3;
+    }
+
+    /**
+     * One shot hash of the whole key
+     */
+    static inline uint64_t Of(const char *data, size_t size) {
+        KeyHash h;
+        h.Update(data, size);
+        return h.Digest();
+    }
+
+    static inline uint64_t Of(const std::string &key) { return Of(key.data(), key.size()); }
+
+private:
+    static inline uint64_t Rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    static inline void Round(uint64_t &v0, uint64_t &v1, uint64_t &v2, uint64_t &v3) {
+        v0 += v1;
+        v1 = Rotl(v1, 13);
+        v1 ^= v0;
+        v0 = Rotl(v0, 32);
+        v2 += v3;
+        v3 = Rotl(v3, 16);
+        v3 ^= v2;
+        v0 += v3;
+        v3 = Rotl(v3, 21);
+        v3 ^= v0;
+        v2 += v1;
+        v1 = Rotl(v1, 17);
+        v1 ^= v2;
+        v2 = Rotl(v2, 32);
+    }
+
+    inline void Compress(uint64_t m) {
+        _v3 ^= m;
+        Round(_v0, _v1, _v2, _v3);
+        _v0 ^= m;
+    }
+
+    // Key the hash is computed with
+    HashSeed _seed;
+
+    // SipHash state of all full words consumed so far
+    uint64_t _v0, _v1, _v2, _v3;
+
+    // Bytes of the last incomplete word
+    uint64_t _word;
+
+    // Total number of bytes consumed
+    uint64_t _len;
+};
+
+} // namespace Afina
+
+#endif // AFINA_HASH_H
@@ -0,0 +1,33 @@
+#ifndef AFINA_LOADER_H
+#define AFINA_LOADER_H
+
+#include <string>
+
+namespace Afina {
+
+/**
+ * # Source of truth behind the cache
+ * Storage asks loader for the value once key is not found in cache, so that clients don't need
+ * to go to the database and set value back by themselves
+ */
+class Loader {
+public:
+    Loader() {}
+    virtual ~Loader() {}
+
+    /**
+     * Fetch value for the given key from the backing source. Method could be called concurrently
+     * from many threads, but never for the same key at the same time.
+     *
+     * Returns true and fills value if source has the key, false otherwise. Failure to reach source
+     * should be reported by exception
+     *
+     * @param key to load value for
+     * @param value output parameter to copy loaded value to
+     */
+    virtual bool Load(const std::string &key, std::string &value) = 0;
+};
+
+} // namespace Afina
+
+#endif // AFINA_LOADER_H
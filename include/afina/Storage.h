@@ -1,12 +1,73 @@
 #ifndef AFINA_STORAGE_H
 #define AFINA_STORAGE_H
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace Afina {
 
 /**
- *
+ * # Item attributes
+ * Data client supplies along with the value on write
+ */
+struct ItemInfo {
+    ItemInfo() : expire(0), soft_expire(0), flags(0), cas(0) {}
+
+    // Time (see Now) item stops to exist at, zero means never
+    uint64_t expire;
+
+    // Time (see Now) item should be refreshed at. Until expire item is still served, but marked as stale,
+    // zero means never
+    uint64_t soft_expire;
+
+    // Opaque client data returned along with the value
+    uint32_t flags;
+
+    // Version of the item, storage assigns new one on every write and ignores value passed in. Zero if
+    // storage doesn't track versions
+    uint64_t cas;
+
+    // Tags item is invalidated along with (see Storage::InvalidateTag), each is KeyHash::Of(tag)
+    std::vector<uint64_t> tags;
+
+    /**
+     * Current time in milliseconds since unix epoch
+     */
+    static inline uint64_t Now() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    /**
+     * Converts memcached <exptime> into the absolute time: zero means never expire, up to 30 days is
+     * offset in seconds from now, bigger values are unix time. Negative means already expired
+     */
+    static inline uint64_t Deadline(int32_t exptime) {
+        if (exptime == 0) {
+            return 0;
+        } else if (exptime < 0) {
+            return 1;
+        } else if (exptime <= 60 * 60 * 24 * 30) {
+            return Now() + uint64_t(exptime) * 1000;
+        } else {
+            return uint64_t(exptime) * 1000;
+        }
+    }
+
+    inline bool Expired(uint64_t now) const { return expire != 0 && now >= expire; }
+    inline bool SoftExpired(uint64_t now) const { return soft_expire != 0 && now >= soft_expire; }
+};
+
+/**
+ * # Key/value storage interface
+ * Each operation comes in a few flavors: plain one, one that takes key hash already computed by the
+ * caller (see afina/Hash.h), and one that also takes item attributes. Default implementations of more
+ * specific versions forward call to less specific ones, ignoring extra data.
  */
 class Storage {
 public:
@@ -84,6 +145,296 @@ public:
      * @param value output parameter to copy value to
      */
     virtual bool Get(const std::string &key, std::string &value) const = 0;
+
+    /**
+     * Same as Put(key, value), hash must be KeyHash::Of(key)
+     */
+    virtual bool Put(const std::string &key, uint64_t hash, const std::string &value) { return Put(key, value); }
+
+    /**
+     * Same as PutIfAbsent(key, value), hash must be KeyHash::Of(key)
+     */
+    virtual bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value) {
+        return PutIfAbsent(key, value);
+    }
+
+    /**
+     * Same as Set(key, value), hash must be KeyHash::Of(key)
+     */
+    virtual bool Set(const std::string &key, uint64_t hash, const std::string &value) { return Set(key, value); }
+
+    /**
+     * Same as Delete(key), hash must be KeyHash::Of(key)
+     */
+    virtual bool Delete(const std::string &key, uint64_t hash) { return Delete(key); }
+
+    /**
+     * Same as Get(key, value), hash must be KeyHash::Of(key)
+     */
+    virtual bool Get(const std::string &key, uint64_t hash, std::string &value) const { return Get(key, value); }
+
+    /**
+     * Same as Put(key, hash, value), item gets given attributes
+     */
+    virtual bool Put(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) {
+        return Put(key, hash, value);
+    }
+
+    /**
+     * Same as PutIfAbsent(key, hash, value), item gets given attributes
+     */
+    virtual bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) {
+        return PutIfAbsent(key, hash, value);
+    }
+
+    /**
+     * Same as Set(key, hash, value), item gets given attributes
+     */
+    virtual bool Set(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) {
+        return Set(key, hash, value);
+    }
+
+    /**
+     * Same as Get(key, hash, value), also copies item attributes into info
+     */
+    virtual bool Get(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info) const {
+        info = ItemInfo();
+        return Get(key, hash, value);
+    }
+
+    /**
+     * Outcome of Increment call
+     */
+    enum class CounterStatus {
+        // Counter updated, result is filled
+        kOk,
+
+        // There is no such key
+        kNotFound,
+
+        // Value of the key is not a decimal number
+        kNotNumber,
+
+        // New value doesn't fit into the storage, counter is left as it was
+        kNotStored
+    };
+
+    /**
+     * Treats value of the key as 64-bit unsigned decimal number and adds delta to it or subtracts delta
+     * from it. Increment wraps around at 2^64, decrement stops at zero. Item keeps its attributes.
+     *
+     * Default implementation is Get followed by Put, so it isn't atomic
+     *
+     * @param key to be updated
+     * @param hash must be KeyHash::Of(key)
+     * @param delta amount to add or subtract
+     * @param decrement true if delta should be subtracted
+     * @param result new value of the counter
+     */
+    virtual CounterStatus Increment(const std::string &key, uint64_t hash, uint64_t delta, bool decrement,
+                                    uint64_t &result) {
+        std::string value;
+        ItemInfo info;
+        if (!Get(key, hash, value, info)) {
+            return CounterStatus::kNotFound;
+        }
+        if (!ParseCounter(value, result)) {
+            return CounterStatus::kNotNumber;
+        }
+        result = ApplyDelta(result, delta, decrement);
+        return Put(key, hash, std::to_string(result), info) ? CounterStatus::kOk : CounterStatus::kNotStored;
+    }
+
+    /**
+     * Parses counter value: 1 to 20 decimal digits fitting into 64 bits
+     */
+    static bool ParseCounter(const std::string &value, uint64_t &counter) {
+        if (value.empty() || value.size() > 20) {
+            return false;
+        }
+        counter = 0;
+        for (char c : value) {
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            uint64_t next = counter * 10 + (c - '0');
+            if (next / 10 != counter) {
+                return false;
+            }
+            counter = next;
+        }
+        return true;
+    }
+
+    /**
+     * Applies delta to counter the way Increment does
+     */
+    static inline uint64_t ApplyDelta(uint64_t counter, uint64_t delta, bool decrement) {
+        if (decrement) {
+            return counter < delta ? 0 : counter - delta;
+        }
+        return counter + delta;
+    }
+
+    /**
+     * Outcome of CompareAndSwap call
+     */
+    enum class CasStatus {
+        // Value replaced
+        kStored,
+
+        // Item was changed since the caller read it
+        kExists,
+
+        // No such key
+        kNotFound,
+
+        // Value couldn't be stored
+        kNotStored
+    };
+
+    /**
+     * Replaces value of the key only if item version is still the given one (see ItemInfo::cas).
+     * Default implementation is Get followed by Put, so it isn't atomic
+     *
+     * @param cas version caller got along with the value it is replacing
+     */
+    virtual CasStatus CompareAndSwap(const std::string &key, uint64_t hash, const std::string &value,
+                                     const ItemInfo &info, uint64_t cas) {
+        std::string current;
+        ItemInfo current_info;
+        if (!Get(key, hash, current, current_info)) {
+            return CasStatus::kNotFound;
+        } else if (current_info.cas != cas) {
+            return CasStatus::kExists;
+        }
+        return Put(key, hash, value, info) ? CasStatus::kStored : CasStatus::kNotStored;
+    }
+
+    /**
+     * Appends response block of the key to out, in the form memcached get returns it:
+     * VALUE <key> <flags> <bytes>[ <cas>]\r\n
+     * <data>\r\n
+     *
+     * Default implementation formats block out of Get result, storages could keep header rendered along
+     * with the item, so that read path does no formatting at all
+     *
+     * @param key to be found
+     * @param hash must be KeyHash::Of(key)
+     * @param out buffer to append block to, left untouched if there is no such key
+     * @param versioned if item version has to be in the header, as gets returns it
+     */
+    virtual bool AppendValue(const std::string &key, uint64_t hash, std::string &out, bool versioned) const {
+        std::string value;
+        ItemInfo info;
+        if (!Get(key, hash, value, info)) {
+            return false;
+        }
+        RenderHeader(key, info.flags, value.size(), out);
+        if (versioned) {
+            AddVersion(info.cas, out);
+        }
+        out.append(value).append("\r\n");
+        return true;
+    }
+
+    /**
+     * Appends "VALUE <key> <flags> <bytes>\r\n" to out, other word could be used in place of VALUE
+     */
+    template <typename String, typename Out>
+    static void RenderHeader(const String &key, uint32_t flags, std::size_t bytes, Out &out,
+                             const char *kind = "VALUE") {
+        out.append(kind).append(" ").append(key.data(), key.size());
+        out.append(" ").append(std::to_string(flags).c_str());
+        out.append(" ").append(std::to_string(bytes).c_str()).append("\r\n");
+    }
+
+    /**
+     * Puts " <cas>" into the header RenderHeader just appended to out
+     */
+    static void AddVersion(uint64_t cas, std::string &out) {
+        out.insert(out.size() - 2, " " + std::to_string(cas));
+    }
+
+    /**
+     * Outcome of GetLeased call
+     */
+    enum class LeaseStatus {
+        // Key found, value is filled
+        kHit,
+
+        // Key not found, caller got lease token and expected to set value back by PutLeased
+        kGranted,
+
+        // Key not found, somebody else holds the lease. Caller should back off and retry
+        kHotMiss,
+
+        // Key not found or its soft TTL passed, somebody else holds the lease. Value is filled with data key
+        // had before delete or with the current one
+        kStale,
+
+        // Key found, but its soft TTL passed. Value is filled, caller got lease token and expected to refresh
+        // value by PutLeased
+        kRefresh
+    };
+
+    /**
+     * Retrive value for the given key, in case of miss only the first caller gets lease token to fill key
+     * back, others are asked to wait for a short period. That prevents miss storm from hitting the source
+     * of data behind the cache. The same applies to items those soft TTL passed, except that value is
+     * returned to everyone.
+     *
+     * Default implementation has no leases: each miss gets kGranted with zero token
+     *
+     * @param key to retrive value for
+     * @param hash must be KeyHash::Of(key)
+     * @param value output parameter to copy value to
+     * @param info output parameter, attributes of the returned value
+     * @param token output parameter, lease token in case of kGranted
+     */
+    virtual LeaseStatus GetLeased(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info,
+                                  uint64_t &token) {
+        if (Get(key, hash, value, info)) {
+            return LeaseStatus::kHit;
+        }
+        token = 0;
+        return LeaseStatus::kGranted;
+    }
+
+    /**
+     * Stores association between given key/value pair, but only if token is the valid lease returned
+     * by GetLeased on that key. Any write or delete of the key after lease is granted invalidates it.
+     *
+     * Method returns true if value was stored, false if lease is not valid anymore
+     *
+     * @param key to be associated with value
+     * @param hash must be KeyHash::Of(key)
+     * @param value to be assigned for the key
+     * @param info attributes of the new item
+     * @param token lease token got from GetLeased
+     */
+    virtual bool PutLeased(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info,
+                           uint64_t token) {
+        return Put(key, hash, value, info);
+    }
+
+    /**
+     * Invalidates all the items written with the given tag before the call (see ItemInfo::tags), cost
+     * doesn't depend on number of such items. Items written after the call are not affected.
+     *
+     * Method returns false if storage doesn't support tags, default implementation doesn't
+     *
+     * @param tag KeyHash::Of(tag)
+     */
+    virtual bool InvalidateTag(uint64_t tag) { return false; }
+
+    /**
+     * Appends storage statistics as a name/value pairs, those are reported to the clients by the
+     * stats command. Default implementation has nothing to report
+     *
+     * @param stats output parameter to append statistics to
+     */
+    virtual void GetStats(std::vector<std::pair<std::string, std::string>> &stats) const {}
 };
 
 } // namespace Afina
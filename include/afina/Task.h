@@ -0,0 +1,127 @@
+#ifndef AFINA_TASK_H
+#define AFINA_TASK_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Afina {
+
+/**
+ * # Move only callable
+ * Replacement of std::function<void()> for thread pools. Callables up to kInlineSize bytes, which is enough
+ * for std::bind of a member function with a few arguments, live right inside the task, bigger ones are placed
+ * on the heap. Task could hold move only callables, e.g. lambdas owning unique_ptr. Whole task takes single
+ * cache line
+ */
+class Task {
+public:
+    static const std::size_t kInlineSize = 48;
+
+    Task() noexcept : _ops(nullptr) {}
+
+    template <typename F, typename = typename std::enable_if<
+                              !std::is_same<typename std::decay<F>::type, Task>::value>::type>
+    Task(F &&f) : _ops(nullptr) {
+        typedef typename std::decay<F>::type Callable;
+        typedef Model<Callable, Fits<Callable>::value> Impl;
+        Impl::Create(_storage, std::forward<F>(f));
+        _ops = &Impl::ops;
+    }
+
+    Task(Task &&other) noexcept : _ops(other._ops) {
+        if (_ops != nullptr) {
+            _ops->move(&other._storage, &_storage);
+            other._ops = nullptr;
+        }
+    }
+
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            Reset();
+            if (other._ops != nullptr) {
+                other._ops->move(&other._storage, &_storage);
+                _ops = other._ops;
+                other._ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    ~Task() { Reset(); }
+
+    explicit operator bool() const { return _ops != nullptr; }
+
+    // Runs callable, task must not be empty
+    void operator()() { _ops->invoke(&_storage); }
+
+    // Destroys callable along with everything it captured
+    void Reset() {
+        if (_ops != nullptr) {
+            _ops->destroy(&_storage);
+            _ops = nullptr;
+        }
+    }
+
+private:
+    Task(const Task &);            // = delete;
+    Task &operator=(const Task &); // = delete;
+
+    struct Ops {
+        void (*invoke)(void *storage);
+        // Moves callable to the uninitialized storage and destroys the source one
+        void (*move)(void *from, void *to);
+        void (*destroy)(void *storage);
+    };
+
+    typedef std::aligned_storage<kInlineSize, alignof(std::max_align_t)>::type Storage;
+
+    // Moving inline callable must not throw, otherwise task move could fail half way
+    template <typename F> struct Fits {
+        static const bool value = sizeof(F) <= kInlineSize && alignof(F) <= alignof(std::max_align_t) &&
+                                  std::is_nothrow_move_constructible<F>::value;
+    };
+
+    template <typename F, bool Inline> struct Model;
+
+    Storage _storage;
+    const Ops *_ops;
+};
+
+// Callable lives in the task storage
+template <typename F> struct Task::Model<F, true> {
+    template <typename G> static void Create(Storage &storage, G &&f) { ::new (&storage) F(std::forward<G>(f)); }
+
+    static void Invoke(void *storage) { (*static_cast<F *>(storage))(); }
+    static void Move(void *from, void *to) {
+        F *f = static_cast<F *>(from);
+        ::new (to) F(std::move(*f));
+        f->~F();
+    }
+    static void Destroy(void *storage) { static_cast<F *>(storage)->~F(); }
+
+    static const Ops ops;
+};
+
+template <typename F> const Task::Ops Task::Model<F, true>::ops = {Invoke, Move, Destroy};
+
+// Storage keeps pointer to the callable on the heap
+template <typename F> struct Task::Model<F, false> {
+    template <typename G> static void Create(Storage &storage, G &&f) {
+        ::new (&storage) F *(new F(std::forward<G>(f)));
+    }
+
+    static F *&Get(void *storage) { return *static_cast<F **>(storage); }
+    static void Invoke(void *storage) { (*Get(storage))(); }
+    static void Move(void *from, void *to) { ::new (to) F *(Get(from)); }
+    static void Destroy(void *storage) { delete Get(storage); }
+
+    static const Ops ops;
+};
+
+template <typename F> const Task::Ops Task::Model<F, false>::ops = {Invoke, Move, Destroy};
+
+} // namespace Afina
+
+#endif // AFINA_TASK_H
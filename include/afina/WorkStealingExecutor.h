@@ -0,0 +1,99 @@
+#ifndef AFINA_WORK_STEALING_EXECUTOR_H
+#define AFINA_WORK_STEALING_EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Afina {
+
+/**
+ * # Work stealing thread pool
+ * Same interface as Executor, but made for lots of short tasks. Each thread owns a deque: tasks submitted from
+ * inside the pool go to the bottom of the current thread deque and are taken back in LIFO order, while idle
+ * threads steal from the top of random victims. Tasks submitted from outside go to the shared injection queue.
+ * Number of threads is fixed
+ */
+class WorkStealingExecutor {
+public:
+    WorkStealingExecutor(std::string name, std::size_t size);
+    ~WorkStealingExecutor();
+
+    /**
+     * Signal thread pool to stop, it will stop accepting new jobs and close threads once there is no more work.
+     * All enqueued jobs will be complete, including ones they submit.
+     *
+     * In case if await flag is true, call won't return until all background jobs are done and all threads are stopped.
+     * Must not be called from the pool thread
+     */
+    void Stop(bool await = false);
+
+    /**
+     * Add function to be executed on the threadpool. Method returns true in case if task has been placed
+     * onto execution queue and false if pool is stopped
+     */
+    template <typename F, typename... Types> bool Execute(F &&func, Types... args) {
+        std::unique_ptr<std::function<void()>> task(
+            new std::function<void()>(std::bind(std::forward<F>(func), std::forward<Types>(args)...)));
+        if (!Push(task.get())) {
+            return false;
+        }
+        task.release();
+        return true;
+    }
+
+    // Number of tasks taken from other threads deques so far
+    std::size_t Steals() const { return _steals.load(std::memory_order_relaxed); }
+
+    // Pool thread along with its deque, defined by implementation
+    struct Worker;
+
+private:
+    // No copy/move/assign allowed
+    WorkStealingExecutor(const WorkStealingExecutor &);            // = delete;
+    WorkStealingExecutor &operator=(const WorkStealingExecutor &); // = delete;
+
+    // Places task to the current thread deque or to the injection queue, takes ownership on success
+    bool Push(std::function<void()> *task);
+
+    // Main function of the pool thread
+    void Perform(Worker *worker);
+
+    // Looks for a task: own deque, injection queue, other deques
+    std::function<void()> *Find(Worker *worker);
+
+    // Wakes one sleeping thread if there is any
+    void Wake();
+
+    std::string _name;
+
+    // Threads with their deques
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    // Tasks submitted from outside of the pool
+    std::mutex _mutex;
+    std::deque<std::function<void()> *> _injected;
+
+    // Size of the injection queue, lets threads skip the mutex when it is empty
+    std::atomic<std::size_t> _injected_size;
+
+    // Threads sleep here once there is nothing to run or steal
+    std::condition_variable _sleep;
+    std::atomic<std::size_t> _sleepers;
+
+    // Tasks submitted but not finished yet, pool could stop only once it is zero
+    std::atomic<std::size_t> _pending;
+
+    std::atomic<bool> _running;
+    std::atomic<std::size_t> _steals;
+};
+
+} // namespace Afina
+
+#endif // AFINA_WORK_STEALING_EXECUTOR_H
@@ -0,0 +1,105 @@
+#ifndef AFINA_ALLOCATOR_ARENA_H
+#define AFINA_ALLOCATOR_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * # Bump arena for short living objects
+ * Memory is taken by moving pointer forward inside the current chunk, deallocate does nothing and all the
+ * memory is given back at once by Reset. Chunks are kept across Reset, so that arena which has seen the
+ * largest request once never goes to the heap again. Requests bigger than chunk get chunk of their own,
+ * those are released on Reset.
+ *
+ * Objects could be created by New and owned by ptr, which runs destructor only. Everything living in the
+ * arena must be destroyed before Reset.
+ *
+ * That is NOT thread safe implementaiton!!
+ */
+class Arena {
+public:
+    // Deleter for objects created by New, memory itself stays until Reset
+    struct Destroy {
+        template <typename T> void operator()(T *p) const { p->~T(); }
+    };
+
+    template <typename T> using ptr = std::unique_ptr<T, Destroy>;
+
+    /**
+     * @param chunk_size size of chunks memory is bumped from
+     */
+    Arena(std::size_t chunk_size = 16 * 1024);
+    ~Arena();
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    /**
+     * Arena that takes all the memory from the heap and frees it on deallocate, containers whose allocator
+     * isn't given any arena use it. Thread safe
+     */
+    static Arena &Default();
+
+    /**
+     * Returns N bytes aligned to 16, throws std::bad_alloc if there is no memory
+     * @param N size_t
+     */
+    void *allocate(std::size_t N);
+
+    /**
+     * Does nothing, memory is released by Reset
+     */
+    void deallocate(void *p, std::size_t N);
+
+    /**
+     * Creates object in the arena
+     */
+    template <typename T, typename... Args> ptr<T> New(Args &&... args) {
+        return ptr<T>(::new (allocate(sizeof(T))) T(std::forward<Args>(args)...));
+    }
+
+    /**
+     * Makes all the memory free again
+     */
+    void Reset();
+
+    /**
+     * Number of bytes given out since the last Reset
+     */
+    inline std::size_t Used() const { return _used; }
+
+    /**
+     * Number of bytes arena holds
+     */
+    inline std::size_t Capacity() const { return _capacity; }
+
+private:
+    struct chunk;
+
+    // Moves to the next chunk, taking new one if there is no unused chunk left
+    void Grow();
+
+    const std::size_t _chunk_size;
+
+    // Chunks of _chunk_size, memory is bumped from _current one, the ones after it are unused
+    chunk *_first;
+    chunk *_current;
+    char *_pos;
+    char *_end;
+
+    // Chunks taken for big requests
+    chunk *_big;
+
+    std::size_t _used;
+    std::size_t _capacity;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_ARENA_H
@@ -0,0 +1,105 @@
+#ifndef AFINA_ALLOCATOR_MEMPOOL_H
+#define AFINA_ALLOCATOR_MEMPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * # Pool of fixed size objects
+ * Objects are carved out of slabs taken from SlabCache. Each thread keeps its own cache of free objects,
+ * so that Alloc and Free touch neither locks nor atomics while cache isn't empty or full. Cache is
+ * refilled from and flushed to the pool by batches of kBatch objects under the pool lock. Slab all the
+ * objects of which are back in the pool goes back to SlabCache.
+ *
+ * Object freed by one thread could be allocated by another. Objects cached by a thread go back to the
+ * pool when thread exits. Pool must outlive all the objects allocated from it.
+ *
+ * Thread safe
+ */
+class Mempool {
+public:
+    // Number of objects moved between thread cache and pool at once
+    static const uint32_t kBatch = 32;
+
+    // Maximum number of pools existing at the same time
+    static const std::size_t kMaxPools = 128;
+
+    /**
+     * @param size of each object, rounded up to 16 bytes
+     */
+    Mempool(std::size_t size);
+    ~Mempool();
+
+    Mempool(const Mempool &) = delete;
+    Mempool &operator=(const Mempool &) = delete;
+
+    /**
+     * Returns memory for one object, throws std::bad_alloc if there is no memory
+     */
+    void *Alloc();
+
+    /**
+     * Gives object memory back, it could be allocated by any thread
+     */
+    void Free(void *p);
+
+    /**
+     * Object size pool gives out
+     */
+    inline std::size_t size() const { return _size; }
+
+    /**
+     * Number of slabs pool holds
+     */
+    std::size_t Slabs() const;
+
+    /**
+     * Number of objects allocated and not returned to the pool, objects in thread caches included
+     */
+    std::size_t Used() const;
+
+private:
+    struct slab;
+    struct thread_cache;
+    friend struct thread_cache;
+
+    // Moves up to kBatch free objects into the list, returns number of objects moved
+    uint32_t Refill(void *&list);
+
+    // Returns count objects of the list back to their slabs
+    void Flush(void *list, uint32_t count);
+
+    // Takes object out of the slab, nullptr if it is full
+    void *Take(slab *s);
+
+    void Push(slab *&list, slab *s);
+    void Remove(slab *&list, slab *s);
+
+    const std::size_t _size;
+
+    // Offset of the first object in slab and number of objects slab holds
+    const std::size_t _offset;
+    const uint32_t _capacity;
+
+    // Index in thread caches and unique id of pool, so that cache entry left from destroyed pool is
+    // never taken for the new one
+    std::size_t _index;
+    uint64_t _id;
+
+    mutable std::mutex _mt;
+
+    // Slabs having free objects and slabs that are full
+    slab *_partial;
+    slab *_full;
+    std::size_t _slabs;
+    std::size_t _used;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_MEMPOOL_H
@@ -7,6 +7,13 @@ namespace Allocator {
 // to avoid expensive macros calculations and increase compile speed
 class Simple;
 
+/**
+ * Handle of the memory allocated by Simple. It points to the allocator's descriptor slot, not to the
+ * memory itself, so that allocator is free to move data around: get() always returns current address.
+ *
+ * Copies of pointer refer to the same memory. Once memory is freed through one of them, the rest are
+ * dangling, the same way raw pointers are
+ */
 class Pointer {
 public:
     Pointer();
@@ -17,7 +24,19 @@ public:
     Pointer &operator=(const Pointer &);
     Pointer &operator=(Pointer &&);
 
-    void *get() const { return 0; }
+    /**
+     * Current address of the memory, nullptr for empty pointer. Stays valid until the next call to the
+     * allocator which could move memory: realloc or defrag
+     */
+    void *get() const { return _slot ? *_slot : nullptr; }
+
+private:
+    friend class Simple;
+
+    explicit Pointer(void **slot) : _slot(slot) {}
+
+    // Descriptor slot in allocator's table, nullptr if pointer is empty
+    void **_slot;
 };
 
 } // namespace Allocator
@@ -0,0 +1,34 @@
+#ifndef AFINA_ALLOCATOR_POOLED_H
+#define AFINA_ALLOCATOR_POOLED_H
+
+#include <cstddef>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * Returns memory from process wide Mempool of the size class given size falls into, sizes over 2KB go to
+ * the global operator new. Throws std::bad_alloc if there is no memory
+ */
+void *PoolAlloc(std::size_t size);
+
+/**
+ * Gives memory got from PoolAlloc back, size must be the same
+ */
+void PoolFree(void *p, std::size_t size) noexcept;
+
+/**
+ * # Base for objects allocated from pools
+ * Class inheriting Pooled gets its instances allocated by PoolAlloc instead of malloc.
+ *
+ * Thread safe, object could be deleted by any thread
+ */
+struct Pooled {
+    static void *operator new(std::size_t size);
+    static void operator delete(void *p, std::size_t size) noexcept;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_POOLED_H
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <cstddef>
+#include <cstdint>
 
 namespace Afina {
 namespace Allocator {
@@ -18,44 +19,137 @@ class Pointer;
  * Allocator instance doesn't take ownership of wrapped memmory and do not delete it
  * on destruction. So caller must take care of resource cleaup after allocator stop
  * being needs
+ *
+ * Blocks are laid out from the beginning of the area one after another, each with 16 byte header that
+ * keeps sizes of the block and of the previous one, so that neighbours are found in O(1) and freed
+ * blocks are coalesced right away. Free blocks form first-fit list, space above the last block is taken
+ * only if no free block fits. Pointer refers to the descriptor slot in the table growing down from the
+ * end of the area, so that defrag could slide blocks towards the beginning and fix up one slot per move.
+ *
+ * Memory could also be taken by raw pointer through allocate/deallocate, as StdAllocator does to let
+ * standard containers live in the area. Such blocks have no slot and are pinned: defrag never moves
+ * them and leaves free space right below them where it is.
+ *
+ * That is NOT thread safe implementaiton!!
  */
-// TODO: Implements interface to allow usage as C++ allocators
 class Simple {
 public:
     Simple(void *base, const size_t size);
 
     /**
-     * TODO: semantics
+     * Allocates N bytes aligned to 16, throws AllocError of NoMemory type if there is no free block big
+     * enough. Doesn't defragment on its own, see defrag
      * @param N size_t
      */
     Pointer alloc(size_t N);
 
     /**
-     * TODO: semantics
+     * Changes size of the memory keeping its content up to the smaller of sizes. Grows in place if
+     * the next block is free or the memory is the last one, otherwise moves data into new block. Empty
+     * pointer gets new memory. In case of NoMemory error pointer is left untouched
      * @param p Pointer
      * @param N size_t
      */
     void realloc(Pointer &p, size_t N);
 
     /**
-     * TODO: semantics
+     * Releases memory and makes pointer empty, empty pointer is ignored. Throws AllocError of InvalidFree
+     * type if pointer doesn't refer to the memory of this allocator
      * @param p Pointer
      */
     void free(Pointer &p);
 
     /**
-     * TODO: semantics
+     * Allocates N bytes aligned to 16 that are never moved, throws AllocError of NoMemory type if there
+     * is no free block big enough
+     * @param N size_t
+     */
+    void *allocate(size_t N);
+
+    /**
+     * Releases memory got from allocate, nullptr is ignored. Throws AllocError of InvalidFree type if
+     * it isn't pinned memory of this allocator
+     * @param p void*
+     * @param N size_t size memory was allocated with, isn't required to release it
+     */
+    void deallocate(void *p, size_t N = 0);
+
+    /**
+     * Moves all the blocks to the beginning of the area, so that free space becomes single block
      */
     void defrag();
 
     /**
-     * TODO: semantics
+     * Same as defrag, but stops once at least max_bytes were moved, so that it could be called between
+     * other work with bounded pause. Next call continues from where previous one stopped, blocks
+     * allocated and freed in between are taken into account.
+     *
+     * Returns true if there is nothing to move anymore
+     */
+    bool defrag(size_t max_bytes);
+
+    /**
+     * Returns fragmentation map of the area as single line JSON object:
+     * - "area": number of bytes allocator manages
+     * - "used", "pinned", "free": bytes in blocks of each kind, headers included
+     * - "wilderness": bytes between the last block and descriptor table, "table": bytes the table takes
+     * - "footprint": bytes ever touched, that is the area up to the last block along with the table
+     * - "blocks", "free_blocks", "largest_free": counts of blocks and the biggest free space in bytes
+     * - "fragmentation": 1 - largest_free / (free + wilderness), zero means all free memory is contiguous
+     * - "map": runs of adjacent blocks of the same kind as [kind, offset, bytes], where kind is "U" for used,
+     *   "P" for pinned, "F" for free, "W" for wilderness and "T" for the table, offsets are from the
+     *   beginning of the area
      */
     std::string dump() const;
 
 private:
+    struct block;
+
+    // Slot is in the table and refers to the block in use
+    bool Owns(void **slot) const;
+
+    // Returns unused descriptor slot, the table is grown if there is no one
+    void **TakeSlot();
+
+    // Free slots are chained through themselves, marked by the low bit
+    void ReleaseSlot(void **slot);
+
+    // Finds space for the block of given number of units, either in free list or above the last block.
+    // Returned block is in use and has exactly that size. nullptr if there is no space
+    block *Place(uint32_t units, bool need_slot);
+
+    // Cuts block down to given number of units, the rest is released
+    void Split(block *b, uint32_t units);
+
+    // Marks block free and merges it with free neighbours
+    void Release(block *b);
+
+    // Previous block size is kept in the header of the next block, or in _top_prev for the last one
+    void SetNextPrev(block *b, uint32_t units);
+
+    void Link(block *b);
+    void Unlink(block *b);
+
     void *_base;
     const size_t _base_len;
+
+    // Blocks are in [_start, _top), free space between _top and the table
+    block *_start;
+    block *_top;
+
+    // Size of the block just below _top, zero if there are no blocks
+    uint32_t _top_prev;
+
+    // Descriptor table grows down from _table_end
+    void **_table_end;
+    size_t _slots;
+    void **_free_slots;
+
+    // First-fit list of free blocks
+    block *_free;
+
+    // There are no free blocks below that one but ones followed by pinned block, defrag continues from there
+    block *_cursor;
 };
 
 } // namespace Allocator
@@ -0,0 +1,68 @@
+#ifndef AFINA_ALLOCATOR_SLAB_ARENA_H
+#define AFINA_ALLOCATOR_SLAB_ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * # Bounded account over pooled memory
+ * Takes memory from size class pools (see PoolAlloc) and keeps track of how much of it is in use, so
+ * that a group of objects could be limited and reported on as a whole. Meant to be used through
+ * StdAllocator by containers.
+ *
+ * Thread safe
+ */
+class SlabArena {
+public:
+    /**
+     * @param limit number of bytes could be in use at once, zero means no limit
+     */
+    SlabArena(std::size_t limit = 0) : _limit(limit), _used(0), _peak(0) {}
+
+    /**
+     * Unbounded arena shared by the process, containers whose allocator isn't given any arena use it
+     */
+    static SlabArena &Default();
+
+    SlabArena(const SlabArena &) = delete;
+    SlabArena &operator=(const SlabArena &) = delete;
+
+    /**
+     * Returns N bytes aligned to 16, throws std::bad_alloc if limit is exceeded or there is no memory
+     * @param N size_t
+     */
+    void *allocate(std::size_t N);
+
+    /**
+     * Gives memory back, N must be the same it was allocated with
+     * @param p void*
+     * @param N size_t
+     */
+    void deallocate(void *p, std::size_t N);
+
+    /**
+     * Number of bytes in use
+     */
+    inline std::size_t Used() const { return _used.load(std::memory_order_relaxed); }
+
+    /**
+     * Maximum number of bytes ever been in use
+     */
+    inline std::size_t Peak() const { return _peak.load(std::memory_order_relaxed); }
+
+    inline std::size_t Limit() const { return _limit; }
+
+private:
+    const std::size_t _limit;
+    std::atomic<std::size_t> _used;
+    std::atomic<std::size_t> _peak;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_SLAB_ARENA_H
@@ -0,0 +1,72 @@
+#ifndef AFINA_ALLOCATOR_SLAB_CACHE_H
+#define AFINA_ALLOCATOR_SLAB_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * # Process wide source of slabs
+ * Slab is kSlabSize bytes aligned to its size, so that owner of any address inside could be found by
+ * masking low bits. Slabs are carved out of kChunkSize chunks mapped from the OS, and returned ones are
+ * kept in lock free stack for reuse by any pool. Memory is never given back to the OS.
+ *
+ * Thread safe, lock is taken only to map new chunk
+ */
+class SlabCache {
+public:
+    static const std::size_t kSlabSize = 64 * 1024;
+    static const std::size_t kChunkSize = 4 * 1024 * 1024;
+
+    /**
+     * Cache shared by all the pools
+     */
+    static SlabCache &Instance();
+
+    /**
+     * Returns free slab, throws std::bad_alloc if there is no memory
+     */
+    void *Get();
+
+    /**
+     * Gives slab back, it must not be used anymore
+     */
+    void Put(void *slab);
+
+    /**
+     * Number of slabs mapped so far
+     */
+    inline std::size_t Slabs() const { return _slabs.load(std::memory_order_relaxed); }
+
+    /**
+     * Number of slabs waiting for reuse
+     */
+    inline std::size_t FreeSlabs() const { return _free_slabs.load(std::memory_order_relaxed); }
+
+private:
+    SlabCache() : _head(0), _slabs(0), _free_slabs(0) {}
+
+    // Free slab keeps the next one in its first word
+    struct free_slab {
+        uintptr_t next;
+    };
+
+    // Pops slab from stack, nullptr if it is empty
+    void *Pop();
+
+    // Top of stack: slab address with ABA counter in low bits, slabs are aligned so that bits are zero
+    std::atomic<uintptr_t> _head;
+
+    std::mutex _map_mt;
+    std::atomic<std::size_t> _slabs;
+    std::atomic<std::size_t> _free_slabs;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_SLAB_CACHE_H
@@ -0,0 +1,64 @@
+#ifndef AFINA_ALLOCATOR_STD_ALLOCATOR_H
+#define AFINA_ALLOCATOR_STD_ALLOCATOR_H
+
+#include <cstddef>
+#include <type_traits>
+
+#include <afina/allocator/SlabArena.h>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * # Standard allocator over Afina arena
+ * Lets standard containers (std::basic_string, std::vector, std::map, ...) take their memory from the
+ * given arena. Arena is any class having
+ * - void *allocate(size_t bytes): memory aligned to 16 bytes, throws if there is no one
+ * - void deallocate(void *p, size_t bytes)
+ * so both Simple and SlabArena fit. Allocator only refers to arena, which has to outlive all containers
+ * using it. Default constructed allocator refers to Arena::Default(), if arena has one.
+ *
+ * Allocators are equal if they refer to the same arena. Arena follows container on copy, move and swap,
+ * so that memory is always released to the arena it was taken from.
+ */
+template <typename T, typename Arena = SlabArena> class StdAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    template <typename U> struct rebind { using other = StdAllocator<U, Arena>; };
+
+    StdAllocator() : _arena(&Arena::Default()) {}
+    StdAllocator(Arena &arena) : _arena(&arena) {}
+
+    template <typename U> StdAllocator(const StdAllocator<U, Arena> &other) : _arena(other._arena) {}
+
+    T *allocate(std::size_t n) {
+        static_assert(alignof(T) <= 16, "Arena memory is only aligned to 16 bytes");
+        return static_cast<T *>(_arena->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, std::size_t n) { _arena->deallocate(p, n * sizeof(T)); }
+
+    inline Arena &arena() const { return *_arena; }
+
+    template <typename U> bool operator==(const StdAllocator<U, Arena> &other) const {
+        return _arena == other._arena;
+    }
+
+    template <typename U> bool operator!=(const StdAllocator<U, Arena> &other) const {
+        return _arena != other._arena;
+    }
+
+private:
+    template <typename U, typename A> friend class StdAllocator;
+
+    Arena *_arena;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_STD_ALLOCATOR_H
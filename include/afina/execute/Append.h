@@ -22,6 +22,8 @@ namespace Execute {
 class Append : public InsertCommand {
 public:
     Append(const std::string &key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
+    Append(const std::string &key, uint64_t hash, uint32_t flags, int32_t expire, int32_t soft_expire = 0)
+        : InsertCommand(key, hash, flags, expire, soft_expire) {}
     ~Append() {}
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
@@ -0,0 +1,42 @@
+#ifndef AFINA_EXECUTE_CAS_H
+#define AFINA_EXECUTE_CAS_H
+
+#include <cstdint>
+#include <string>
+
+#include "InsertCommand.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Check and set
+ * Stores value for the key only if nobody has updated it since the caller last fetched it: <cas unique>
+ * must be the item version returned by gets
+ *
+ * Command must write result to the output, which could be:
+ * - "STORED", to indicate success.
+ * - "EXISTS" to indicate that the item was modified since it was fetched
+ * - "NOT_FOUND" to indicate that the item did not exist or has been deleted
+ * - "NOT_STORED" if value couldn't be stored
+ */
+class Cas : public InsertCommand {
+public:
+    Cas(const std::string &key, uint32_t flags, int32_t expire, uint64_t cas)
+        : Cas(key, KeyHash::Of(key), flags, expire, cas) {}
+    Cas(const std::string &key, uint64_t hash, uint32_t flags, int32_t expire, uint64_t cas, int32_t soft_expire = 0)
+        : InsertCommand(key, hash, flags, expire, soft_expire), _cas(cas) {}
+    ~Cas() {}
+
+    inline uint64_t cas() const { return _cas; }
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    const uint64_t _cas;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_CAS_H
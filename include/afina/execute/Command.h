@@ -3,6 +3,8 @@
 
 #include <string>
 
+#include <afina/allocator/Pooled.h>
+
 namespace Afina {
 
 class Storage;
@@ -10,15 +12,22 @@ class Storage;
 namespace Execute {
 
 /**
- *
- *
+ * # Parsed command
+ * Commands are created for each request, so they are allocated from pools
  */
-class Command {
+class Command : public Allocator::Pooled {
 public:
     Command() {}
     virtual ~Command() {}
 
     virtual void Execute(Storage &storage, const std::string &args, std::string &out) = 0;
+
+    /**
+     * Same as Execute, but args is data block the way it came from client, followed by \r\n, or empty if
+     * command has no data. Block that doesn't end with \r\n means client has sent wrong number of bytes, it is
+     * rejected with CLIENT_ERROR and command isn't run. Terminator is stripped from args
+     */
+    void ExecuteBlock(Storage &storage, std::string &args, std::string &out);
 };
 
 } // namespace Execute
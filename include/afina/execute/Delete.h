@@ -1,6 +1,11 @@
 #ifndef AFINA_EXECUTE_DELETE_H
 #define AFINA_EXECUTE_DELETE_H
 
+#include <cstdint>
+#include <string>
+
+#include <afina/Hash.h>
+
 #include "Command.h"
 
 namespace Afina {
@@ -17,10 +22,18 @@ namespace Execute {
  */
 class Delete : public Command {
 public:
-    Delete();
-    ~Delete();
+    Delete(const std::string &key) : Delete(key, KeyHash::Of(key)) {}
+    Delete(const std::string &key, uint64_t hash) : _key(key), _hash(hash) {}
+    ~Delete() {}
+
+    inline const std::string &key() const { return _key; }
+    inline uint64_t hash() const { return _hash; }
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    const std::string _key;
+    const uint64_t _hash;
 };
 
 } // namespace Execute
@@ -1,9 +1,14 @@
 #ifndef AFINA_EXECUTE_GET_H
 #define AFINA_EXECUTE_GET_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
+#include <afina/Hash.h>
+#include <afina/allocator/Arena.h>
+#include <afina/allocator/StdAllocator.h>
+
 #include "Command.h"
 
 namespace Afina {
@@ -18,13 +23,14 @@ namespace Execute {
  * the items have been transmitted, the server sends the string
  *
  * Each item sent by the server looks like this:
- * VALUE <key> <bytes>\r\n
+ * VALUE <key> <flags> <bytes>[ <cas unique>]\r\n
  * <data>\r\n
  * VALUE ....
  * END
  *
  * Where <key> is the key for the value, <bytes> is the number of bytes in the
- * value and <data> is the value text
+ * value and <data> is the value text. <cas unique> is sent by gets only, it is the item version
+ * cas command takes
  *
  * If some of the keys appearing in a retrieval request are not sent back
  * by the server in the item list this means that the server does not
@@ -34,15 +40,37 @@ namespace Execute {
  */
 class Get : public Command {
 public:
-    Get(const std::vector<std::string> &keys) : _keys(keys) {}
+    // Lists of keys are taken from the arena command is created in, see Parser::Build
+    using keys_type = std::vector<std::string, Allocator::StdAllocator<std::string, Allocator::Arena>>;
+    using hashes_type = std::vector<uint64_t, Allocator::StdAllocator<uint64_t, Allocator::Arena>>;
+
+    Get(const std::vector<std::string> &keys, bool versioned = false)
+        : _keys(keys.begin(), keys.end()), _versioned(versioned) {
+        _hashes.reserve(keys.size());
+        for (auto &key : keys) {
+            _hashes.push_back(KeyHash::Of(key));
+        }
+    }
+    Get(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes, bool versioned = false,
+        Allocator::Arena &arena = Allocator::Arena::Default())
+        : _keys(keys.begin(), keys.end(), arena), _hashes(hashes.begin(), hashes.end(), arena),
+          _versioned(versioned) {}
     ~Get() {}
 
-    inline const std::vector<std::string> &keys() const { return _keys; }
+    inline const keys_type &keys() const { return _keys; }
+    inline const hashes_type &hashes() const { return _hashes; }
+    inline bool versioned() const { return _versioned; }
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
 
 private:
-    std::vector<std::string> _keys;
+    keys_type _keys;
+
+    // Hash of each key, in the same order as keys
+    hashes_type _hashes;
+
+    // Set for gets, that returns item versions
+    bool _versioned;
 };
 
 } // namespace Execute
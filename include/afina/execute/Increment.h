@@ -0,0 +1,49 @@
+#ifndef AFINA_EXECUTE_INCREMENT_H
+#define AFINA_EXECUTE_INCREMENT_H
+
+#include <cstdint>
+#include <string>
+
+#include <afina/Hash.h>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Change counter stored under the key
+ * Value has to be decimal representation of 64-bit unsigned integer. Increment wraps around at 2^64,
+ * decrement below zero gives zero. Item keeps its flags and expire time
+ *
+ * Command must write result to the output, which could be:
+ * - new value of the counter
+ * - "NOT_FOUND" to indicate that the item with this key was not found
+ * - "CLIENT_ERROR ..." if value isn't a number
+ */
+class Increment : public Command {
+public:
+    Increment(const std::string &key, uint64_t delta, bool decrement)
+        : Increment(key, KeyHash::Of(key), delta, decrement) {}
+    Increment(const std::string &key, uint64_t hash, uint64_t delta, bool decrement)
+        : _key(key), _hash(hash), _delta(delta), _decrement(decrement) {}
+    ~Increment() {}
+
+    inline const std::string &key() const { return _key; }
+    inline uint64_t hash() const { return _hash; }
+    inline uint64_t delta() const { return _delta; }
+    inline bool decrement() const { return _decrement; }
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    const std::string _key;
+    const uint64_t _hash;
+    const uint64_t _delta;
+    const bool _decrement;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_INCREMENT_H
@@ -3,6 +3,10 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
+
+#include <afina/Hash.h>
+#include <afina/Storage.h>
 
 #include "Command.h"
 
@@ -15,17 +19,48 @@ namespace Execute {
  */
 class InsertCommand : public Command {
 public:
-    InsertCommand(const std::string &key, uint32_t flags, int32_t expire) : _key(key), _flags(flags), _expire(expire) {}
+    InsertCommand(const std::string &key, uint32_t flags, int32_t expire)
+        : InsertCommand(key, KeyHash::Of(key), flags, expire) {}
+    InsertCommand(const std::string &key, uint64_t hash, uint32_t flags, int32_t expire, int32_t soft_expire = 0)
+        : _key(key), _hash(hash), _flags(flags), _expire(expire), _soft_expire(soft_expire) {}
     ~InsertCommand() {}
 
     inline const std::string &key() const { return _key; }
+    inline uint64_t hash() const { return _hash; }
     inline const uint32_t flags() const { return _flags; }
     inline const int32_t expire() const { return _expire; }
+    inline const int32_t soft_expire() const { return _soft_expire; }
+    inline const std::vector<uint64_t> &tags() const { return _tags; }
+
+    /**
+     * Sets tags of the item command creates, each one is KeyHash::Of(tag)
+     */
+    inline void Tag(const std::vector<uint64_t> &tags) { _tags = tags; }
+
+    /**
+     * Attributes of the item command creates, expiration times are made absolute
+     */
+    inline ItemInfo item_info() const {
+        ItemInfo info;
+        info.expire = ItemInfo::Deadline(_expire);
+        info.soft_expire = ItemInfo::Deadline(_soft_expire);
+        info.flags = _flags;
+        info.tags = _tags;
+        return info;
+    }
 
 protected:
     const std::string _key;
+    const uint64_t _hash;
     const uint32_t _flags;
     const int32_t _expire;
+
+    // Same as _expire, but once it passed item is served as stale and one client is asked to refresh it.
+    // Zero means there is no soft TTL
+    const int32_t _soft_expire;
+
+    // Tags the item could be invalidated by, see Storage::InvalidateTag
+    std::vector<uint64_t> _tags;
 };
 
 } // namespace Execute
@@ -0,0 +1,45 @@
+#ifndef AFINA_EXECUTE_INVALIDATE_TAG_H
+#define AFINA_EXECUTE_INVALIDATE_TAG_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Drop all the items carrying a tag
+ * invalidate_tag <tag>*\r\n
+ *
+ * Every item stored with one of the tags before the command (see "set ... #<tag>") disappears at once,
+ * no matter how many of them there are.
+ *
+ * Command must write result to the output, which could be:
+ * - "INVALIDATED" to indicate success
+ * - "SERVER_ERROR tags are not supported" if storage doesn't keep tags
+ */
+class InvalidateTag : public Command {
+public:
+    InvalidateTag(const std::vector<std::string> &tags, const std::vector<uint64_t> &hashes)
+        : _tags(tags), _hashes(hashes) {}
+    ~InvalidateTag() {}
+
+    inline const std::vector<std::string> &tags() const { return _tags; }
+    inline const std::vector<uint64_t> &hashes() const { return _hashes; }
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    const std::vector<std::string> _tags;
+
+    // KeyHash::Of each tag
+    const std::vector<uint64_t> _hashes;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_INVALIDATE_TAG_H
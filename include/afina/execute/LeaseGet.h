@@ -0,0 +1,53 @@
+#ifndef AFINA_EXECUTE_LEASE_GET_H
+#define AFINA_EXECUTE_LEASE_GET_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Get.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Retrive value for the key, lease the missed ones
+ * Works as get, but each missed key results in one of the following lines instead of nothing:
+ *
+ * LEASE <key> <token>\r\n
+ * The caller is the first one missed the key. It is expected to fetch value from the source of truth
+ * and store it by lset command with the given token
+ *
+ * HOTMISS <key>\r\n
+ * Somebody else is loading the key right now, caller should retry after a short delay
+ *
+ * STALE <key> <flags> <bytes>\r\n
+ * <data>\r\n
+ * Somebody else is loading the key right now, data is the value key had before it was deleted. Caller
+ * could use it if some staleness is acceptable. The same line is sent when soft TTL of the key passed
+ * while somebody else is refreshing it, data is the current value then
+ *
+ * STALE <key> <flags> <bytes>\r\n
+ * <data>\r\n
+ * LEASE <key> <token>\r\n
+ * Soft TTL of the key passed and the caller is the first one who saw it. Data could be used, but caller
+ * is expected to refresh it by lset command with the given token
+ *
+ * After all the items have been transmitted, the server sends "END". Plain get keeps memcached response
+ * format, so stale marker is sent by lget only
+ */
+class LeaseGet : public Get {
+public:
+    LeaseGet(const std::vector<std::string> &keys) : Get(keys) {}
+    LeaseGet(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+             Allocator::Arena &arena = Allocator::Arena::Default())
+        : Get(keys, hashes, false, arena) {}
+    ~LeaseGet() {}
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_LEASE_GET_H
@@ -0,0 +1,40 @@
+#ifndef AFINA_EXECUTE_LEASE_SET_H
+#define AFINA_EXECUTE_LEASE_SET_H
+
+#include <cstdint>
+#include <string>
+
+#include "InsertCommand.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Fill missed key back under the lease
+ * Stores value for the key only if token is still the valid lease got from lget. Lease gets
+ * invalid once it expires or key is written/deleted by anybody else
+ *
+ * Command must write result to the output, which could be:
+ * - "STORED", to indicate success.
+ * - "NOT_STORED" to indicate lease is not valid anymore, most likely because value loaded
+ * by the caller is not the freshest one
+ */
+class LeaseSet : public InsertCommand {
+public:
+    LeaseSet(const std::string &key, uint64_t hash, uint32_t flags, int32_t expire, uint64_t token,
+             int32_t soft_expire = 0)
+        : InsertCommand(key, hash, flags, expire, soft_expire), _token(token) {}
+    ~LeaseSet() {}
+
+    inline uint64_t token() const { return _token; }
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    const uint64_t _token;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_LEASE_SET_H
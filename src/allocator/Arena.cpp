@@ -0,0 +1,112 @@
+#include <afina/allocator/Arena.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace Afina {
+namespace Allocator {
+
+// Alignment of the memory given out
+static const std::size_t kAlign = 16;
+
+struct Arena::chunk {
+    chunk *next;
+    std::size_t size;
+
+    inline char *begin() { return reinterpret_cast<char *>(this) + ((sizeof(chunk) + kAlign - 1) & ~(kAlign - 1)); }
+    inline char *end() { return reinterpret_cast<char *>(this) + size; }
+};
+
+static inline std::size_t Align(std::size_t n) { return (n + kAlign - 1) & ~(kAlign - 1); }
+
+// See Arena.h
+Arena::Arena(std::size_t chunk_size)
+    : _chunk_size(chunk_size), _first(nullptr), _current(nullptr), _pos(nullptr), _end(nullptr), _big(nullptr),
+      _used(0), _capacity(0) {}
+
+// See Arena.h
+Arena::~Arena() {
+    Reset();
+    while (_first != nullptr) {
+        chunk *next = _first->next;
+        ::operator delete(_first);
+        _first = next;
+    }
+}
+
+// See Arena.h
+Arena &Arena::Default() {
+    // Zero chunk size makes arena pass everything to the heap
+    static Arena *arena = new Arena(0);
+    return *arena;
+}
+
+// See Arena.h
+void *Arena::allocate(std::size_t N) {
+    if (_chunk_size == 0) {
+        return ::operator new(N);
+    }
+
+    N = Align(std::max<std::size_t>(N, 1));
+    _used += N;
+    if (N + Align(sizeof(chunk)) > _chunk_size) {
+        // Big request gets chunk of its own, the current one stays to continue with
+        chunk *c = static_cast<chunk *>(::operator new(N + Align(sizeof(chunk))));
+        c->size = N + Align(sizeof(chunk));
+        c->next = _big;
+        _big = c;
+        _capacity += c->size;
+        return c->begin();
+    }
+
+    if (std::size_t(_end - _pos) < N) {
+        Grow();
+    }
+    void *p = _pos;
+    _pos += N;
+    return p;
+}
+
+// See Arena.h
+void Arena::deallocate(void *p, std::size_t N) {
+    if (_chunk_size == 0) {
+        ::operator delete(p);
+    }
+}
+
+// See Arena.h
+void Arena::Reset() {
+    while (_big != nullptr) {
+        chunk *next = _big->next;
+        _capacity -= _big->size;
+        ::operator delete(_big);
+        _big = next;
+    }
+
+    _current = _first;
+    _pos = _first != nullptr ? _first->begin() : nullptr;
+    _end = _first != nullptr ? _first->end() : nullptr;
+    _used = 0;
+}
+
+// See Arena.h
+void Arena::Grow() {
+    chunk *next = _current != nullptr ? _current->next : _first;
+    if (next == nullptr) {
+        next = static_cast<chunk *>(::operator new(_chunk_size));
+        next->size = _chunk_size;
+        next->next = nullptr;
+        if (_current != nullptr) {
+            _current->next = next;
+        } else {
+            _first = next;
+        }
+        _capacity += _chunk_size;
+    }
+    _current = next;
+    _pos = next->begin();
+    _end = next->end();
+}
+
+} // namespace Allocator
+} // namespace Afina
@@ -0,0 +1,269 @@
+#include <afina/allocator/Mempool.h>
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+#include <afina/allocator/SlabCache.h>
+
+namespace Afina {
+namespace Allocator {
+
+// Objects alignment
+static const std::size_t kAlign = 16;
+
+// Thread caches keep up to that many objects of each pool
+static const uint32_t kCacheMax = 2 * Mempool::kBatch;
+
+struct Mempool::slab {
+    // Neighbours in the list slab belongs to
+    slab *prev;
+    slab *next;
+
+    // Returned objects, linked through their first word
+    void *free;
+
+    // Number of objects given out of the slab
+    uint32_t used;
+
+    // Number of objects ever carved, the rest of slab was never touched
+    uint32_t carved;
+};
+
+// Registry of live pools, thread caches flush into pools found here only
+static std::mutex registry_mt;
+static Mempool *registry[Mempool::kMaxPools];
+static uint64_t last_id = 0;
+
+// Free objects of one pool cached by thread
+struct cache_entry {
+    uint64_t id;
+    void *list;
+    uint32_t count;
+};
+
+// Caches are plain data, so that they stay usable while thread_local destructors run
+static thread_local cache_entry entries[Mempool::kMaxPools];
+
+// Set once thread caches are flushed on thread exit, objects go straight to pools after that
+static thread_local bool exited = false;
+
+// Flushes caches of the exiting thread
+struct Mempool::thread_cache {
+    ~thread_cache() {
+        std::lock_guard<std::mutex> lck(registry_mt);
+        for (std::size_t i = 0; i < kMaxPools; i++) {
+            if (entries[i].count > 0 && registry[i] != nullptr && registry[i]->_id == entries[i].id) {
+                registry[i]->Flush(entries[i].list, entries[i].count);
+            }
+            entries[i].count = 0;
+        }
+        exited = true;
+    }
+
+    // Cache entry of the pool in current thread, entry left from destroyed pool is dropped
+    static cache_entry &Of(const Mempool &pool) {
+        static thread_local thread_cache guard;
+        (void)guard;
+
+        cache_entry &e = entries[pool._index];
+        if (e.id != pool._id) {
+            e.id = pool._id;
+            e.list = nullptr;
+            e.count = 0;
+        }
+        return e;
+    }
+};
+
+static inline void *&NextOf(void *p) { return *reinterpret_cast<void **>(p); }
+
+// See Mempool.h
+Mempool::Mempool(std::size_t size)
+    : _size(std::max(kAlign, (size + kAlign - 1) & ~(kAlign - 1))),
+      _offset((sizeof(slab) + kAlign - 1) & ~(kAlign - 1)),
+      _capacity(uint32_t((SlabCache::kSlabSize - _offset) / _size)), _partial(nullptr), _full(nullptr), _slabs(0),
+      _used(0) {
+    if (_capacity == 0) {
+        throw std::runtime_error("Object doesn't fit into slab");
+    }
+
+    std::lock_guard<std::mutex> lck(registry_mt);
+    for (_index = 0; _index < kMaxPools && registry[_index] != nullptr; _index++) {
+    }
+    if (_index == kMaxPools) {
+        throw std::runtime_error("Too many pools");
+    }
+    registry[_index] = this;
+    _id = ++last_id;
+}
+
+// See Mempool.h
+Mempool::~Mempool() {
+    {
+        std::lock_guard<std::mutex> lck(registry_mt);
+        registry[_index] = nullptr;
+    }
+
+    for (slab *list : {_partial, _full}) {
+        while (list != nullptr) {
+            slab *next = list->next;
+            SlabCache::Instance().Put(list);
+            list = next;
+        }
+    }
+}
+
+// See Mempool.h
+void *Mempool::Alloc() {
+    cache_entry &e = thread_cache::Of(*this);
+    if (e.count == 0) {
+        e.count = Refill(e.list);
+    }
+    if (exited) {
+        // Nobody is going to flush cache anymore
+        void *p = e.list;
+        Flush(NextOf(p), e.count - 1);
+        e.list = nullptr;
+        e.count = 0;
+        return p;
+    }
+
+    void *p = e.list;
+    e.list = NextOf(p);
+    e.count--;
+    return p;
+}
+
+// See Mempool.h
+void Mempool::Free(void *p) {
+    if (exited) {
+        NextOf(p) = nullptr;
+        Flush(p, 1);
+        return;
+    }
+
+    cache_entry &e = thread_cache::Of(*this);
+    if (e.count == kCacheMax) {
+        // Older half of cache goes back, the most recently freed objects stay hot
+        void *tail = e.list;
+        for (uint32_t i = 1; i < kBatch; i++) {
+            tail = NextOf(tail);
+        }
+        void *rest = NextOf(tail);
+        NextOf(tail) = nullptr;
+        Flush(rest, e.count - kBatch);
+        e.count = kBatch;
+    }
+
+    NextOf(p) = e.list;
+    e.list = p;
+    e.count++;
+}
+
+// See Mempool.h
+std::size_t Mempool::Slabs() const {
+    std::lock_guard<std::mutex> lck(_mt);
+    return _slabs;
+}
+
+// See Mempool.h
+std::size_t Mempool::Used() const {
+    std::lock_guard<std::mutex> lck(_mt);
+    return _used;
+}
+
+// See Mempool.h
+uint32_t Mempool::Refill(void *&list) {
+    std::lock_guard<std::mutex> lck(_mt);
+    uint32_t count = 0;
+    while (count < kBatch) {
+        if (_partial == nullptr) {
+            slab *s = reinterpret_cast<slab *>(SlabCache::Instance().Get());
+            s->free = nullptr;
+            s->used = 0;
+            s->carved = 0;
+            Push(_partial, s);
+            _slabs++;
+        }
+
+        slab *s = _partial;
+        void *p;
+        while (count < kBatch && (p = Take(s)) != nullptr) {
+            NextOf(p) = list;
+            list = p;
+            count++;
+        }
+        if (s->used == _capacity) {
+            Remove(_partial, s);
+            Push(_full, s);
+        }
+    }
+    _used += count;
+    return count;
+}
+
+// See Mempool.h
+void Mempool::Flush(void *list, uint32_t count) {
+    std::lock_guard<std::mutex> lck(_mt);
+    for (uint32_t i = 0; i < count; i++) {
+        void *p = list;
+        list = NextOf(p);
+
+        slab *s = reinterpret_cast<slab *>(reinterpret_cast<uintptr_t>(p) & ~(SlabCache::kSlabSize - 1));
+        if (s->used == _capacity) {
+            Remove(_full, s);
+            Push(_partial, s);
+        }
+        NextOf(p) = s->free;
+        s->free = p;
+        s->used--;
+
+        if (s->used == 0) {
+            Remove(_partial, s);
+            SlabCache::Instance().Put(s);
+            _slabs--;
+        }
+    }
+    _used -= count;
+}
+
+// See Mempool.h
+void *Mempool::Take(slab *s) {
+    void *p = s->free;
+    if (p != nullptr) {
+        s->free = NextOf(p);
+    } else if (s->carved < _capacity) {
+        p = reinterpret_cast<char *>(s) + _offset + s->carved * _size;
+        s->carved++;
+    } else {
+        return nullptr;
+    }
+    s->used++;
+    return p;
+}
+
+// See Mempool.h
+void Mempool::Push(slab *&list, slab *s) {
+    s->prev = nullptr;
+    s->next = list;
+    if (list != nullptr) {
+        list->prev = s;
+    }
+    list = s;
+}
+
+// See Mempool.h
+void Mempool::Remove(slab *&list, slab *s) {
+    if (s->prev != nullptr) {
+        s->prev->next = s->next;
+    } else {
+        list = s->next;
+    }
+    if (s->next != nullptr) {
+        s->next->prev = s->prev;
+    }
+}
+
+} // namespace Allocator
+} // namespace Afina
@@ -0,0 +1,68 @@
+#include <afina/allocator/Pooled.h>
+
+#include <new>
+
+#include <afina/allocator/Mempool.h>
+
+namespace Afina {
+namespace Allocator {
+
+// Size classes: 16 byte steps up to kSmall, kLargeStep steps up to kMax
+static const std::size_t kSmall = 512;
+static const std::size_t kLargeStep = 128;
+static const std::size_t kMax = 2048;
+static const std::size_t kClasses = kSmall / 16 + (kMax - kSmall) / kLargeStep;
+
+static inline std::size_t ClassOf(std::size_t size) {
+    if (size <= kSmall) {
+        return size == 0 ? 0 : (size - 1) / 16;
+    }
+    return kSmall / 16 + (size - kSmall - 1) / kLargeStep;
+}
+
+static inline std::size_t SizeOf(std::size_t cls) {
+    if (cls < kSmall / 16) {
+        return (cls + 1) * 16;
+    }
+    return kSmall + (cls - kSmall / 16 + 1) * kLargeStep;
+}
+
+// Pools are never destroyed, so that objects could be deleted during static destruction
+static Mempool **Pools() {
+    static Mempool **pools = [] {
+        Mempool **result = new Mempool *[kClasses];
+        for (std::size_t i = 0; i < kClasses; i++) {
+            result[i] = new Mempool(SizeOf(i));
+        }
+        return result;
+    }();
+    return pools;
+}
+
+// See Pooled.h
+void *PoolAlloc(std::size_t size) {
+    if (size > kMax) {
+        return ::operator new(size);
+    }
+    return Pools()[ClassOf(size)]->Alloc();
+}
+
+// See Pooled.h
+void PoolFree(void *p, std::size_t size) noexcept {
+    if (p == nullptr) {
+        return;
+    } else if (size > kMax) {
+        ::operator delete(p);
+        return;
+    }
+    Pools()[ClassOf(size)]->Free(p);
+}
+
+// See Pooled.h
+void *Pooled::operator new(std::size_t size) { return PoolAlloc(size); }
+
+// See Pooled.h
+void Pooled::operator delete(void *p, std::size_t size) noexcept { PoolFree(p, size); }
+
+} // namespace Allocator
+} // namespace Afina
@@ -1,40 +1,417 @@
 #include <afina/allocator/Simple.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <afina/allocator/Error.h>
 #include <afina/allocator/Pointer.h>
 
 namespace Afina {
 namespace Allocator {
 
-Simple::Simple(void *base, size_t size) : _base(base), _base_len(size) {}
-
-/**
- * TODO: semantics
- * @param N size_t
- */
-Pointer Simple::alloc(size_t N) { return Pointer(); }
-
-/**
- * TODO: semantics
- * @param p Pointer
- * @param N size_t
- */
-void Simple::realloc(Pointer &p, size_t N) {}
-
-/**
- * TODO: semantics
- * @param p Pointer
- */
-void Simple::free(Pointer &p) {}
-
-/**
- * TODO: semantics
- */
-void Simple::defrag() {}
-
-/**
- * TODO: semantics
- */
-std::string Simple::dump() const { return ""; }
+// Block sizes are counted in units, that is also alignment of the memory given out
+static const size_t kUnit = 16;
+
+// Header of each block and free list links stored in payload of free one
+static const uint32_t kMinUnits = 2;
+
+// Size field bit telling block is free
+static const uint32_t kFreeBit = 1u << 31;
+
+struct Simple::block {
+    // Size of the previous block in units, zero for the first one
+    uint32_t prev;
+
+    // Size of the block in units including header, along with kFreeBit
+    uint32_t size;
+
+    // Descriptor slot of block in use, nullptr if it is pinned. Next block in free list otherwise
+    union {
+        void **slot;
+        block *next;
+    };
+
+    // Free block only: previous block in free list
+    inline block *&prev_free() { return *reinterpret_cast<block **>(this + 1); }
+
+    inline uint32_t units() const { return size & ~kFreeBit; }
+    inline bool free() const { return (size & kFreeBit) != 0; }
+    inline void *data() { return this + 1; }
+
+    inline block *Next() { return reinterpret_cast<block *>(reinterpret_cast<char *>(this) + units() * kUnit); }
+    inline block *Prev() { return reinterpret_cast<block *>(reinterpret_cast<char *>(this) - prev * kUnit); }
+};
+
+// Number of units block of N bytes takes, zero if it can't be addressed
+static inline uint32_t UnitsOf(size_t N) {
+    if (N > size_t(kFreeBit - 1 - 1) * kUnit) {
+        return 0;
+    }
+    return std::max<uint32_t>(kMinUnits, uint32_t(1 + (N + kUnit - 1) / kUnit));
+}
+
+Simple::Simple(void *base, size_t size)
+    : _base(base), _base_len(size), _top_prev(0), _slots(0), _free_slots(nullptr), _free(nullptr) {
+    static_assert(sizeof(block) == kUnit, "Block header must take exactly one unit");
+
+    uintptr_t begin = (reinterpret_cast<uintptr_t>(base) + kUnit - 1) & ~uintptr_t(kUnit - 1);
+    uintptr_t end = (reinterpret_cast<uintptr_t>(base) + size) & ~uintptr_t(sizeof(void *) - 1);
+    if (end < begin) {
+        end = begin;
+    }
+
+    // Block sizes are 31-bit numbers of units, anything beyond that is never used
+    end = std::min<uintptr_t>(end, begin + uintptr_t(kFreeBit - 1) * kUnit);
+
+    _start = _top = _cursor = reinterpret_cast<block *>(begin);
+    _table_end = reinterpret_cast<void **>(end);
+}
+
+// See Simple.h
+Pointer Simple::alloc(size_t N) {
+    uint32_t units = UnitsOf(N);
+    block *b = units == 0 ? nullptr : Place(units, _free_slots == nullptr);
+    if (b == nullptr) {
+        throw AllocError(AllocErrorType::NoMemory, "No free block of " + std::to_string(N) + " bytes");
+    }
+
+    void **slot = TakeSlot();
+    *slot = b->data();
+    b->slot = slot;
+    return Pointer(slot);
+}
+
+// See Simple.h
+void Simple::realloc(Pointer &p, size_t N) {
+    if (p._slot == nullptr) {
+        p = alloc(N);
+        return;
+    }
+
+    if (!Owns(p._slot)) {
+        throw AllocError(AllocErrorType::InvalidFree, "Pointer doesn't refer to allocated memory");
+    }
+
+    uint32_t units = UnitsOf(N);
+    if (units == 0) {
+        throw AllocError(AllocErrorType::NoMemory, "No free block of " + std::to_string(N) + " bytes");
+    }
+
+    block *b = reinterpret_cast<block *>(*p._slot) - 1;
+    if (units <= b->units()) {
+        Split(b, units);
+        return;
+    }
+
+    // Grow in place: over free neighbour or into the space above the last block. Defrag cursor could
+    // point to the space block takes, so it goes back to the block
+    block *next = b->Next();
+    if (next == _top) {
+        size_t extra = size_t(units - b->units()) * kUnit;
+        if (extra <= size_t(reinterpret_cast<char *>(_table_end - _slots) - reinterpret_cast<char *>(_top))) {
+            b->size = units;
+            _top = b->Next();
+            _top_prev = units;
+            _cursor = std::min(_cursor, b);
+            return;
+        }
+    } else if (next->free() && b->units() + next->units() >= units) {
+        Unlink(next);
+        b->size = b->units() + next->units();
+        SetNextPrev(b, b->units());
+        _cursor = std::min(_cursor, b);
+        Split(b, units);
+        return;
+    }
+
+    block *moved = Place(units, false);
+    if (moved == nullptr) {
+        throw AllocError(AllocErrorType::NoMemory, "No free block of " + std::to_string(N) + " bytes");
+    }
+    std::memcpy(moved->data(), b->data(), (b->units() - 1) * kUnit);
+    moved->slot = b->slot;
+    *moved->slot = moved->data();
+    Release(b);
+}
+
+// See Simple.h
+void Simple::free(Pointer &p) {
+    if (p._slot == nullptr) {
+        return;
+    }
+
+    void **slot = p._slot;
+    if (!Owns(slot)) {
+        throw AllocError(AllocErrorType::InvalidFree, "Pointer doesn't refer to allocated memory");
+    }
+
+    block *b = reinterpret_cast<block *>(*slot) - 1;
+    ReleaseSlot(slot);
+    Release(b);
+    p._slot = nullptr;
+}
+
+// See Simple.h
+void *Simple::allocate(size_t N) {
+    uint32_t units = UnitsOf(N);
+    block *b = units == 0 ? nullptr : Place(units, false);
+    if (b == nullptr) {
+        throw AllocError(AllocErrorType::NoMemory, "No free block of " + std::to_string(N) + " bytes");
+    }
+
+    b->slot = nullptr;
+    return b->data();
+}
+
+// See Simple.h
+void Simple::deallocate(void *p, size_t N) {
+    if (p == nullptr) {
+        return;
+    }
+
+    block *b = reinterpret_cast<block *>(p) - 1;
+    if (b < _start || b >= _top || (reinterpret_cast<uintptr_t>(p) & (kUnit - 1)) != 0 || b->free() ||
+        b->slot != nullptr) {
+        throw AllocError(AllocErrorType::InvalidFree, "Pointer doesn't refer to pinned memory");
+    }
+    Release(b);
+}
+
+// See Simple.h
+void Simple::defrag() {
+    while (!defrag(SIZE_MAX)) {
+    }
+}
+
+// See Simple.h
+bool Simple::defrag(size_t max_bytes) {
+    size_t moved = 0;
+    while (true) {
+        while (_cursor != _top && !_cursor->free()) {
+            _cursor = _cursor->Next();
+        }
+        if (_cursor == _top) {
+            return true;
+        } else if (moved >= max_bytes) {
+            return false;
+        }
+
+        // Free block is never the last one and never has free neighbours, so there is block in use
+        // right after it. That one slides down and free space moves up, merging with whatever is next
+        block *hole = _cursor;
+        block *b = hole->Next();
+        if (b->slot == nullptr) {
+            // Pinned block stays, so does the space below it
+            _cursor = b->Next();
+            continue;
+        }
+
+        uint32_t hole_units = hole->units(), hole_prev = hole->prev, units = b->units();
+        Unlink(hole);
+
+        std::memmove(hole, b, units * kUnit);
+        hole->prev = hole_prev;
+        *hole->slot = hole->data();
+        moved += units * kUnit;
+
+        block *rest = hole->Next();
+        rest->prev = units;
+        rest->size = hole_units;
+        Release(rest);
+        _cursor = rest;
+    }
+}
+
+// See Simple.h
+std::string Simple::dump() const {
+    char *begin = reinterpret_cast<char *>(_start);
+    char *top = reinterpret_cast<char *>(_top);
+    char *table = reinterpret_cast<char *>(_table_end - _slots);
+    size_t bytes[3] = {0, 0, 0};
+    size_t blocks = 0, free_blocks = 0, largest = size_t(table - top);
+
+    std::string map;
+    char run_kind = 0;
+    size_t run_offset = 0, run_size = 0;
+    auto add = [&](char kind, size_t offset, size_t size) {
+        if (kind == run_kind) {
+            run_size += size;
+            return;
+        }
+        if (run_kind != 0) {
+            map.append(map.empty() ? "[\"" : ",[\"").append(1, run_kind).append("\",");
+            map.append(std::to_string(run_offset)).append(",").append(std::to_string(run_size)).append("]");
+        }
+        run_kind = kind;
+        run_offset = offset;
+        run_size = size;
+    };
+
+    for (block *b = _start; b != _top; b = b->Next()) {
+        size_t size = size_t(b->units()) * kUnit;
+        int kind = b->free() ? 2 : (b->slot == nullptr ? 1 : 0);
+        bytes[kind] += size;
+        blocks++;
+        if (b->free()) {
+            free_blocks++;
+            largest = std::max(largest, size);
+        }
+        add("UPF"[kind], reinterpret_cast<char *>(b) - begin, size);
+    }
+    add('W', top - begin, table - top);
+    add('T', table - begin, size_t(reinterpret_cast<char *>(_table_end) - table));
+    add(0, 0, 0);
+
+    size_t wilderness = table - top;
+    size_t table_bytes = reinterpret_cast<char *>(_table_end) - table;
+    size_t free_total = bytes[2] + wilderness;
+    double fragmentation = free_total == 0 ? 0.0 : 1.0 - double(largest) / double(free_total);
+    char ratio[32];
+    std::snprintf(ratio, sizeof(ratio), "%.6f", fragmentation);
+
+    std::string out;
+    out.append("{\"area\":").append(std::to_string(reinterpret_cast<char *>(_table_end) - begin));
+    out.append(",\"used\":").append(std::to_string(bytes[0]));
+    out.append(",\"pinned\":").append(std::to_string(bytes[1]));
+    out.append(",\"free\":").append(std::to_string(bytes[2]));
+    out.append(",\"wilderness\":").append(std::to_string(wilderness));
+    out.append(",\"table\":").append(std::to_string(table_bytes));
+    out.append(",\"footprint\":").append(std::to_string((top - begin) + table_bytes));
+    out.append(",\"blocks\":").append(std::to_string(blocks));
+    out.append(",\"free_blocks\":").append(std::to_string(free_blocks));
+    out.append(",\"largest_free\":").append(std::to_string(largest));
+    out.append(",\"fragmentation\":").append(ratio);
+    out.append(",\"map\":[").append(map).append("]}");
+    return out;
+}
+
+// See Simple.h
+bool Simple::Owns(void **slot) const {
+    return slot >= _table_end - _slots && slot < _table_end && (reinterpret_cast<uintptr_t>(*slot) & 1) == 0;
+}
+
+// See Simple.h
+void **Simple::TakeSlot() {
+    if (_free_slots != nullptr) {
+        void **slot = _free_slots;
+        _free_slots = reinterpret_cast<void **>(reinterpret_cast<uintptr_t>(*slot) & ~uintptr_t(1));
+        return slot;
+    }
+
+    // Caller has checked there is space for one more slot
+    _slots++;
+    return _table_end - _slots;
+}
+
+// See Simple.h
+void Simple::ReleaseSlot(void **slot) {
+    *slot = reinterpret_cast<void *>(reinterpret_cast<uintptr_t>(_free_slots) | 1);
+    _free_slots = slot;
+}
+
+// See Simple.h
+Simple::block *Simple::Place(uint32_t units, bool need_slot) {
+    char *limit = reinterpret_cast<char *>(_table_end - _slots - (need_slot ? 1 : 0));
+    if (limit < reinterpret_cast<char *>(_top)) {
+        return nullptr;
+    }
+
+    for (block *b = _free; b != nullptr; b = b->next) {
+        if (b->units() >= units) {
+            Unlink(b);
+            b->size = b->units();
+            Split(b, units);
+            return b;
+        }
+    }
+
+    if (size_t(units) * kUnit > size_t(limit - reinterpret_cast<char *>(_top))) {
+        return nullptr;
+    }
+    block *b = _top;
+    b->prev = _top_prev;
+    b->size = units;
+    _top = b->Next();
+    _top_prev = units;
+    return b;
+}
+
+// See Simple.h
+void Simple::Split(block *b, uint32_t units) {
+    if (b->units() - units < kMinUnits) {
+        return;
+    }
+
+    uint32_t rest_units = b->units() - units;
+    b->size = units;
+    block *rest = b->Next();
+    rest->prev = units;
+    rest->size = rest_units;
+    Release(rest);
+}
+
+// See Simple.h
+void Simple::Release(block *b) {
+    uint32_t units = b->units();
+    block *next = b->Next();
+    if (next != _top && next->free()) {
+        Unlink(next);
+        units += next->units();
+    }
+    if (b != _start && b->Prev()->free()) {
+        b = b->Prev();
+        Unlink(b);
+        units += b->units();
+    }
+    b->size = units;
+
+    if (b->Next() == _top) {
+        // Space above the last block isn't tracked by free list
+        _top = b;
+        _top_prev = b->prev;
+    } else {
+        SetNextPrev(b, units);
+        b->size |= kFreeBit;
+        Link(b);
+    }
+
+    if (b < _cursor) {
+        _cursor = b;
+    }
+}
+
+// See Simple.h
+void Simple::SetNextPrev(block *b, uint32_t units) {
+    block *next = b->Next();
+    if (next == _top) {
+        _top_prev = units;
+    } else {
+        next->prev = units;
+    }
+}
+
+// See Simple.h
+void Simple::Link(block *b) {
+    b->next = _free;
+    b->prev_free() = nullptr;
+    if (_free != nullptr) {
+        _free->prev_free() = b;
+    }
+    _free = b;
+}
+
+// See Simple.h
+void Simple::Unlink(block *b) {
+    if (b->prev_free() != nullptr) {
+        b->prev_free()->next = b->next;
+    } else {
+        _free = b->next;
+    }
+    if (b->next != nullptr) {
+        b->next->prev_free() = b->prev_free();
+    }
+}
 
 } // namespace Allocator
 } // namespace Afina
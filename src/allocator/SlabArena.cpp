@@ -0,0 +1,49 @@
+#include <afina/allocator/SlabArena.h>
+
+#include <new>
+
+#include <afina/allocator/Pooled.h>
+
+namespace Afina {
+namespace Allocator {
+
+// See SlabArena.h
+SlabArena &SlabArena::Default() {
+    // Never destroyed, the same way pools aren't
+    static SlabArena *arena = new SlabArena();
+    return *arena;
+}
+
+// See SlabArena.h
+void *SlabArena::allocate(std::size_t N) {
+    std::size_t used = _used.fetch_add(N, std::memory_order_relaxed) + N;
+    if (_limit != 0 && used > _limit) {
+        _used.fetch_sub(N, std::memory_order_relaxed);
+        throw std::bad_alloc();
+    }
+
+    void *p;
+    try {
+        p = PoolAlloc(N);
+    } catch (...) {
+        _used.fetch_sub(N, std::memory_order_relaxed);
+        throw;
+    }
+
+    std::size_t peak = _peak.load(std::memory_order_relaxed);
+    while (used > peak && !_peak.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {
+    }
+    return p;
+}
+
+// See SlabArena.h
+void SlabArena::deallocate(void *p, std::size_t N) {
+    if (p == nullptr) {
+        return;
+    }
+    PoolFree(p, N);
+    _used.fetch_sub(N, std::memory_order_relaxed);
+}
+
+} // namespace Allocator
+} // namespace Afina
@@ -0,0 +1,80 @@
+#include <afina/allocator/SlabCache.h>
+
+#include <new>
+
+#include <sys/mman.h>
+
+namespace Afina {
+namespace Allocator {
+
+// Low bits of stack head that are used as ABA counter
+static const uintptr_t kTagMask = SlabCache::kSlabSize - 1;
+
+// See SlabCache.h
+SlabCache &SlabCache::Instance() {
+    // Never destroyed, so that objects freed by static destructors still find their slabs
+    static SlabCache *cache = new SlabCache();
+    return *cache;
+}
+
+// See SlabCache.h
+void *SlabCache::Get() {
+    void *slab = Pop();
+    if (slab != nullptr) {
+        return slab;
+    }
+
+    std::lock_guard<std::mutex> lck(_map_mt);
+    slab = Pop();
+    if (slab != nullptr) {
+        return slab;
+    }
+
+    // Chunk is mapped with one extra slab, so that aligned part of it is always there
+    void *mapped = mmap(nullptr, kChunkSize + kSlabSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    uintptr_t begin = (reinterpret_cast<uintptr_t>(mapped) + kSlabSize - 1) & ~kTagMask;
+    uintptr_t end = begin + kChunkSize;
+    if (begin != reinterpret_cast<uintptr_t>(mapped)) {
+        munmap(mapped, begin - reinterpret_cast<uintptr_t>(mapped));
+    }
+    munmap(reinterpret_cast<void *>(end), reinterpret_cast<uintptr_t>(mapped) + kChunkSize + kSlabSize - end);
+
+    _slabs.fetch_add(kChunkSize / kSlabSize, std::memory_order_relaxed);
+    for (uintptr_t s = begin + kSlabSize; s < end; s += kSlabSize) {
+        Put(reinterpret_cast<void *>(s));
+    }
+    return reinterpret_cast<void *>(begin);
+}
+
+// See SlabCache.h
+void SlabCache::Put(void *slab) {
+    free_slab *s = reinterpret_cast<free_slab *>(slab);
+    uintptr_t head = _head.load(std::memory_order_relaxed), next;
+    do {
+        s->next = head & ~kTagMask;
+        next = reinterpret_cast<uintptr_t>(slab) | ((head + 1) & kTagMask);
+    } while (!_head.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+    _free_slabs.fetch_add(1, std::memory_order_relaxed);
+}
+
+// See SlabCache.h
+void *SlabCache::Pop() {
+    uintptr_t head = _head.load(std::memory_order_acquire), next;
+    do {
+        if ((head & ~kTagMask) == 0) {
+            return nullptr;
+        }
+
+        // Slab could be popped and reused meanwhile, but memory is never unmapped, so read is safe and
+        // counter makes CAS fail in that case
+        next = reinterpret_cast<free_slab *>(head & ~kTagMask)->next | ((head + 1) & kTagMask);
+    } while (!_head.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire));
+    _free_slabs.fetch_sub(1, std::memory_order_relaxed);
+    return reinterpret_cast<void *>(head & ~kTagMask);
+}
+
+} // namespace Allocator
+} // namespace Afina
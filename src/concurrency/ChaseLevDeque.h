@@ -0,0 +1,140 @@
+#ifndef AFINA_CONCURRENCY_CHASE_LEV_DEQUE_H
+#define AFINA_CONCURRENCY_CHASE_LEV_DEQUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Work stealing deque
+ * Chase-Lev deque in the C11 memory model formulation by Le, Pop, Cohen and Zappa Nardelli. Owner thread
+ * pushes and takes at the bottom without locks and mostly without atomic read-modify-write, any other thread
+ * steals at the top with single CAS. Buffer grows when full, replaced buffers are kept until destruction
+ * since a thief might still read them
+ */
+template <typename T> class ChaseLevDeque {
+public:
+    explicit ChaseLevDeque(std::size_t capacity = 256) : _top(0), _bottom(0) {
+        std::size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        _buffers.emplace_back(new Buffer(size));
+        _buffer.store(_buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    /**
+     * Adds element to the bottom, owner thread only
+     */
+    void Push(T *x) {
+        int64_t b = _bottom.load(std::memory_order_relaxed);
+        int64_t t = _top.load(std::memory_order_acquire);
+        Buffer *a = _buffer.load(std::memory_order_relaxed);
+        if (b - t > int64_t(a->mask)) {
+            a = Grow(a, t, b);
+        }
+        a->Put(b, x);
+        std::atomic_thread_fence(std::memory_order_release);
+        _bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Removes element from the bottom, owner thread only. Returns nullptr if deque is empty or the last
+     * element has been stolen concurrently
+     */
+    T *Take() {
+        int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+        Buffer *a = _buffer.load(std::memory_order_relaxed);
+        _bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = _top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T *x = a->Get(b);
+        if (t == b) {
+            // Single element left, race with thieves for it
+            if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                x = nullptr;
+            }
+            _bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return x;
+    }
+
+    /**
+     * Removes element from the top, could be called by any thread. Returns nullptr if deque is empty or
+     * some other thread won the race for the element
+     */
+    T *Steal() {
+        int64_t t = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = _bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return nullptr;
+        }
+
+        Buffer *a = _buffer.load(std::memory_order_acquire);
+        T *x = a->Get(t);
+        if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return x;
+    }
+
+    /**
+     * Approximate number of elements, exact one for the owner when there are no thieves
+     */
+    std::size_t Size() const {
+        int64_t b = _bottom.load(std::memory_order_relaxed);
+        int64_t t = _top.load(std::memory_order_relaxed);
+        return b > t ? std::size_t(b - t) : 0;
+    }
+
+private:
+    struct Buffer {
+        explicit Buffer(std::size_t size) : mask(size - 1), items(new std::atomic<T *>[size]) {}
+
+        // Slots are release/acquire on top of the fences, it is free on x86 and lets race detectors follow
+        // the element handoff
+        T *Get(int64_t i) const { return items[i & mask].load(std::memory_order_acquire); }
+        void Put(int64_t i, T *x) { items[i & mask].store(x, std::memory_order_release); }
+
+        std::size_t mask;
+        std::unique_ptr<std::atomic<T *>[]> items;
+    };
+
+    // Copies live elements into twice bigger buffer, owner thread only
+    Buffer *Grow(Buffer *a, int64_t t, int64_t b) {
+        _buffers.emplace_back(new Buffer(2 * (a->mask + 1)));
+        Buffer *grown = _buffers.back().get();
+        for (int64_t i = t; i < b; i++) {
+            grown->Put(i, a->Get(i));
+        }
+        _buffer.store(grown, std::memory_order_release);
+        return grown;
+    }
+
+    // Thieves hammer top while owner works at bottom, keep them on separate cache lines
+    std::atomic<int64_t> _top;
+    char _top_pad[64 - sizeof(std::atomic<int64_t>)];
+    std::atomic<int64_t> _bottom;
+    char _bottom_pad[64 - sizeof(std::atomic<int64_t>)];
+
+    std::atomic<Buffer *> _buffer;
+
+    // All buffers ever used, owned by the deque owner
+    std::vector<std::unique_ptr<Buffer>> _buffers;
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_CHASE_LEV_DEQUE_H
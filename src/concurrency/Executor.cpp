@@ -0,0 +1,269 @@
+#include <afina/Executor.h>
+
+#include <algorithm>
+#include <exception>
+
+#include <pthread.h>
+
+#include "Histogram.h"
+#include "MpmcRing.h"
+
+namespace Afina {
+
+namespace {
+
+uint64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Pools alive in the process, for GetAllStats
+std::mutex &RegistryMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::vector<Executor *> &Registry() {
+    static std::vector<Executor *> registry;
+    return registry;
+}
+
+} // namespace
+
+// See Executor.h
+struct Executor::queued_task {
+    Task task;
+    uint64_t enqueued;
+};
+
+// See Executor.h
+struct Executor::thread_stats {
+    Concurrency::Histogram depth;
+    Concurrency::Histogram wait;
+    Concurrency::Histogram run;
+
+    void Merge(const thread_stats &other) {
+        depth.Merge(other.depth);
+        wait.Merge(other.wait);
+        run.Merge(other.run);
+    }
+};
+
+// See Executor.h
+Executor::Executor(std::string name, std::size_t low_watermark, std::size_t high_watermark,
+                   std::size_t max_queue_size, std::chrono::milliseconds idle_time)
+    : tasks(new Concurrency::MpmcRing<queued_task>(max_queue_size)), state(State::kRun), _name(std::move(name)),
+      _low_watermark(low_watermark), _high_watermark(std::max<std::size_t>({1, low_watermark, high_watermark})),
+      _idle_time(idle_time), _threads(0), _free_threads(0), _submitting(0), _exited_stats(new thread_stats) {
+    {
+        std::unique_lock<std::mutex> lock(RegistryMutex());
+        Registry().push_back(this);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for (std::size_t i = 0; i < _low_watermark; i++) {
+        StartThread();
+    }
+}
+
+// See Executor.h
+Executor::~Executor() {
+    Stop(true);
+
+    std::unique_lock<std::mutex> lock(RegistryMutex());
+    std::vector<Executor *> &registry = Registry();
+    registry.erase(std::remove(registry.begin(), registry.end(), this), registry.end());
+}
+
+// See Executor.h
+void Executor::Stop(bool await) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (state.load() == State::kRun) {
+        state.store(State::kStopping);
+        if (_threads.load() == 0) {
+            // Someone has to drain tasks submitted concurrently and mark pool stopped
+            StartThread();
+        }
+        empty_condition.notify_all();
+    }
+
+    if (await) {
+        stop_condition.wait(lock, [this] { return state.load() == State::kStopped; });
+    }
+}
+
+// See Executor.h
+std::size_t Executor::ExecuteBatch(Task *batch, std::size_t n) {
+    _submitting.fetch_add(1);
+    std::size_t placed = 0;
+    if (state.load() == State::kRun) {
+        uint64_t now = Now();
+        queued_task queued;
+        for (; placed < n; placed++) {
+            queued.task = std::move(batch[placed]);
+            queued.enqueued = now;
+            if (!tasks->TryPush(queued)) {
+                batch[placed] = std::move(queued.task);
+                break;
+            }
+        }
+    }
+    _submitting.fetch_sub(1);
+
+    if (state.load() != State::kRun) {
+        // Stopping threads wait for submissions in progress
+        std::unique_lock<std::mutex> lock(mutex);
+        empty_condition.notify_all();
+    } else if (placed > 0) {
+        Wake(placed);
+    }
+    return placed;
+}
+
+// See Executor.h
+std::size_t Executor::Threads() { return _threads.load(); }
+
+// See Executor.h
+std::size_t Executor::Queued() { return tasks->Size(); }
+
+// See Executor.h
+void Executor::GetStats(std::vector<std::pair<std::string, std::string>> &stats) {
+    thread_stats total;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        total.Merge(*_exited_stats);
+        for (thread_stats *thread : _thread_stats) {
+            total.Merge(*thread);
+        }
+    }
+
+    std::string prefix = "executor:" + _name + ":";
+    stats.emplace_back(prefix + "threads", std::to_string(Threads()));
+    stats.emplace_back(prefix + "queued", std::to_string(Queued()));
+    stats.emplace_back(prefix + "tasks", std::to_string(total.run.Count()));
+
+    auto quantiles = [&stats, &prefix](const std::string &name, const Concurrency::Histogram &histogram) {
+        stats.emplace_back(prefix + name + "_p50", std::to_string(histogram.Quantile(0.5)));
+        stats.emplace_back(prefix + name + "_p99", std::to_string(histogram.Quantile(0.99)));
+        stats.emplace_back(prefix + name + "_p999", std::to_string(histogram.Quantile(0.999)));
+        stats.emplace_back(prefix + name + "_max", std::to_string(histogram.Max()));
+    };
+    quantiles("queue_depth", total.depth);
+    quantiles("wait_ns", total.wait);
+    quantiles("run_ns", total.run);
+}
+
+// See Executor.h
+std::string Executor::FormatStats() {
+    std::vector<std::pair<std::string, std::string>> stats;
+    GetStats(stats);
+    std::string line;
+    for (auto &stat : stats) {
+        line.append(line.empty() ? "" : " ").append(stat.first).append("=").append(stat.second);
+    }
+    return line;
+}
+
+// See Executor.h
+void Executor::GetAllStats(std::vector<std::pair<std::string, std::string>> &stats) {
+    std::unique_lock<std::mutex> lock(RegistryMutex());
+    for (Executor *executor : Registry()) {
+        executor->GetStats(stats);
+    }
+}
+
+// See Executor.h
+void Executor::Wake(std::size_t n) {
+    // Sleeping thread announces itself before it checks the queue, and submitter checks for sleepers after the
+    // task is in the queue, so that at least one of them sees the other
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_free_threads.load() == 0 && _threads.load() >= _high_watermark) {
+        // Everybody is busy, they will find the task once done with the current one
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    std::size_t free = _free_threads.load();
+    for (std::size_t i = 0; i < std::min(n, free); i++) {
+        empty_condition.notify_one();
+    }
+    while (_threads.load() < _high_watermark && tasks->Size() > free) {
+        StartThread();
+        free++;
+    }
+}
+
+// See Executor.h
+void perform(Executor *executor) {
+    std::unique_ptr<Executor::thread_stats> stats(new Executor::thread_stats);
+    {
+        std::unique_lock<std::mutex> lock(executor->mutex);
+        executor->_thread_stats.push_back(stats.get());
+    }
+
+    // Histograms of the exiting thread are kept in the pool sum, mutex must be held
+    auto retire = [executor, &stats] {
+        std::vector<Executor::thread_stats *> &threads = executor->_thread_stats;
+        threads.erase(std::find(threads.begin(), threads.end(), stats.get()));
+        executor->_exited_stats->Merge(*stats);
+    };
+
+    Executor::queued_task queued;
+    while (true) {
+        if (executor->tasks->TryPop(queued)) {
+            uint64_t start = Now();
+            stats->depth.Record(executor->tasks->Size() + 1);
+            stats->wait.Record(start > queued.enqueued ? start - queued.enqueued : 0);
+            try {
+                queued.task();
+            } catch (std::exception &) {
+                // Task is responsible to report its own errors, pool thread must survive anyway
+            }
+            queued.task.Reset();
+            stats->run.Record(Now() - start);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(executor->mutex);
+        executor->_free_threads.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool woken = executor->empty_condition.wait_for(lock, executor->_idle_time, [executor] {
+            return executor->tasks->Size() > 0 ||
+                   (executor->state.load() != Executor::State::kRun && executor->_submitting.load() == 0);
+        });
+        executor->_free_threads.fetch_sub(1);
+
+        if (executor->tasks->Size() > 0) {
+            continue;
+        }
+        if (executor->state.load() != Executor::State::kRun) {
+            if (executor->_submitting.load() == 0) {
+                break;
+            }
+            continue;
+        }
+        // Idle for too long, pool shrinks back to its low watermark
+        if (!woken && executor->_threads.load() > executor->_low_watermark) {
+            retire();
+            executor->_threads.fetch_sub(1);
+            return;
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(executor->mutex);
+    retire();
+    if (executor->_threads.fetch_sub(1) == 1 && executor->state.load() == Executor::State::kStopping) {
+        executor->state.store(Executor::State::kStopped);
+        executor->stop_condition.notify_all();
+    }
+}
+
+// See Executor.h
+void Executor::StartThread() {
+    std::thread thread(perform, this);
+    pthread_setname_np(thread.native_handle(), _name.substr(0, 15).c_str());
+    thread.detach();
+    _threads.fetch_add(1);
+}
+
+} // namespace Afina
@@ -0,0 +1,113 @@
+#ifndef AFINA_CONCURRENCY_HISTOGRAM_H
+#define AFINA_CONCURRENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Log-linear histogram
+ * Each power of two is split into kSubBuckets equal buckets, so that any value is reported with less than
+ * 1 / kSubBuckets relative error whatever its magnitude is, and recording is a couple of shifts and an add.
+ * Written by single thread, counters are atomic only to let other threads merge them at any moment
+ */
+class Histogram {
+public:
+    static const int kSubBits = 3;
+    static const uint64_t kSubBuckets = 1 << kSubBits;
+    static const int kBuckets = (64 - kSubBits + 1) * kSubBuckets;
+
+    Histogram() {
+        for (auto &bucket : _buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Counts value, owner thread only
+     */
+    void Record(uint64_t value) {
+        std::atomic<uint64_t> &bucket = _buckets[Index(value)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Adds counters of other histogram to this one. Source could be updated concurrently, then the result is
+     * a bit behind
+     */
+    void Merge(const Histogram &other) {
+        for (int i = 0; i < kBuckets; i++) {
+            uint64_t count = other._buckets[i].load(std::memory_order_relaxed);
+            if (count > 0) {
+                _buckets[i].store(_buckets[i].load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    uint64_t Count() const {
+        uint64_t count = 0;
+        for (auto &bucket : _buckets) {
+            count += bucket.load(std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+    /**
+     * Upper bound of the bucket holding given quantile, 0 if there are no values
+     */
+    uint64_t Quantile(double q) const {
+        uint64_t count = Count();
+        if (count == 0) {
+            return 0;
+        }
+
+        uint64_t rank = uint64_t(q * (count - 1)) + 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < kBuckets; i++) {
+            seen += _buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return Upper(i);
+            }
+        }
+        return Upper(kBuckets - 1);
+    }
+
+    // Upper bound of the highest non empty bucket
+    uint64_t Max() const {
+        for (int i = kBuckets - 1; i >= 0; i--) {
+            if (_buckets[i].load(std::memory_order_relaxed) > 0) {
+                return Upper(i);
+            }
+        }
+        return 0;
+    }
+
+    static int Index(uint64_t value) {
+        if (value < kSubBuckets) {
+            return int(value);
+        }
+        int exponent = 63 - __builtin_clzll(value);
+        int shift = exponent - kSubBits;
+        return int(((shift + 1) << kSubBits) + ((value >> shift) & (kSubBuckets - 1)));
+    }
+
+    // Largest value falling into the bucket
+    static uint64_t Upper(int index) {
+        if (index < int(kSubBuckets)) {
+            return uint64_t(index);
+        }
+        int shift = (index >> kSubBits) - 1;
+        uint64_t base = (kSubBuckets + (uint64_t(index) & (kSubBuckets - 1))) << shift;
+        return base + ((uint64_t(1) << shift) - 1);
+    }
+
+private:
+    std::atomic<uint64_t> _buckets[kBuckets];
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_HISTOGRAM_H
@@ -0,0 +1,116 @@
+#ifndef AFINA_CONCURRENCY_MPMC_RING_H
+#define AFINA_CONCURRENCY_MPMC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Bounded multi producer multi consumer queue
+ * Dmitry Vyukov's ring: each cell carries a sequence number telling whether it is ready to be written or
+ * read at the given position, so that producers and consumers only contend on their own position counter
+ * with single CAS per operation. Capacity is rounded up to a power of two
+ */
+template <typename T> class MpmcRing {
+public:
+    explicit MpmcRing(std::size_t capacity) : _enqueue(0), _dequeue(0) {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        _mask = size - 1;
+        _cells.reset(new Cell[size]);
+        for (std::size_t i = 0; i < size; i++) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Moves element into the queue. Returns false and leaves element intact if queue is full
+     */
+    bool TryPush(T &x) {
+        std::size_t pos = _enqueue.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &_cells[pos & _mask];
+            std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(sequence) - intptr_t(pos);
+            if (diff == 0) {
+                if (_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _enqueue.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = std::move(x);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Moves the oldest element out of the queue. Returns false if queue is empty
+     */
+    bool TryPop(T &x) {
+        std::size_t pos = _dequeue.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &_cells[pos & _mask];
+            std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(sequence) - intptr_t(pos + 1);
+            if (diff == 0) {
+                if (_dequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _dequeue.load(std::memory_order_relaxed);
+            }
+        }
+
+        x = std::move(cell->data);
+        cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Approximate number of elements, includes ones being written at the moment
+     */
+    std::size_t Size() const {
+        std::size_t dequeue = _dequeue.load(std::memory_order_relaxed);
+        std::size_t enqueue = _enqueue.load(std::memory_order_relaxed);
+        return enqueue > dequeue ? enqueue - dequeue : 0;
+    }
+
+    std::size_t Capacity() const { return _mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> _cells;
+    std::size_t _mask;
+
+    // Producers and consumers don't share cache line
+    char _cells_pad[64];
+    std::atomic<std::size_t> _enqueue;
+    char _enqueue_pad[64 - sizeof(std::atomic<std::size_t>)];
+    std::atomic<std::size_t> _dequeue;
+    char _dequeue_pad[64 - sizeof(std::atomic<std::size_t>)];
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_MPMC_RING_H
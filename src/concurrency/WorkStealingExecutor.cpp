@@ -0,0 +1,187 @@
+#include <afina/WorkStealingExecutor.h>
+
+#include <algorithm>
+#include <exception>
+
+#include <pthread.h>
+
+#include "ChaseLevDeque.h"
+
+namespace Afina {
+
+namespace {
+
+// Tasks moved from the injection queue to the own deque at once, rest of them are up for stealing
+const std::size_t kInjectedBatch = 32;
+
+} // namespace
+
+struct WorkStealingExecutor::Worker {
+    Worker(WorkStealingExecutor *pool, uint64_t seed) : owner(pool), random(seed) {}
+
+    // xorshift64, only used to pick a victim
+    std::size_t Random() {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        return std::size_t(random);
+    }
+
+    WorkStealingExecutor *owner;
+    Concurrency::ChaseLevDeque<std::function<void()>> deque;
+    std::thread thread;
+    uint64_t random;
+};
+
+// Worker of the pool current thread belongs to, if any
+static thread_local WorkStealingExecutor::Worker *current_worker = nullptr;
+
+// See WorkStealingExecutor.h
+WorkStealingExecutor::WorkStealingExecutor(std::string name, std::size_t size)
+    : _name(std::move(name)), _injected_size(0), _sleepers(0), _pending(0), _running(true), _steals(0) {
+    for (std::size_t i = 0; i < std::max<std::size_t>(size, 1); i++) {
+        _workers.emplace_back(new Worker(this, 0x9e3779b97f4a7c15ull * (i + 1)));
+    }
+    for (auto &worker : _workers) {
+        worker->thread = std::thread(&WorkStealingExecutor::Perform, this, worker.get());
+        pthread_setname_np(worker->thread.native_handle(), _name.substr(0, 15).c_str());
+    }
+}
+
+// See WorkStealingExecutor.h
+WorkStealingExecutor::~WorkStealingExecutor() { Stop(true); }
+
+// See WorkStealingExecutor.h
+void WorkStealingExecutor::Stop(bool await) {
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _running.store(false);
+        _sleep.notify_all();
+    }
+
+    if (await) {
+        for (auto &worker : _workers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+    }
+}
+
+// See WorkStealingExecutor.h
+bool WorkStealingExecutor::Push(std::function<void()> *task) {
+    Worker *worker = current_worker;
+    if (worker != nullptr && worker->owner == this) {
+        // Running task spawns more work, it is accepted even while stopping
+        _pending.fetch_add(1);
+        worker->deque.Push(task);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_sleepers.load(std::memory_order_relaxed) > 0) {
+            Wake();
+        }
+        return true;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_running.load()) {
+        return false;
+    }
+    _pending.fetch_add(1);
+    _injected.push_back(task);
+    _injected_size.fetch_add(1);
+    if (_sleepers.load() > 0) {
+        _sleep.notify_one();
+    }
+    return true;
+}
+
+// See WorkStealingExecutor.h
+void WorkStealingExecutor::Wake() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _sleep.notify_one();
+}
+
+// See WorkStealingExecutor.h
+std::function<void()> *WorkStealingExecutor::Find(Worker *worker) {
+    std::function<void()> *task = worker->deque.Take();
+    if (task != nullptr) {
+        return task;
+    }
+
+    if (_injected_size.load(std::memory_order_relaxed) > 0) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (std::size_t i = 0; i < kInjectedBatch && !_injected.empty(); i++) {
+            if (task != nullptr) {
+                worker->deque.Push(task);
+            }
+            task = _injected.front();
+            _injected.pop_front();
+            _injected_size.fetch_sub(1);
+        }
+        if (task != nullptr) {
+            return task;
+        }
+    }
+
+    // Walk all the victims starting from random one, so that thieves don't crowd at the same deque
+    std::size_t n = _workers.size();
+    std::size_t start = worker->Random() % n;
+    for (std::size_t i = 0; i < n; i++) {
+        Worker *victim = _workers[(start + i) % n].get();
+        if (victim == worker) {
+            continue;
+        }
+        task = victim->deque.Steal();
+        if (task != nullptr) {
+            _steals.fetch_add(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+// See WorkStealingExecutor.h
+void WorkStealingExecutor::Perform(Worker *worker) {
+    current_worker = worker;
+    while (true) {
+        std::function<void()> *task = Find(worker);
+        if (task != nullptr) {
+            try {
+                (*task)();
+            } catch (std::exception &) {
+                // Task is responsible to report its own errors, pool thread must survive anyway
+            }
+            delete task;
+
+            if (_pending.fetch_sub(1) == 1 && !_running.load()) {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _sleep.notify_all();
+            }
+            continue;
+        }
+
+        // Nothing to run, go to sleep. Submitter checks sleepers after publishing task and sleeper checks
+        // queues after announcing itself, so that at least one of them sees the other
+        std::unique_lock<std::mutex> lock(_mutex);
+        _sleepers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool work = false;
+        while (true) {
+            work = !_injected.empty();
+            for (std::size_t i = 0; i < _workers.size() && !work; i++) {
+                work = _workers[i]->deque.Size() > 0;
+            }
+            if (work || (!_running.load() && _pending.load() == 0)) {
+                break;
+            }
+            _sleep.wait(lock);
+        }
+        _sleepers.fetch_sub(1);
+        if (!work) {
+            break;
+        }
+    }
+    current_worker = nullptr;
+}
+
+} // namespace Afina
@@ -1,20 +1,19 @@
 #include <afina/Storage.h>
 #include <afina/execute/Append.h>
 
-#include <iostream>
-
 namespace Afina {
 namespace Execute {
 
 // memcached protocol: "append" means "add this data to an existing key after existing data".
 void Append::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::cout << "Append(" << _key << ")" << args << std::endl;
+    // Appended item keeps its expiration times, as memcached does
     std::string value;
-    if (!storage.Get(_key, value)) {
+    ItemInfo info;
+    if (!storage.Get(_key, _hash, value, info)) {
         out.assign("NOT_STORED");
         return;
     }
-    storage.Put(_key, value + args);
+    storage.Put(_key, _hash, value + args, info);
     out.assign("STORED");
 }
 
@@ -0,0 +1,26 @@
+#include <afina/Storage.h>
+#include <afina/execute/Cas.h>
+
+namespace Afina {
+namespace Execute {
+
+// memcached protocol: "cas" stores data only if item version is still the one client got by gets
+void Cas::Execute(Storage &storage, const std::string &args, std::string &out) {
+    switch (storage.CompareAndSwap(_key, _hash, args, item_info(), _cas)) {
+    case Storage::CasStatus::kStored:
+        out = "STORED";
+        break;
+    case Storage::CasStatus::kExists:
+        out = "EXISTS";
+        break;
+    case Storage::CasStatus::kNotFound:
+        out = "NOT_FOUND";
+        break;
+    case Storage::CasStatus::kNotStored:
+        out = "NOT_STORED";
+        break;
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
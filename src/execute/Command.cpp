@@ -1 +1,19 @@
 #include <afina/execute/Command.h>
+
+namespace Afina {
+namespace Execute {
+
+// See Command.h
+void Command::ExecuteBlock(Storage &storage, std::string &args, std::string &out) {
+    if (!args.empty()) {
+        if (args.size() < 2 || args.compare(args.size() - 2, 2, "\r\n") != 0) {
+            out = "CLIENT_ERROR bad data chunk";
+            return;
+        }
+        args.resize(args.size() - 2);
+    }
+    Execute(storage, args, out);
+}
+
+} // namespace Execute
+} // namespace Afina
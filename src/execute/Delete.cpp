@@ -0,0 +1,13 @@
+#include <afina/Storage.h>
+#include <afina/execute/Delete.h>
+
+namespace Afina {
+namespace Execute {
+
+// memcached protocol: "delete" removes key, leases on it get revoked
+void Delete::Execute(Storage &storage, const std::string &args, std::string &out) {
+    out = storage.Delete(_key, _hash) ? "DELETED" : "NOT_FOUND";
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -1,10 +1,6 @@
 #include <afina/Storage.h>
 #include <afina/execute/Get.h>
 
-#include <iostream>
-#include <iterator>
-#include <sstream>
-
 namespace Afina {
 namespace Execute {
 
@@ -12,32 +8,22 @@ namespace Execute {
 
 Each item sent by the server looks like this:
 
-VALUE <key> <flags> <bytes>\r\n
+VALUE <key> <flags> <bytes> [<cas unique>]\r\n
 <data block>\r\n
 
 After all the items have been transmitted, the server sends the string
 "END\r\n"
-to indicate the end of response.
+to indicate the end of response. <cas unique> is sent by "gets" only.
 
 */
 
 void Get::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::stringstream keyStream;
-    copy(_keys.begin(), _keys.end(), std::ostream_iterator<std::string>(keyStream, " "));
-    std::cout << "Get(" << keyStream.str() << ")" << std::endl;
-
-    std::stringstream outStream;
-
-    std::string value;
-    for (auto &key : _keys) {
-        if (!storage.Get(key, value))
-            continue;
-        outStream << "VALUE " << key << " 0 " << value.size() << "\r\n";
-        outStream << value << "\r\n";
+    // Storage appends blocks with headers rendered on write, so there is no formatting here
+    out.clear();
+    for (std::size_t i = 0; i < _keys.size(); i++) {
+        storage.AppendValue(_keys[i], _hashes[i], out, _versioned);
     }
-    outStream << "END"; // networking layer should add the last \r\n
-
-    out = outStream.str();
+    out.append("END"); // networking layer should add the last \r\n
 }
 
 } // namespace Execute
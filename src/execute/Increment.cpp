@@ -0,0 +1,27 @@
+#include <afina/Storage.h>
+#include <afina/execute/Increment.h>
+
+namespace Afina {
+namespace Execute {
+
+// memcached protocol: "incr"/"decr" update counter in place, atomically with other writes of the key
+void Increment::Execute(Storage &storage, const std::string &args, std::string &out) {
+    uint64_t result;
+    switch (storage.Increment(_key, _hash, _delta, _decrement, result)) {
+    case Storage::CounterStatus::kOk:
+        out = std::to_string(result);
+        break;
+    case Storage::CounterStatus::kNotFound:
+        out = "NOT_FOUND";
+        break;
+    case Storage::CounterStatus::kNotNumber:
+        out = "CLIENT_ERROR cannot increment or decrement non-numeric value";
+        break;
+    case Storage::CounterStatus::kNotStored:
+        out = "SERVER_ERROR out of memory storing object";
+        break;
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
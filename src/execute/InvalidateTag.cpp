@@ -0,0 +1,19 @@
+#include <afina/Storage.h>
+#include <afina/execute/InvalidateTag.h>
+
+namespace Afina {
+namespace Execute {
+
+// Items are not touched here, storage checks tag generations on read
+void InvalidateTag::Execute(Storage &storage, const std::string &args, std::string &out) {
+    for (uint64_t hash : _hashes) {
+        if (!storage.InvalidateTag(hash)) {
+            out = "SERVER_ERROR tags are not supported";
+            return;
+        }
+    }
+    out = "INVALIDATED";
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -0,0 +1,44 @@
+#include <afina/Storage.h>
+#include <afina/execute/LeaseGet.h>
+
+namespace Afina {
+namespace Execute {
+
+// See LeaseGet.h
+void LeaseGet::Execute(Storage &storage, const std::string &args, std::string &out) {
+    const keys_type &keys = this->keys();
+    const hashes_type &hashes = this->hashes();
+
+    out.clear();
+    std::string value;
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        const std::string &key = keys[i];
+        uint64_t token = 0;
+        ItemInfo info;
+        switch (storage.GetLeased(key, hashes[i], value, info, token)) {
+        case Storage::LeaseStatus::kHit:
+            Storage::RenderHeader(key, info.flags, value.size(), out);
+            out.append(value).append("\r\n");
+            break;
+        case Storage::LeaseStatus::kGranted:
+            out.append("LEASE ").append(key).append(" ").append(std::to_string(token)).append("\r\n");
+            break;
+        case Storage::LeaseStatus::kHotMiss:
+            out.append("HOTMISS ").append(key).append("\r\n");
+            break;
+        case Storage::LeaseStatus::kStale:
+            Storage::RenderHeader(key, info.flags, value.size(), out, "STALE");
+            out.append(value).append("\r\n");
+            break;
+        case Storage::LeaseStatus::kRefresh:
+            Storage::RenderHeader(key, info.flags, value.size(), out, "STALE");
+            out.append(value).append("\r\n");
+            out.append("LEASE ").append(key).append(" ").append(std::to_string(token)).append("\r\n");
+            break;
+        }
+    }
+    out.append("END"); // networking layer should add the last \r\n
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -0,0 +1,13 @@
+#include <afina/Storage.h>
+#include <afina/execute/LeaseSet.h>
+
+namespace Afina {
+namespace Execute {
+
+// See LeaseSet.h
+void LeaseSet::Execute(Storage &storage, const std::string &args, std::string &out) {
+    out = storage.PutLeased(_key, _hash, args, item_info(), _token) ? "STORED" : "NOT_STORED";
+}
+
+} // namespace Execute
+} // namespace Afina
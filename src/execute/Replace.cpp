@@ -1,8 +1,6 @@
 #include <afina/Storage.h>
 #include <afina/execute/Replace.h>
 
-#include <iostream>
-
 namespace Afina {
 namespace Execute {
 
@@ -10,14 +8,7 @@ namespace Execute {
 // already hold data for this key".
 
 void Replace::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::cout << "Replace(" << _key << "): " << args << std::endl;
-    std::string value;
-    if (storage.Get(_key, value)) {
-        storage.Set(_key, args);
-        out = "STORED";
-    } else {
-        out = "NOT_STORED";
-    }
+    out = storage.Set(_key, _hash, args, item_info()) ? "STORED" : "NOT_STORED";
 }
 
 } // namespace Execute
@@ -1,3 +1,4 @@
+#include <afina/Executor.h>
 #include <afina/Storage.h>
 #include <afina/execute/Stats.h>
 
@@ -8,7 +9,32 @@
 namespace Afina {
 namespace Execute {
 
-void Stats::Execute(Storage &storage, const std::string &args, std::string &out) { out.assign("END"); }
+/* memcached protocol:
+
+Upon receiving the "stats" command without arguments, the server sents a number of lines which look
+like this:
+
+STAT <name> <value>\r\n
+
+The server terminates this list with the line
+
+END\r\n
+
+Storage statistics are followed by ones of the thread pools serving requests, if there are any
+*/
+void Stats::Execute(Storage &storage, const std::string &args, std::string &out) {
+    std::vector<std::pair<std::string, std::string>> stats;
+    storage.GetStats(stats);
+    Executor::GetAllStats(stats);
+
+    std::stringstream outStream;
+    for (auto &stat : stats) {
+        outStream << "STAT " << stat.first << " " << stat.second << "\r\n";
+    }
+    outStream << "END"; // networking layer should add the last \r\n
+
+    out = outStream.str();
+}
 
 } // namespace Execute
 } // namespace Afina
@@ -1,6 +1,8 @@
 #include <chrono>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <atomic>
 #include <semaphore.h>
@@ -9,6 +11,7 @@
 
 #include <cxxopts.hpp>
 
+#include <afina/Hash.h>
 #include <afina/Storage.h>
 #include <afina/Version.h>
 #include <afina/logging/Service.h>
@@ -21,7 +24,16 @@
 #include "network/st_blocking/ServerImpl.h"
 #include "network/st_nonblocking/ServerImpl.h"
 
+#include "storage/CompactLRU.h"
+#include "storage/DatasetStorage.h"
+#include "storage/FileLoader.h"
+#include "storage/Keyspaces.h"
+#include "storage/MissRatioSampler.h"
+#include "storage/ProcessLoader.h"
+#include "storage/ReadThrough.h"
+#include "storage/SharedLRU.h"
 #include "storage/SimpleLRU.h"
+#include "storage/StripedLRU.h"
 #include "storage/ThreadSafeSimpleLRU.h"
 
 using namespace Afina;
@@ -45,20 +57,99 @@ public:
         logger.format = "[%H:%M:%S %z] [thread %t] [%n] [%l] %v";
         logService.reset(new Logging::ServiceImpl(logConfig));
 
-        // Step 1: configure storage
+        // Step 1: configure storage. Key hash seed gets fixed before any key is hashed
+        KeyHash::ProcessSeed();
+
         std::string storage_type = "st_lru";
         if (options.count("storage") > 0) {
             storage_type = options["storage"].as<std::string>();
         }
 
+        // Values at least that long are stored once for all the keys having them
+        size_t dedup = 0;
+        if (options.count("dedup") > 0) {
+            dedup = options["dedup"].as<size_t>();
+        }
+
         if (storage_type == "st_lru") {
-            storage = std::make_shared<Afina::Backend::SimpleLRU>();
+            auto lru = std::make_shared<Afina::Backend::SimpleLRU>();
+            lru->Deduplicate(dedup);
+            storage = lru;
         } else if (storage_type == "mt_lru") {
-            storage = std::make_shared<Afina::Backend::ThreadSafeSimplLRU>();
+            auto lru = std::make_shared<Afina::Backend::ThreadSafeSimplLRU>();
+            lru->Deduplicate(dedup);
+            storage = lru;
+        } else if (storage_type == "striped_lru") {
+            auto lru = std::make_shared<Afina::Backend::StripedLRU>();
+            lru->Deduplicate(dedup);
+            storage = lru;
+        } else if (storage_type == "compact_lru") {
+            storage = std::make_shared<Afina::Backend::CompactLRU>();
+        } else if (storage_type.compare(0, 7, "shm_lru") == 0) {
+            std::string path = "/dev/shm/afina";
+            if (storage_type.size() > 8 && storage_type[7] == ':') {
+                path = storage_type.substr(8);
+            }
+            storage = std::make_shared<Afina::Backend::SharedLRU>(path);
+        } else if (storage_type.compare(0, 7, "mapped:") == 0) {
+            storage = std::make_shared<Afina::Backend::DatasetStorage>(storage_type.substr(7));
         } else {
             throw std::runtime_error("Unknown storage type");
         }
 
+        // Step 1.1: keyspaces with own memory quotas, each is <name>:<type>:<bytes>
+        if (options.count("keyspace") > 0) {
+            auto keyspaces = std::make_shared<Afina::Backend::Keyspaces>(storage);
+            for (auto &spec : options["keyspace"].as<std::vector<std::string>>()) {
+                size_t type_start = spec.find(':');
+                size_t size_start = spec.find(':', type_start == std::string::npos ? 0 : type_start + 1);
+                if (size_start == std::string::npos) {
+                    throw std::runtime_error("Invalid keyspace: " + spec);
+                }
+                std::string type = spec.substr(type_start + 1, size_start - type_start - 1);
+                size_t size = std::stoull(spec.substr(size_start + 1));
+
+                std::shared_ptr<Afina::Storage> keyspace;
+                if (type == "st_lru") {
+                    keyspace = std::make_shared<Afina::Backend::SimpleLRU>(size);
+                } else if (type == "mt_lru") {
+                    keyspace = std::make_shared<Afina::Backend::ThreadSafeSimplLRU>(size);
+                } else if (type == "striped_lru") {
+                    keyspace = std::make_shared<Afina::Backend::StripedLRU>(size);
+                } else if (type == "compact_lru") {
+                    keyspace = std::make_shared<Afina::Backend::CompactLRU>(size);
+                } else {
+                    throw std::runtime_error("Unknown keyspace storage type: " + type);
+                }
+                keyspaces->Add(spec.substr(0, type_start), keyspace);
+            }
+            storage = keyspaces;
+        }
+
+        // Step 1.2: miss ratio curve estimation over sampled keys
+        if (options.count("mrc") > 0) {
+            storage = std::make_shared<Afina::Backend::MissRatioSampler>(storage, options["mrc"].as<double>());
+        }
+
+        // Step 1.3: optional loader to fill cache misses from
+        if (options.count("loader") > 0) {
+            std::string loader_spec = options["loader"].as<std::string>();
+            std::chrono::milliseconds timeout(5000);
+            if (options.count("loader-timeout") > 0) {
+                timeout = std::chrono::milliseconds(options["loader-timeout"].as<uint32_t>());
+            }
+
+            std::shared_ptr<Afina::Loader> loader;
+            if (loader_spec.compare(0, 5, "file:") == 0) {
+                loader = std::make_shared<Afina::Backend::FileLoader>(loader_spec.substr(5));
+            } else if (loader_spec.compare(0, 5, "exec:") == 0) {
+                loader = std::make_shared<Afina::Backend::ProcessLoader>(loader_spec.substr(5), timeout);
+            } else {
+                throw std::runtime_error("Unknown loader type");
+            }
+            storage = std::make_shared<Afina::Backend::ReadThrough>(storage, loader, timeout);
+        }
+
         // Step 2: Configure network
         std::string network_type = "st_block";
         if (options.count("network") > 0) {
@@ -72,7 +163,11 @@ public:
         } else if (network_type == "st_nonblock") {
             server = std::make_shared<Afina::Network::STnonblock::ServerImpl>(storage, logService);
         } else if (network_type == "mt_nonblock") {
-            server = std::make_shared<Afina::Network::MTnonblock::ServerImpl>(storage, logService);
+            uint32_t n_executors = 0;
+            if (options.count("exec-threads") > 0) {
+                n_executors = options["exec-threads"].as<uint32_t>();
+            }
+            server = std::make_shared<Afina::Network::MTnonblock::ServerImpl>(storage, logService, n_executors);
         } else if (network_type == "coroutine") {
             server = std::make_shared<Afina::Network::Coroutine::ServerImpl>(storage, logService);
         } else {
@@ -131,7 +226,19 @@ int main(int argc, char **argv) {
         // TODO: use custom cxxopts::value to print options possible values in help message
         // and simplify validation below
         options.add_options()("s,storage", "Type of storage service to use", cxxopts::value<std::string>());
+        options.add_options()("dedup", "Share single copy of equal values at least that many bytes long",
+                              cxxopts::value<size_t>());
+        options.add_options()("k,keyspace", "Keyspace selected by key prefix: <name>:<storage type>:<bytes>",
+                              cxxopts::value<std::vector<std::string>>());
+        options.add_options()("mrc", "Fraction of keys to sample for miss ratio curve estimation, e.g. 0.001",
+                              cxxopts::value<double>());
+        options.add_options()("l,loader", "Source to load missed keys from: file:<dir> or exec:<program>",
+                              cxxopts::value<std::string>());
+        options.add_options()("loader-timeout", "Milliseconds to wait for the loader, 5000 by default",
+                              cxxopts::value<uint32_t>());
         options.add_options()("n,network", "Type of network service to use", cxxopts::value<std::string>());
+        options.add_options()("exec-threads", "Threads to run mt_nonblock commands on, 0 runs them on I/O threads",
+                              cxxopts::value<uint32_t>());
         options.add_options()("h,help", "Print usage info");
         options.parse(argc, argv);
 
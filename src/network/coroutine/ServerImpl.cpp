@@ -210,7 +210,7 @@ void ServerImpl::_WorkerFunction(int client_socket) {
                     _logger->debug("Start command execution");
 
                     std::string result;
-                    command_to_execute->Execute(*pStorage, argument_for_command, result);
+                    command_to_execute->ExecuteBlock(*pStorage, argument_for_command, result);
                     result += '\n';
 
                     // Send response
@@ -1,10 +1,12 @@
 #include "ServerImpl.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
+#include <vector>
 
 #include <arpa/inet.h>
 #include <netdb.h>
@@ -27,6 +29,9 @@ namespace Afina {
 namespace Network {
 namespace MTblocking {
 
+// Accepted connections allowed to wait for a free worker, next ones are closed right away
+static const std::size_t kMaxQueuedConnections = 128;
+
 // See Server.h
 ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl) : Server(ps, pl) {}
 
@@ -72,7 +77,9 @@ void ServerImpl::Start(uint16_t port, uint32_t n_accept, uint32_t n_workers) {
         throw std::runtime_error("Socket listen() failed");
     }
 
-    _max_workers = n_workers;
+    // Connections are long living, so that threads are kept for a while to serve reconnecting clients
+    _executor.reset(new Afina::Executor("mt_blocking", 1, std::max(n_workers, 1u), kMaxQueuedConnections,
+                                        std::chrono::seconds(10)));
 
     running.store(true);
     _thread = std::thread(&ServerImpl::OnRun, this);
@@ -86,14 +93,15 @@ void ServerImpl::Stop() {
 
 // See Server.h
 void ServerImpl::Join() {
-    std::unique_lock<std::mutex> lock(_wm);
-    while (!_workers.empty()) {
-        _logger->debug("Still waiting {}", _workers.size());
-        _wait_shutdown.wait(lock);
-    }
-    _logger->debug("Delete all threads {}", _workers.empty());
     assert(_thread.joinable());
     _thread.join();
+
+    // Queued connections are closed as soon as they get a thread, running ones notice stop after read timeout
+    _executor->Stop(true);
+    _logger->debug("All workers are stopped");
+
+    // Tells whether connections were waiting for workers or workers were busy serving them
+    _logger->info("Executor stats: {}", _executor->FormatStats());
     close(_server_socket);
 }
 
@@ -131,24 +139,10 @@ void ServerImpl::OnRun() {
             setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, (const char *)&tv, sizeof tv);
         }
 
-        // TODO: Start new thread and process data from/to connection
-        {
-            std::unique_lock<std::mutex> lck(_wm);
-            if (_workers.size() < _max_workers) {
-                _logger->debug("New worker for connection {}\n", client_socket);
-                _workers.insert(
-                    std::pair<int, std::thread>(client_socket, std::thread([=] { _worker_thread(client_socket); })));
-
-            } else {
-                _logger->debug("No free workers for connetions\n");
-                close(client_socket);
-            }
-
-            // static const std::string msg = "TODO: start new thread and process memcached protocol instead";
-            // if (send(client_socket, msg.data(), msg.size(), 0) <= 0) {
-            //     _logger->error("Failed to write response to client: {}", strerror(errno));
-            // }
-            // close(client_socket);
+        // Start serving connection once some thread of the pool is free
+        if (!_executor->Execute(&ServerImpl::_worker_thread, this, client_socket)) {
+            _logger->warn("Too many connections waiting for a worker, drop {}", client_socket);
+            close(client_socket);
         }
     }
 
@@ -162,7 +156,7 @@ void ServerImpl::_worker_thread(int client_socket) {
     // - command_to_execute: last command parsed out of stream
     // - arg_remains: how many bytes to read from stream to get command argument
     // - argument_for_command: buffer stores argument
-    std::size_t arg_remains;
+    std::size_t arg_remains = 0;
     Protocol::Parser parser;
     std::string argument_for_command;
     std::unique_ptr<Execute::Command> command_to_execute;
@@ -177,7 +171,6 @@ void ServerImpl::_worker_thread(int client_socket) {
             // - read#0: [<command1 start>]
             // - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
             while (running.load() && readed_bytes > 0) {
-                std::this_thread::sleep_for(std::chrono::seconds(3));
                 _logger->debug("Process {} bytes", readed_bytes);
                 // There is no command yet
                 if (!command_to_execute) {
@@ -219,9 +212,10 @@ void ServerImpl::_worker_thread(int client_socket) {
                     _logger->debug("Start command execution");
 
                     std::string result;
-                    command_to_execute->Execute(*pStorage, argument_for_command, result);
+                    command_to_execute->ExecuteBlock(*pStorage, argument_for_command, result);
 
                     // Send response
+                    result += "\r\n";
                     if (send(client_socket, result.data(), result.size(), 0) <= 0) {
                         throw std::runtime_error("Failed to send response");
                     }
@@ -234,7 +228,7 @@ void ServerImpl::_worker_thread(int client_socket) {
             } // while (readed_bytes)
         }
 
-        if (readed_bytes == 0) {
+        if (readed_bytes == 0 || !running.load()) {
             _logger->debug("Connection closed");
         } else {
             throw std::runtime_error(std::string(strerror(errno)));
@@ -244,12 +238,7 @@ void ServerImpl::_worker_thread(int client_socket) {
     }
 
     close(client_socket);
-    std::lock_guard<std::mutex> lock(_wm);
-    _workers[client_socket].detach();
-    _workers.erase(client_socket);
-    _logger->debug("Shutdown worker {}", client_socket);
-    if (_workers.size() == 0)
-        _wait_shutdown.notify_one();
+    _logger->debug("Connection {} is served", client_socket);
 }
 
 } // namespace MTblocking
@@ -2,12 +2,10 @@
 #define AFINA_NETWORK_MT_BLOCKING_SERVER_H
 
 #include <atomic>
+#include <memory>
 #include <thread>
 
-#include <map>
-#include <condition_variable>
-#include <mutex>
-
+#include <afina/Executor.h>
 #include <afina/network/Server.h>
 
 namespace spdlog {
@@ -20,7 +18,8 @@ namespace MTblocking {
 
 /**
  * # Network resource manager implementation
- * Server that is spawning a separate thread for each connection
+ * Server that is serving each connection in a separate thread of the pool. Connections over the pool size
+ * wait in its queue until some thread is free
  */
 class ServerImpl : public Server {
 public:
@@ -57,13 +56,11 @@ private:
     // Thread to run network on
     std::thread _thread;
 
+    // Threads serving connections, at most n_workers of them
+    std::unique_ptr<Afina::Executor> _executor;
 
-    uint32_t _max_workers;
-    std::mutex _wm;
-    std::condition_variable _wait_shutdown;
+    // Serves single connection until client closes it or server stops
     void _worker_thread(int client_socket);
-
-    std::map<int, std::thread> _workers;
 };
 
 } // namespace MTblocking
@@ -1,5 +1,7 @@
 #include "Connection.h"
 
+#include <algorithm>
+#include <climits>
 #include <iostream>
 
 namespace Afina {
@@ -12,6 +14,7 @@ void Connection::Start() {
     _event.events = READ_EVENT;
     _event.data.fd = _socket;
     _event.data.ptr = this;
+    _alive.store(true);
 }
 
 // See Connection.h
@@ -52,7 +55,10 @@ void Connection::DoRead() {
                         // There is no command to be launched, continue to parse input stream
                         // Here we are, current chunk finished some command, process it
                         _logger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
-                        command_to_execute = parser.Build(arg_remains);
+                        if (_pending.empty()) {
+                            Rotate();
+                        }
+                        command_to_execute = parser.Build(arg_remains, _arenas[_current]);
                         if (arg_remains > 0) {
                             arg_remains += 2;
                         }
@@ -84,16 +90,26 @@ void Connection::DoRead() {
                 if (command_to_execute && arg_remains == 0) {
                     _logger->debug("Start command execution");
 
-                    std::string result;
                     // _logger->debug("Waiting for 5 sec...");
                     // std::this_thread::sleep_for(std::chrono::seconds(5));
-                    command_to_execute->Execute(*_ps, argument_for_command, result);
+                    if (_executor != nullptr) {
+                        // Command is run later on the pool, argument buffer is reused for the next one
+                        pending_command pending;
+                        pending.argument = nullptr;
+                        pending.argument_size = argument_for_command.size();
+                        if (pending.argument_size > 0) {
+                            char *argument = static_cast<char *>(_arenas[_current].allocate(pending.argument_size));
+                            std::memcpy(argument, argument_for_command.data(), pending.argument_size);
+                            pending.argument = argument;
+                        }
+                        pending.command = std::move(command_to_execute);
+                        _pending.push_back(std::move(pending));
+                    } else {
+                        command_to_execute->ExecuteBlock(*_ps, argument_for_command, _result);
 
-                    // Send response
-                    result += "\r\n";
-                    {
+                        // Send response
                         std::lock_guard<std::mutex> lock(_con_mutex);
-                        _responses.push_back(result);
+                        _responses.push_back(Response());
                         _event.events = READ_WRITE_EVENT;
                     }
                     //_logger->debug("Result: {}", result);
@@ -120,25 +136,55 @@ void Connection::DoRead() {
 }
 
 // See Connection.h
-void Connection::DoWrite() {
-    _logger->debug("DoWrite worker: {}", _socket);
+void Connection::ExecutePending() {
+    _logger->debug("ExecutePending worker: {}, {} commands", _socket, _pending.size());
+
+    // Commands take argument as std::string, buffer is kept per thread to reuse its memory
+    static thread_local std::string argument;
+    try {
+        for (auto &pending : _pending) {
+            argument.assign(pending.argument != nullptr ? pending.argument : "", pending.argument_size);
+            pending.command->ExecuteBlock(*_ps, argument, _result);
 
-    std::size_t response_size;
-    std::size_t nr;
-    _con_mutex.lock();
-    // struct iovec iov[response_size];
-    response_size = _responses.size();
-    struct iovec iov[response_size];
-    //iov = new struct iovec[response_size];
-    for (std::size_t i = 0; i < response_size; i++) {
-        iov[i].iov_base = &_responses[i][0];
-        iov[i].iov_len = _responses[i].size();
+            std::lock_guard<std::mutex> lock(_con_mutex);
+            _responses.push_back(Response());
+            _event.events = READ_WRITE_EVENT;
+        }
+    } catch (std::runtime_error &ex) {
+        _logger->error("Failed to process connection on descriptor {}: {}", _socket, ex.what());
     }
-    _con_mutex.unlock();
-    iov[0].iov_base = static_cast<char *>(iov[0].iov_base) + _written_bytes;
-    iov[0].iov_len -= _written_bytes;
+    _pending.clear();
+}
 
-    nr = writev(_socket, iov, response_size);
+// See Connection.h
+struct iovec Connection::Response() {
+    struct iovec response;
+    response.iov_len = _result.size() + 2;
+    response.iov_base = _arenas[_current].allocate(response.iov_len);
+    std::memcpy(response.iov_base, _result.data(), _result.size());
+    std::memcpy(static_cast<char *>(response.iov_base) + _result.size(), "\r\n", 2);
+    return response;
+}
+
+// See Connection.h
+void Connection::Rotate() {
+    std::lock_guard<std::mutex> lock(_con_mutex);
+    if (_arenas[_current].Used() < kArenaRotate || _old_responses != 0) {
+        return;
+    }
+
+    // Responses queued so far are all that is left in the current arena, the other one is free
+    _current ^= 1;
+    _arenas[_current].Reset();
+    _old_responses = _responses.size();
+}
+
+// See Connection.h
+void Connection::DoWrite() {
+    _logger->debug("DoWrite worker: {}", _socket);
+
+    std::lock_guard<std::mutex> lock_guard(_con_mutex);
+    ssize_t nr = writev(_socket, _responses.data(), std::min<std::size_t>(_responses.size(), IOV_MAX));
     if (nr == -1) {
         _logger->error("Failed iovec write, {}", _socket);
         OnClose();
@@ -146,20 +192,25 @@ void Connection::DoWrite() {
     }
 
     _logger->debug("Written {} bytes", nr);
-    _written_bytes += nr;
-    std::size_t pos_w = 0;
-    while (pos_w < response_size && _written_bytes >= iov[pos_w].iov_len) {
-        pos_w++;
-        _written_bytes -= iov[pos_w].iov_len;
+    std::size_t done = 0;
+    while (done < _responses.size() && std::size_t(nr) >= _responses[done].iov_len) {
+        nr -= _responses[done].iov_len;
+        done++;
+    }
+    if (done < _responses.size()) {
+        _responses[done].iov_base = static_cast<char *>(_responses[done].iov_base) + nr;
+        _responses[done].iov_len -= nr;
     }
+    _responses.erase(_responses.begin(), _responses.begin() + done);
+    _old_responses -= std::min(done, _old_responses);
 
-    {
-        std::lock_guard<std::mutex> lock_guard(_con_mutex);
-        _responses.erase(_responses.begin(), _responses.begin() + pos_w);
+    if (_responses.empty()) {
+        _event.events = READ_EVENT;
+        _logger->debug("End DoWrite. No responses");
 
-        if (_responses.empty()) {
-            _event.events = READ_EVENT;
-            _logger->debug("End DoWrite. No responses");
+        // Command waiting for its data or to be run still lives in the arena
+        if (!command_to_execute && _pending.empty()) {
+            _arenas[_current].Reset();
         }
     }
 }
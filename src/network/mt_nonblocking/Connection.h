@@ -10,8 +10,11 @@
 #include <atomic>
 
 #include <sys/epoll.h>
+#include <afina/Executor.h>
 #include <afina/execute/Command.h>
 #include <afina/Storage.h>
+#include <afina/allocator/Arena.h>
+#include <afina/allocator/Pooled.h>
 #include "protocol/Parser.h"
 #include <spdlog/logger.h>
 
@@ -23,15 +26,20 @@ namespace Afina {
 namespace Network {
 namespace MTnonblock {
 
-class Connection {
+class Connection : public Allocator::Pooled {
 public:
-    Connection(int s, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl) :
-     _socket(s), _ps(ps), _logger(pl) {
+    Connection(int s, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl,
+               Afina::Executor *executor = nullptr) :
+     _socket(s), _ps(ps), _logger(pl), _executor(executor), _current(0), _old_responses(0), arg_remains(0),
+     _readed_bytes(0) {
         std::memset(&_event, 0, sizeof(struct epoll_event));
     }
 
     inline bool isAlive() const { return _alive.load(); }
 
+    // There are commands parsed by DoRead waiting to be run by ExecutePending
+    inline bool HasPending() const { return !_pending.empty(); }
+
     void Start();
 
 protected:
@@ -40,7 +48,20 @@ protected:
     void DoRead();
     void DoWrite();
 
+    // Runs pending commands in the order they came and queues their responses
+    void ExecutePending();
+
+    // Copies result of the last command along with trailing \r\n into the arena
+    struct iovec Response();
+
+    // Makes the other arena current once the current one has given out kArenaRotate bytes and the other one
+    // has no responses left. Must be called only when no command lives in the arenas
+    void Rotate();
+
 private:
+    // Bytes current arena gives out before Rotate switches to the other one
+    static const std::size_t kArenaRotate = 64 * 1024;
+
     friend class Worker;
     friend class ServerImpl;
 
@@ -53,17 +74,41 @@ private:
     std::shared_ptr<Afina::Storage> _ps;
     std::shared_ptr<spdlog::logger> _logger;
 
+    // Pool to run commands on, nullptr if they are run right in DoRead
+    Afina::Executor *_executor;
+
     std::mutex _con_mutex;
 
+    // Commands and responses live in the current arena, which is reset once all the responses are written
+    // out, so that steady request flow takes no memory from the heap. Client that never lets responses drain
+    // gets arenas rotated instead, see Rotate. Declared first to outlive command
+    Allocator::Arena _arenas[2];
+    std::size_t _current;
+
+    // Number of responses at the head of _responses living in the other arena
+    std::size_t _old_responses;
+
     std::size_t arg_remains;
     Protocol::Parser parser;
     std::string argument_for_command;
-    std::unique_ptr<Execute::Command> command_to_execute;
+    Allocator::Arena::ptr<Execute::Command> command_to_execute;
     char _client_buffer[4096];
 
     uint32_t _readed_bytes;
-    std::size_t _written_bytes;
-    std::vector<std::string> _responses;
+
+    // Output of the last command, kept to reuse its buffer
+    std::string _result;
+
+    // Responses waiting to be written, first one could be written partially. Bytes are in the arenas
+    std::vector<struct iovec> _responses;
+
+    // Commands parsed but not run yet, along with their data blocks copied into the arena as they came
+    struct pending_command {
+        Allocator::Arena::ptr<Execute::Command> command;
+        const char *argument;
+        std::size_t argument_size;
+    };
+    std::vector<pending_command> _pending;
 };
 
 } // namespace MTnonblock
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <memory>
 #include <stdexcept>
+#include <vector>
 
 #include <arpa/inet.h>
 #include <netdb.h>
@@ -29,8 +30,12 @@ namespace Afina {
 namespace Network {
 namespace MTnonblock {
 
+// Connections allowed to wait for the pool, commands of next ones are run on their I/O thread
+static const std::size_t kMaxQueuedConnections = 1024;
+
 // See Server.h
-ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl) : Server(ps, pl) {}
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl, uint32_t n_executors)
+    : Server(ps, pl), _n_executors(n_executors) {}
 
 // See Server.h
 ServerImpl::~ServerImpl() {}
@@ -94,9 +99,14 @@ void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers)
         throw std::runtime_error("Failed to add eventfd descriptor to epoll");
     }
 
+    if (_n_executors > 0) {
+        _executor.reset(new Afina::Executor("mt_nonblock_exec", _n_executors, _n_executors, kMaxQueuedConnections,
+                                            std::chrono::seconds(10)));
+    }
+
     _workers.reserve(n_workers);
     for (int i = 0; i < n_workers; i++) {
-        _workers.emplace_back(pStorage, pLogging, _conns);
+        _workers.emplace_back(pStorage, pLogging, _conns, _conns_mutex, _executor.get());
         _workers.back().Start(_data_epoll_fd);
     }
 
@@ -120,13 +130,13 @@ void ServerImpl::Stop() {
         throw std::runtime_error("Failed to wakeup workers");
     }
 
-    _logger->debug("Clean up {} connections", _conns.size());
-    for (auto con : _conns) {
-        close(con->_socket);
-        con->OnClose();
-        delete con;
+    // Connections, whose commands are running, are owned by the pool until they are done
+    if (_executor) {
+        _executor->Stop(true);
+
+        // Tells whether commands were waiting for the pool or running slow
+        _logger->info("Executor stats: {}", _executor->FormatStats());
     }
-    _conns.clear();
 }
 
 // See Server.h
@@ -138,6 +148,16 @@ void ServerImpl::Join() {
     for (auto &w : _workers) {
         w.Join();
     }
+
+    // Worker could be still handling some connection until it is joined, so connections left are deleted only now
+    std::lock_guard<std::mutex> lock(_conns_mutex);
+    _logger->debug("Clean up {} connections", _conns.size());
+    for (auto con : _conns) {
+        close(con->_socket);
+        con->OnClose();
+        delete con;
+    }
+    _conns.clear();
 }
 
 // See ServerImpl.h
@@ -201,12 +221,15 @@ void ServerImpl::OnRun() {
                 }
 
                 // Register the new FD to be monitored by epoll.
-                Connection *pc = new Connection(infd, pStorage, _logger);
+                Connection *pc = new Connection(infd, pStorage, _logger, _executor.get());
 
                 if (pc == nullptr) {
                     throw std::runtime_error("Failed to allocate connection");
                 }
-                _conns.insert(pc);
+                {
+                    std::lock_guard<std::mutex> lock(_conns_mutex);
+                    _conns.insert(pc);
+                }
                 // Register connection in worker's epoll
                 pc->Start();
                 if (pc->isAlive()) {
@@ -215,7 +238,10 @@ void ServerImpl::OnRun() {
                         _logger->error("Can't register connection in worker's epoll");
                         pc->OnError();
                         close(pc->_socket);
-                        _conns.erase(pc);
+                        {
+                            std::lock_guard<std::mutex> lock(_conns_mutex);
+                            _conns.erase(pc);
+                        }
                         delete pc;
                     }
                 }
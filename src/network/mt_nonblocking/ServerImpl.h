@@ -1,11 +1,13 @@
 #ifndef AFINA_NETWORK_MT_NONBLOCKING_SERVER_H
 #define AFINA_NETWORK_MT_NONBLOCKING_SERVER_H
 
+#include <mutex>
 #include <thread>
 #include <vector>
 #include <set>
 
 #include "Connection.h"
+#include <afina/Executor.h>
 #include <afina/network/Server.h>
 
 namespace spdlog {
@@ -21,11 +23,12 @@ class Worker;
 
 /**
  * # Network resource manager implementation
- * Epoll based server
+ * Epoll based server. Commands are run by the worker which has read them, or by the pool of n_executors threads
+ * if there are any, so that slow command doesn't hold I/O of other connections
  */
 class ServerImpl : public Server {
 public:
-    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl);
+    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl, uint32_t n_executors = 0);
     ~ServerImpl();
 
     // See Server.h
@@ -65,7 +68,13 @@ private:
     // threads serving read/write requests
     std::vector<Worker> _workers;
 
+    // Live connections, acceptors add them while workers and pool threads remove closed ones
+    std::mutex _conns_mutex;
     std::set<Connection *> _conns;
+
+    // Pool running commands, empty if workers run them
+    uint32_t _n_executors;
+    std::unique_ptr<Afina::Executor> _executor;
 };
 
 } // namespace MTnonblock
@@ -11,6 +11,7 @@
 
 #include <spdlog/logger.h>
 
+#include <afina/Executor.h>
 #include <afina/logging/Service.h>
 
 #include "Connection.h"
@@ -22,8 +23,9 @@ namespace MTnonblock {
 
 // See Worker.h
 Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl,
-               std::set<Connection *> &_conns)
-    : _pStorage(ps), _pLogging(pl), isRunning(false), _epoll_fd(-1), _conns(_conns) {
+               std::set<Connection *> &_conns, std::mutex &conns_mutex, Afina::Executor *executor)
+    : _pStorage(ps), _pLogging(pl), isRunning(false), _epoll_fd(-1), _conns(_conns), _conns_mutex(conns_mutex),
+      _executor(executor) {
     // TODO: implementation here
 }
 
@@ -33,7 +35,7 @@ Worker::~Worker() {
 }
 
 // See Worker.h
-Worker::Worker(Worker &&other) : _conns(other._conns) { *this = std::move(other); }
+Worker::Worker(Worker &&other) : _conns(other._conns), _conns_mutex(other._conns_mutex) { *this = std::move(other); }
 
 // See Worker.h
 Worker &Worker::operator=(Worker &&other) {
@@ -42,6 +44,7 @@ Worker &Worker::operator=(Worker &&other) {
     _logger = std::move(other._logger);
     _thread = std::move(other._thread);
     _epoll_fd = other._epoll_fd;
+    _executor = other._executor;
 
     other._epoll_fd = -1;
     return *this;
@@ -107,33 +110,58 @@ void Worker::OnRun() {
                 }
             }
 
-            // Rearm connection
-            if (pconn->isAlive()) {
-                pconn->_event.events |= EPOLLONESHOT;
-                if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, pconn->_socket, &pconn->_event)) {
-                    pconn->OnError();
-                    close(pconn->_socket);
-                    _conns.erase(pconn);
-                    delete pconn;
+            // Connection stays disarmed while its commands run on the pool, so that nobody else touches it and
+            // responses are queued in the order commands came. Full pool makes commands run right here
+            if (pconn->isAlive() && pconn->HasPending()) {
+                if (_executor->Execute(&Worker::Process, this, pconn)) {
+                    continue;
                 }
+                pconn->ExecutePending();
             }
-            // Or delete closed one
-            else {
-                if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, pconn->_socket, &pconn->_event)) {
-                    std::cerr << "Failed to delete connection!" << std::endl;
-                    _logger->debug(strerror(errno));
-                    pconn->OnError();
-                }
-                close(pconn->_socket);
-                _conns.erase(pconn);
-                delete pconn;
-            }
+            Rearm(pconn);
         }
         // TODO: Select timeout...
     }
     _logger->warn("Worker stopped");
 }
 
+// See Worker.h
+void Worker::Process(Connection *pconn) {
+    pconn->ExecutePending();
+    Rearm(pconn);
+}
+
+// See Worker.h
+void Worker::Rearm(Connection *pconn) {
+    // Rearm connection
+    if (pconn->isAlive()) {
+        pconn->_event.events |= EPOLLONESHOT;
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, pconn->_socket, &pconn->_event)) {
+            pconn->OnError();
+            Forget(pconn);
+        }
+    }
+    // Or delete closed one
+    else {
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, pconn->_socket, &pconn->_event)) {
+            std::cerr << "Failed to delete connection!" << std::endl;
+            _logger->debug(strerror(errno));
+            pconn->OnError();
+        }
+        Forget(pconn);
+    }
+}
+
+// See Worker.h
+void Worker::Forget(Connection *pconn) {
+    close(pconn->_socket);
+    {
+        std::lock_guard<std::mutex> lock(_conns_mutex);
+        _conns.erase(pconn);
+    }
+    delete pconn;
+}
+
 } // namespace MTnonblock
 } // namespace Network
 } // namespace Afina
@@ -3,6 +3,7 @@
 
 #include <atomic>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <set>
 
@@ -16,6 +17,7 @@ namespace Afina {
 
 // Forward declaration, see afina/Storage.h
 class Storage;
+class Executor;
 namespace Logging {
 class Service;
 }
@@ -30,7 +32,8 @@ namespace MTnonblock {
  */
 class Worker {
 public:
-    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl, std::set<Connection *>& _conns);
+    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl,
+           std::set<Connection *> &_conns, std::mutex &conns_mutex, Afina::Executor *executor = nullptr);
     ~Worker();
 
     Worker(Worker &&);
@@ -63,6 +66,21 @@ protected:
      */
     void OnRun();
 
+    /**
+     * Runs commands connection has read on the executor thread, then gives connection back to epoll
+     */
+    void Process(Connection *pconn);
+
+    /**
+     * Arms connection for the next event or deletes it if it is dead. Runs on pool threads as well
+     */
+    void Rearm(Connection *pconn);
+
+    /**
+     * Closes connection and deletes it
+     */
+    void Forget(Connection *pconn);
+
 private:
     Worker(Worker &) = delete;
     Worker &operator=(Worker &) = delete;
@@ -85,7 +103,12 @@ private:
     // EPOLL descriptor using for events processing
     int _epoll_fd;
 
+    // Live connections, shared with acceptors and other workers, guarded by _conns_mutex
     std::set<Connection *>& _conns;
+    std::mutex &_conns_mutex;
+
+    // Pool running commands, nullptr if they are run on this thread
+    Afina::Executor *_executor;
 };
 
 } // namespace MTnonblock
@@ -217,7 +217,7 @@ void ServerImpl::OnRun() {
                         _logger->debug("Start command execution");
 
                         std::string result;
-                        command_to_execute->Execute(*pStorage, argument_for_command, result);
+                        command_to_execute->ExecuteBlock(*pStorage, argument_for_command, result);
 
                         // Send response
                         result += "\r\n";
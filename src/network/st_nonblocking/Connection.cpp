@@ -1,5 +1,7 @@
 #include "Connection.h"
 
+#include <algorithm>
+#include <climits>
 #include <iostream>
 #include <sys/uio.h>
 
@@ -55,7 +57,8 @@ void Connection::DoRead() {
                         // There is no command to be launched, continue to parse input stream
                         // Here we are, current chunk finished some command, process it
                         _logger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
-                        command_to_execute = parser.Build(arg_remains);
+                        Rotate();
+                        command_to_execute = parser.Build(arg_remains, _arenas[_current]);
                         if (arg_remains > 0) {
                             arg_remains += 2;
                         }
@@ -87,16 +90,13 @@ void Connection::DoRead() {
                 if (command_to_execute && arg_remains == 0) {
                     _logger->debug("Start command execution");
 
-                    std::string result;
                     // _logger->debug("Waiting for 5 sec...");
                     // std::this_thread::sleep_for(std::chrono::seconds(5));
-                    command_to_execute->Execute(*_ps, argument_for_command, result);
-
+                    command_to_execute->ExecuteBlock(*_ps, argument_for_command, _result);
 
                     // Send response
-                    result += "\r\n";
-                    _logger->debug("Result: {}", result);
-                    _responses.push_back(result);
+                    _logger->debug("Result: {}", _result);
+                    _responses.push_back(Response());
 
                     _logger->debug("Set socket to write {}", _socket);
                     _event.events |= EPOLLOUT;
@@ -118,43 +118,60 @@ void Connection::DoRead() {
     }
 }
 
+// See Connection.h
+struct iovec Connection::Response() {
+    struct iovec response;
+    response.iov_len = _result.size() + 2;
+    response.iov_base = _arenas[_current].allocate(response.iov_len);
+    std::memcpy(response.iov_base, _result.data(), _result.size());
+    std::memcpy(static_cast<char *>(response.iov_base) + _result.size(), "\r\n", 2);
+    return response;
+}
+
+// See Connection.h
+void Connection::Rotate() {
+    if (_arenas[_current].Used() < kArenaRotate || _old_responses != 0) {
+        return;
+    }
+
+    // Responses queued so far are all that is left in the current arena, the other one is free
+    _current ^= 1;
+    _arenas[_current].Reset();
+    _old_responses = _responses.size();
+}
+
 // See Connection.h
 void Connection::DoWrite() {
-  _logger->debug("DoWrite worker: {}", _socket);
-  std::size_t response_size = _responses.size();
-  std::size_t nr;
-  struct iovec iov[response_size];
-  for (std::size_t i = 0; i < response_size; i++)
-  {
-    iov[i].iov_base = &_responses[i][0];
-    iov[i].iov_len = _responses[i].size();
-  }
-
-  iov[0].iov_base = static_cast<char*>(iov[0].iov_base) + _written_bytes;
-  iov[0].iov_len -= _written_bytes;
-
-  nr = writev(_socket, iov, response_size);
-  if (nr == -1)
-  {
-    _logger->error("Failed iovec write, {}", _socket);
-    OnClose();
-    return;
-  }
-
-  _logger->debug("Written {} bytes", nr);
-  _written_bytes += nr;
-  std::size_t pos_w = 0;
-  while (pos_w < response_size && _written_bytes >= iov[pos_w].iov_len)
-  {
-    pos_w++;
-    _written_bytes -= iov[pos_w].iov_len;
-  }
-  _responses.erase(_responses.begin(), _responses.begin() + pos_w);
-
-  if (_responses.empty()) {
-    _event.events &= ~EPOLLOUT;
-    _logger->debug("End DoWrite. No responses");
-  }
+    _logger->debug("DoWrite worker: {}", _socket);
+    ssize_t nr = writev(_socket, _responses.data(), std::min<std::size_t>(_responses.size(), IOV_MAX));
+    if (nr == -1) {
+        _logger->error("Failed iovec write, {}", _socket);
+        OnClose();
+        return;
+    }
+
+    _logger->debug("Written {} bytes", nr);
+    std::size_t done = 0;
+    while (done < _responses.size() && std::size_t(nr) >= _responses[done].iov_len) {
+        nr -= _responses[done].iov_len;
+        done++;
+    }
+    if (done < _responses.size()) {
+        _responses[done].iov_base = static_cast<char *>(_responses[done].iov_base) + nr;
+        _responses[done].iov_len -= nr;
+    }
+    _responses.erase(_responses.begin(), _responses.begin() + done);
+    _old_responses -= std::min(done, _old_responses);
+
+    if (_responses.empty()) {
+        _event.events &= ~EPOLLOUT;
+        _logger->debug("End DoWrite. No responses");
+
+        // Command waiting for its data still lives in the arena
+        if (!command_to_execute) {
+            _arenas[_current].Reset();
+        }
+    }
 }
 
 } // namespace STnonblock
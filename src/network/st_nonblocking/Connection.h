@@ -2,11 +2,16 @@
 #define AFINA_NETWORK_ST_NONBLOCKING_CONNECTION_H
 
 #include <cstring>
+#include <string>
+#include <vector>
 
 #include <sys/epoll.h>
+#include <sys/uio.h>
 //#include <spdlog/logger.h>
 
 #include <afina/Storage.h>
+#include <afina/allocator/Arena.h>
+#include <afina/allocator/Pooled.h>
 #include <afina/execute/Command.h>
 #include <afina/logging/Service.h>
 
@@ -20,10 +25,10 @@ namespace Afina {
 namespace Network {
 namespace STnonblock {
 
-class Connection {
+class Connection : public Allocator::Pooled {
 public:
     Connection(int s, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl)
-        : _socket(s), _ps(ps), _logger(pl) {
+        : _socket(s), _ps(ps), _logger(pl), _current(0), _old_responses(0), arg_remains(0), _readed_bytes(0) {
 
         std::memset(&_event, 0, sizeof(struct epoll_event));
         _event.data.ptr = this;
@@ -39,7 +44,17 @@ protected:
     void DoRead();
     void DoWrite();
 
+    // Copies result of the last command along with trailing \r\n into the arena
+    struct iovec Response();
+
+    // Makes the other arena current once the current one has given out kArenaRotate bytes and the other one
+    // has no responses left. Must be called only when no command lives in the arenas
+    void Rotate();
+
 private:
+    // Bytes current arena gives out before Rotate switches to the other one
+    static const std::size_t kArenaRotate = 64 * 1024;
+
     friend class ServerImpl;
 
     int _socket;
@@ -48,15 +63,28 @@ private:
     std::shared_ptr<Afina::Storage> _ps;
     std::shared_ptr<spdlog::logger> _logger;
 
+    // Commands and responses live in the current arena, which is reset once all the responses are written
+    // out, so that steady request flow takes no memory from the heap. Client that never lets responses drain
+    // gets arenas rotated instead, see Rotate. Declared first to outlive command
+    Allocator::Arena _arenas[2];
+    std::size_t _current;
+
+    // Number of responses at the head of _responses living in the other arena
+    std::size_t _old_responses;
+
     std::size_t arg_remains;
     Protocol::Parser parser;
     std::string argument_for_command;
-    std::unique_ptr<Execute::Command> command_to_execute;
+    Allocator::Arena::ptr<Execute::Command> command_to_execute;
     char _client_buffer[4096];
 
     uint32_t _readed_bytes;
-    std::size_t _written_bytes;
-    std::vector<std::string> _responses;
+
+    // Output of the last command, kept to reuse its buffer
+    std::string _result;
+
+    // Responses waiting to be written, first one could be written partially. Bytes are in the arenas
+    std::vector<struct iovec> _responses;
 };
 
 } // namespace STnonblock
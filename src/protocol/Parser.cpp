@@ -1,14 +1,21 @@
 #include "Parser.h"
 
+#include <cstdint>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
 
 #include <afina/execute/Add.h>
 #include <afina/execute/Append.h>
+#include <afina/execute/Cas.h>
 #include <afina/execute/Command.h>
 #include <afina/execute/Delete.h>
 #include <afina/execute/Get.h>
+#include <afina/execute/Increment.h>
+#include <afina/execute/InvalidateTag.h>
+#include <afina/execute/LeaseGet.h>
+#include <afina/execute/LeaseSet.h>
 #include <afina/execute/Set.h>
 #include <afina/execute/Stats.h>
 
@@ -28,10 +35,14 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
         case State::sName: {
             if (c == ' ' || c == '\r') {
                 // std::cout << "parser debug: name='" << name << "'" << std::endl;
-                if (name == "set" || name == "add" || name == "append" || name == "prepend") {
+                if (name == "set" || name == "add" || name == "append" || name == "prepend" || name == "lset" ||
+                    name == "cas") {
                     state = State::spKey;
-                } else if (name == "get" || name == "gets") {
+                } else if (name == "get" || name == "gets" || name == "lget" || name == "delete" ||
+                           name == "invalidate_tag") {
                     state = State::sgKey;
+                } else if (name == "incr" || name == "decr") {
+                    state = State::scKey;
                 } else if (name == "stats") {
                     state = State::sLF;
                     continue;
@@ -48,9 +59,11 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
             if (c == ' ') {
                 state = State::spFlags;
                 keys.push_back(curKey);
+                hashes.push_back(curHash.Digest());
                 // std::cout << "parser debug: key[" << keys.size() - 1 << "]='" << curKey << "'" << std::endl;
             } else {
                 curKey.push_back(c);
+                curHash.Update(c);
             }
             break;
         }
@@ -58,6 +71,7 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
         case State::sgKey: {
             if (c == '\r') {
                 keys.push_back(curKey);
+                hashes.push_back(curHash.Digest());
                 // std::cout << "parser debug: total '" << keys.size() << " keys" << std::endl;
 
                 if (keys.size() == 0) {
@@ -65,14 +79,46 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
                 }
 
                 curKey.clear();
+                curHash.Reset();
                 state = State::sLF;
             } else if (c == ' ') {
                 // std::cout << "parser debug: key[" << keys.size() << "]='" << curKey << "'" << std::endl;
                 state = State::sgKey;
                 keys.push_back(curKey);
+                hashes.push_back(curHash.Digest());
                 curKey.clear();
+                curHash.Reset();
             } else {
                 curKey.push_back(c);
+                curHash.Update(c);
+            }
+            break;
+        }
+
+        case State::scKey: {
+            if (c == ' ') {
+                state = State::scDelta;
+                keys.push_back(curKey);
+                hashes.push_back(curHash.Digest());
+            } else {
+                curKey.push_back(c);
+                curHash.Update(c);
+            }
+            break;
+        }
+
+        case State::scDelta: {
+            if (c == '\r') {
+                state = State::sLF;
+            } else if (c >= '0' && c <= '9') {
+                uint64_t d = delta * 10 + (c - '0');
+                if (delta > UINT64_MAX / 10 || d < delta * 10) {
+                    // Overflow
+                    throw std::runtime_error("Delta field overflow");
+                }
+                delta = d;
+            } else if (c != ' ') {
+                throw std::runtime_error("Invalid numeric delta argument");
             }
             break;
         }
@@ -109,19 +155,11 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
                 state = State::spBytes;
                 // std::cout << "parser debug: ExprTime='" << exprtime << "'" << std::endl;
             } else if (c >= '0' && c <= '9') {
-                int32_t et = exprtime;
-                if (negative) {
-                    et -= (c - '0');
-                    if (et > exprtime) {
-                        throw std::runtime_error("Expire time field overflow");
-                    }
-                } else {
-                    et += (c - '0');
-                    if (et < exprtime) {
-                        throw std::runtime_error("Expire time field overflow");
-                    }
+                int64_t et = int64_t(exprtime) * 10 + (negative ? -(c - '0') : (c - '0'));
+                if (et > INT32_MAX || et < INT32_MIN) {
+                    throw std::runtime_error("Expire time field overflow");
                 }
-                exprtime = et;
+                exprtime = int32_t(et);
             }
             break;
         }
@@ -130,6 +168,14 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
             if (c == '\r') {
                 state = State::sLF;
                 // std::cout << "parser debug: bytes='" << bytes << "'" << std::endl;
+            } else if (c == ' ') {
+                if (name == "lset") {
+                    state = State::spLease;
+                } else if (name == "cas") {
+                    state = State::spCas;
+                } else {
+                    state = State::spSoftTime;
+                }
             } else if (c >= '0' && c <= '9') {
                 uint32_t b = (bytes * 10) + (c - '0');
                 if (b < bytes) {
@@ -141,6 +187,82 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
             break;
         }
 
+        case State::spLease: {
+            if (c == '\r') {
+                state = State::sLF;
+            } else if (c == ' ') {
+                state = State::spSoftTime;
+            } else if (c >= '0' && c <= '9') {
+                uint64_t l = (lease * 10) + (c - '0');
+                if (l < lease) {
+                    // Overflow
+                    throw std::runtime_error("Lease token field overflow");
+                }
+                lease = l;
+            }
+            break;
+        }
+
+        case State::spCas: {
+            if (c == '\r') {
+                state = State::sLF;
+            } else if (c == ' ') {
+                state = State::spSoftTime;
+            } else if (c >= '0' && c <= '9') {
+                uint64_t v = cas * 10 + (c - '0');
+                if (cas > UINT64_MAX / 10 || v < cas * 10) {
+                    // Overflow
+                    throw std::runtime_error("Cas unique field overflow");
+                }
+                cas = v;
+            }
+            break;
+        }
+
+        case State::spSoftTime: {
+            if (c == '\r') {
+                state = State::sLF;
+            } else if (c == '#') {
+                curKey.clear();
+                curHash.Reset();
+                state = State::spTag;
+            } else if (c >= '0' && c <= '9') {
+                int64_t st = int64_t(softtime) * 10 + (c - '0');
+                if (st > INT32_MAX) {
+                    throw std::runtime_error("Soft expire time field overflow");
+                }
+                softtime = int32_t(st);
+            }
+            break;
+        }
+
+        case State::spTag: {
+            if (c == ' ' || c == '\r') {
+                if (curKey.empty()) {
+                    throw std::runtime_error("Empty tag");
+                }
+                tags.push_back(curHash.Digest());
+                state = c == ' ' ? State::spTagNext : State::sLF;
+            } else {
+                curKey.push_back(c);
+                curHash.Update(c);
+            }
+            break;
+        }
+
+        case State::spTagNext: {
+            if (c == '\r') {
+                state = State::sLF;
+            } else if (c == '#') {
+                curKey.clear();
+                curHash.Reset();
+                state = State::spTag;
+            } else if (c != ' ') {
+                throw std::runtime_error("Only tags could follow tags");
+            }
+            break;
+        }
+
         case State::sLF: {
             if (c == '\n') {
                 parse_complete = true;
@@ -161,23 +283,61 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
     return parse_complete;
 }
 
+// Creates command on the heap or in the arena
+template <typename T, typename... Args> static T *Make(Allocator::Arena *arena, Args &&... args) {
+    if (arena == nullptr) {
+        return new T(std::forward<Args>(args)...);
+    }
+    return arena->New<T>(std::forward<Args>(args)...).release();
+}
+
 // See Parse.h
 std::unique_ptr<Execute::Command> Parser::Build(size_t &body_size) const {
+    return std::unique_ptr<Execute::Command>(Construct(body_size, nullptr));
+}
+
+// See Parse.h
+Allocator::Arena::ptr<Execute::Command> Parser::Build(size_t &body_size, Allocator::Arena &arena) const {
+    return Allocator::Arena::ptr<Execute::Command>(Construct(body_size, &arena));
+}
+
+// See Parse.h
+Execute::Command *Parser::Construct(size_t &body_size, Allocator::Arena *arena) const {
     if (state != State::sLF) {
-        return std::unique_ptr<Execute::Command>(nullptr);
+        return nullptr;
     }
 
     body_size = bytes;
+    Execute::InsertCommand *insert = nullptr;
     if (name == "set") {
-        return std::unique_ptr<Execute::Command>(new Execute::Set(keys[0], flags, exprtime));
+        insert = Make<Execute::Set>(arena, keys[0], hashes[0], flags, exprtime, softtime);
     } else if (name == "add") {
-        return std::unique_ptr<Execute::Command>(new Execute::Add(keys[0], flags, exprtime));
+        insert = Make<Execute::Add>(arena, keys[0], hashes[0], flags, exprtime, softtime);
     } else if (name == "append") {
-        return std::unique_ptr<Execute::Command>(new Execute::Append(keys[0], flags, exprtime));
-    } else if (name == "get") {
-        return std::unique_ptr<Execute::Command>(new Execute::Get(keys));
+        insert = Make<Execute::Append>(arena, keys[0], hashes[0], flags, exprtime, softtime);
+    } else if (name == "lset") {
+        insert = Make<Execute::LeaseSet>(arena, keys[0], hashes[0], flags, exprtime, lease, softtime);
+    } else if (name == "cas") {
+        insert = Make<Execute::Cas>(arena, keys[0], hashes[0], flags, exprtime, cas, softtime);
+    }
+    if (insert != nullptr) {
+        insert->Tag(tags);
+        return insert;
+    }
+
+    Allocator::Arena &keys_arena = arena != nullptr ? *arena : Allocator::Arena::Default();
+    if (name == "get" || name == "gets") {
+        return Make<Execute::Get>(arena, keys, hashes, name == "gets", keys_arena);
+    } else if (name == "lget") {
+        return Make<Execute::LeaseGet>(arena, keys, hashes, keys_arena);
+    } else if (name == "incr" || name == "decr") {
+        return Make<Execute::Increment>(arena, keys[0], hashes[0], delta, name == "decr");
+    } else if (name == "delete") {
+        return Make<Execute::Delete>(arena, keys[0], hashes[0]);
+    } else if (name == "invalidate_tag") {
+        return Make<Execute::InvalidateTag>(arena, keys, hashes);
     } else if (name == "stats") {
-        return std::unique_ptr<Execute::Command>(new Execute::Stats());
+        return Make<Execute::Stats>(arena);
     } else {
         throw std::runtime_error("Unsupported command");
     }
@@ -188,11 +348,18 @@ void Parser::Reset() {
     state = State::sName;
     name.clear();
     keys.clear();
+    hashes.clear();
+    tags.clear();
     curKey.clear();
+    curHash.Reset();
     parse_complete = false;
     flags = 0;
     bytes = 0;
     exprtime = 0;
+    softtime = 0;
+    lease = 0;
+    cas = 0;
+    delta = 0;
 }
 
 } // namespace Protocol
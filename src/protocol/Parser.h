@@ -8,6 +8,9 @@
 #include <cstddef>
 #include <cstdint>
 
+#include <afina/Hash.h>
+#include <afina/allocator/Arena.h>
+
 namespace Afina {
 namespace Execute {
 class Command;
@@ -48,6 +51,12 @@ public:
      */
     std::unique_ptr<Execute::Command> Build(size_t &body_size) const;
 
+    /**
+     * Same as Build, but command and everything it keeps are created in the arena. Command has to be destroyed
+     * before the arena is reset
+     */
+    Allocator::Arena::ptr<Execute::Command> Build(size_t &body_size, Allocator::Arena &arena) const;
+
     /**
      * Reset parse so that it could be used to parse out new command
      */
@@ -56,13 +65,18 @@ public:
     inline const std::string &Name() const { return name; }
 
 private:
+    // Builds command on the heap if there is no arena
+    Execute::Command *Construct(size_t &body_size, Allocator::Arena *arena) const;
+
     /**
      * State of the command parser. Prefixes are:
      * - s: state for PUT and GET commands
      * - sp: for PUT commands only
      * - sg: for GET commands only
+     * - sc: for INCR/DECR commands only
      */
-    enum State : uint16_t { sCR, sLF, sName, spKey, spFlags, spExprTimeStart, spExprTime, spBytes, sgKey };
+    enum State : uint16_t { sCR, sLF, sName, spKey, spFlags, spExprTimeStart, spExprTime, spBytes, spLease,
+                       spCas, spSoftTime, spTag, spTagNext, sgKey, scKey, scDelta };
 
     // Current parser state
     State state;
@@ -71,6 +85,9 @@ private:
     std::string name;
     std::vector<std::string> keys;
 
+    // Hash of each key in keys, computed while key bytes are parsed out
+    std::vector<uint64_t> hashes;
+
     // <flags> is an arbitrary 16-bit unsigned integer (written out in decimal) that the server stores along with
     // the data and sends back when the item is retrieved. Clients may use this as a bit field to store data-specific
     //  information; this field is opaque to the server. Note that in memcached 1.2.1 and higher, flags may be 32-bits,
@@ -88,8 +105,26 @@ private:
     // it's followed by an empty data block).
     uint32_t bytes;
 
+    // <token> is the lease token got from lget, only lset command has it after <bytes>
+    uint64_t lease;
+
+    // <cas unique> is the item version got from gets, only cas command has it after <bytes>
+    uint64_t cas;
+
+    // [<soft_exptime>] is optional last field of storage commands, same as <exptime> but item is served as
+    // stale after it, while one client refreshes it. Zero means there is no soft TTL
+    int32_t softtime;
+
+    // [#<tag>]* are optional tags of storage commands, following all the other fields. Item could be
+    // invalidated along with all the others having the same tag. Kept as KeyHash::Of(tag)
+    std::vector<uint64_t> tags;
+
+    // <value> of incr/decr is the amount to change counter by, 64-bit unsigned integer
+    uint64_t delta;
+
     bool negative;
     std::string curKey;
+    KeyHash curHash;
     bool parse_complete;
 };
 
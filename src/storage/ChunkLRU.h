@@ -0,0 +1,192 @@
+#ifndef AFINA_STORAGE_CHUNK_LRU_H
+#define AFINA_STORAGE_CHUNK_LRU_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * Counters kept along with chunks, layout is a part of SharedLRU segment format
+ */
+struct chunk_stats {
+    uint64_t items;
+    uint64_t bytes;
+    uint64_t evictions;
+
+    // Last version given to an item
+    uint64_t cas;
+};
+
+/**
+ * # Size classes, free lists and LRU lists over chunk references
+ * Machinery shared by storages that keep items in chunks of memcached-like size classes and link them
+ * by references instead of pointers. Ref is the reference type, zero means "none". Where the memory
+ * lives and how reference turns into address is up to Derived, which has to provide (being a friend):
+ *
+ * - item *ItemAt(Ref) const: chunk header, with hash, hnext, prev, next, key_size, value_size, cls and
+ *   live fields and data() returning key bytes followed by value ones
+ * - class &ClassAt(uint32_t) const and uint32_t ClassCount() const: size classes ordered by size,
+ *   each has size, free, head and tail fields
+ * - Ref &Bucket(uint64_t hash) const: head of the index chain for the hash
+ * - chunk_stats &Stats() const
+ * - bool Grow(uint32_t cls): puts fresh chunks into the class free list, false if no memory is left
+ * - bool Steal(uint32_t cls): same, but by taking memory away from other classes
+ * - void Fill(item *, const ItemInfo &) const: copies item attributes Derived keeps
+ *
+ * Item is marked live only once it is completely written and unmarked before anything else on removal,
+ * so that storage in the shared memory could tell complete items after crash.
+ */
+template <typename Derived, typename Ref> class ChunkLRU {
+protected:
+    // Link that points to the item with given key, or the zero link at the end of bucket chain
+    Ref *Slot(const char *key, size_t size, uint64_t hash) const {
+        Ref *link = &Self().Bucket(hash);
+        while (*link != 0) {
+            auto *item = Self().ItemAt(*link);
+            if (item->hash == hash && item->key_size == size && std::memcmp(item->data(), key, size) == 0) {
+                break;
+            }
+            link = &item->hnext;
+        }
+        return link;
+    }
+
+    // Size class of chunk able to keep given number of bytes, or classes count if there is no such one
+    uint32_t ClassOf(uint64_t size) const {
+        uint32_t lo = 0, hi = Self().ClassCount();
+        while (lo < hi) {
+            uint32_t mid = (lo + hi) / 2;
+            if (Self().ClassAt(mid).size < size) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    // Returns free chunk of the given class, evicting items if necessary. Zero if there is no way to get one
+    Ref Alloc(uint32_t cls) {
+        auto &c = Self().ClassAt(cls);
+        if (c.free == 0 && !Self().Grow(cls)) {
+            if (c.tail != 0) {
+                auto *victim = Self().ItemAt(c.tail);
+                Remove(Slot(victim->data(), victim->key_size, victim->hash));
+                Self().Stats().evictions++;
+            } else if (!Self().Steal(cls)) {
+                return 0;
+            }
+        }
+
+        Ref ref = c.free;
+        c.free = Self().ItemAt(ref)->next;
+        return ref;
+    }
+
+    // Unlinks item pointed by slot and returns its chunk to free list
+    void Remove(Ref *slot) const {
+        Ref ref = *slot;
+        auto *item = Self().ItemAt(ref);
+        item->live = 0;
+        std::atomic_signal_fence(std::memory_order_release);
+
+        *slot = item->hnext;
+        Unlink(ref);
+        Self().Stats().items--;
+        Self().Stats().bytes -= item->key_size + item->value_size;
+
+        auto &c = Self().ClassAt(item->cls);
+        item->next = c.free;
+        c.free = ref;
+    }
+
+    // LRU list of item's class manipulation
+    void Unlink(Ref ref) const {
+        auto *item = Self().ItemAt(ref);
+        auto &c = Self().ClassAt(item->cls);
+        if (item->prev != 0) {
+            Self().ItemAt(item->prev)->next = item->next;
+        } else {
+            c.head = item->next;
+        }
+        if (item->next != 0) {
+            Self().ItemAt(item->next)->prev = item->prev;
+        } else {
+            c.tail = item->prev;
+        }
+    }
+
+    void PushFront(Ref ref) const {
+        auto *item = Self().ItemAt(ref);
+        auto &c = Self().ClassAt(item->cls);
+        item->prev = 0;
+        item->next = c.head;
+        if (c.head != 0) {
+            Self().ItemAt(c.head)->prev = ref;
+        } else {
+            c.tail = ref;
+        }
+        c.head = ref;
+    }
+
+    // Writes new item for the key, replacing existing one if any
+    bool Store(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) {
+        using item_type = typename std::remove_pointer<decltype(Self().ItemAt(0))>::type;
+        if (key.size() > std::numeric_limits<decltype(item_type::key_size)>::max()) {
+            return false;
+        }
+        uint32_t cls = ClassOf(sizeof(item_type) + key.size() + value.size());
+        if (cls == Self().ClassCount()) {
+            return false;
+        }
+
+        Ref ref = Alloc(cls);
+        if (ref == 0) {
+            return false;
+        }
+
+        // Eviction above could change chains, so old item is looked up after it
+        Ref *slot = Slot(key.data(), key.size(), hash);
+        if (*slot != 0) {
+            Remove(slot);
+        }
+
+        auto *item = Self().ItemAt(ref);
+        item->hash = hash;
+        item->cas = ++Self().Stats().cas;
+        item->key_size = key.size();
+        item->value_size = value.size();
+        Self().Fill(item, info);
+        std::memcpy(item->data(), key.data(), key.size());
+        std::memcpy(item->data() + key.size(), value.data(), value.size());
+
+        Ref &head = Self().Bucket(hash);
+        item->hnext = head;
+        head = ref;
+        PushFront(ref);
+        Self().Stats().items++;
+        Self().Stats().bytes += key.size() + value.size();
+
+        // Recovery takes only items completely written
+        std::atomic_signal_fence(std::memory_order_release);
+        item->live = 1;
+        return true;
+    }
+
+private:
+    inline Derived &Self() { return static_cast<Derived &>(*this); }
+    inline const Derived &Self() const { return static_cast<const Derived &>(*this); }
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_CHUNK_LRU_H
@@ -0,0 +1,257 @@
+#include "CompactLRU.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace Afina {
+namespace Backend {
+
+// Smallest chunk, each next class is about 1.25 times bigger than the previous one
+static const uint32_t kMinChunk = 64;
+
+// Chunks start after the first 8 bytes of page, so that no chunk has zero reference
+static const uint32_t kPageStart = 8;
+
+// Index gets one bucket per this many bytes of memory
+static const uint64_t kBytesPerBucket = 128;
+
+// Chunk header, key and value bytes follow it
+struct CompactLRU::item {
+    // Full key hash, index bucket is taken from its low bits
+    uint64_t hash;
+
+    // See ItemInfo
+    uint64_t expire;
+    uint64_t cas;
+
+    // Neighbours in class LRU list, next also links free chunks
+    uint32_t prev;
+    uint32_t next;
+
+    // Next item in the bucket chain
+    uint32_t hnext;
+
+    uint32_t value_size;
+    uint16_t key_size;
+
+    // Size class of the chunk, set once page is carved
+    uint8_t cls;
+    uint8_t live;
+
+    // See ItemInfo
+    uint32_t flags;
+
+    inline char *data() { return reinterpret_cast<char *>(this + 1); }
+    inline bool Expired(uint64_t now) const { return expire != 0 && now >= expire; }
+};
+
+// See CompactLRU.h
+CompactLRU::CompactLRU(size_t max_size)
+    : _max_pages(std::max<size_t>(1, max_size / kPageSize)), _stats{0, 0, 0, 0} {
+    static_assert(sizeof(item) == 48, "Item header has to stay compact");
+    if (uint64_t(_max_pages) > (uint64_t(1) << (32 - kOffsetBits))) {
+        throw std::runtime_error("Memory limit is too big for 32-bit references");
+    }
+
+    for (uint32_t chunk = kMinChunk; chunk < kPageSize - kPageStart;
+         chunk = std::max(chunk + 8, (chunk * 5 / 4 + 7) & ~uint32_t(7))) {
+        _classes.push_back(size_class{chunk, 0, 0, 0, 0});
+    }
+    _classes.push_back(size_class{kPageSize - kPageStart, 0, 0, 0, 0});
+
+    size_t buckets = 1024;
+    while (buckets < uint64_t(_max_pages) * kPageSize / kBytesPerBucket) {
+        buckets *= 2;
+    }
+    _buckets.assign(buckets, 0);
+    _pages.reserve(_max_pages);
+}
+
+// See CompactLRU.h
+uint32_t *CompactLRU::Live(const std::string &key, uint64_t hash) const {
+    uint32_t *slot = Slot(key.data(), key.size(), hash);
+    if (*slot != 0 && ItemAt(*slot)->Expired(ItemInfo::Now())) {
+        Remove(slot);
+    }
+    return slot;
+}
+
+// See CompactLRU.h
+void CompactLRU::Fill(item *it, const ItemInfo &info) const {
+    it->expire = info.expire;
+    it->flags = info.flags;
+}
+
+// See CompactLRU.h
+bool CompactLRU::Grow(uint32_t cls) {
+    if (_pages.size() == _max_pages) {
+        return false;
+    }
+    _pages.push_back(page{std::unique_ptr<char[]>(new char[kPageSize]), 0});
+    Carve(_pages.size() - 1, cls);
+    return true;
+}
+
+// See CompactLRU.h
+void CompactLRU::Carve(uint32_t page_no, uint32_t cls) {
+    size_class &c = _classes[cls];
+    _pages[page_no].cls = cls;
+    c.pages++;
+
+    // Chunks are pushed in reverse, so that they are taken in address order
+    uint32_t count = (kPageSize - kPageStart) / c.size;
+    for (uint32_t i = count; i > 0; i--) {
+        uint32_t ref = (page_no << kOffsetBits) | ((kPageStart + (i - 1) * c.size) >> 3);
+        item *it = ItemAt(ref);
+        it->cls = cls;
+        it->live = 0;
+        it->next = c.free;
+        c.free = ref;
+    }
+}
+
+// See CompactLRU.h
+bool CompactLRU::Steal(uint32_t cls) {
+    uint32_t donor = cls;
+    for (uint32_t i = 0; i < _classes.size(); i++) {
+        if (i != cls && _classes[i].pages > (donor == cls ? 0 : _classes[donor].pages)) {
+            donor = i;
+        }
+    }
+    if (donor == cls) {
+        return false;
+    }
+
+    // The page least recently used item lives on goes away, so that eviction is close to LRU order
+    size_class &d = _classes[donor];
+    uint32_t page_no = (d.tail != 0 ? d.tail : d.free) >> kOffsetBits;
+
+    uint32_t count = (kPageSize - kPageStart) / d.size;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t ref = (page_no << kOffsetBits) | ((kPageStart + i * d.size) >> 3);
+        item *it = ItemAt(ref);
+        if (it->live) {
+            Remove(Slot(it->data(), it->key_size, it->hash));
+            _stats.evictions++;
+        }
+    }
+
+    // All chunks of the page are in the free list now
+    uint32_t *link = &d.free;
+    while (*link != 0) {
+        if ((*link >> kOffsetBits) == page_no) {
+            *link = ItemAt(*link)->next;
+        } else {
+            link = &ItemAt(*link)->next;
+        }
+    }
+    d.pages--;
+
+    Carve(page_no, cls);
+    return true;
+}
+
+// See CompactLRU.h
+bool CompactLRU::Put(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) {
+    std::lock_guard<std::mutex> lck(_mt);
+    return Store(key, hash, value, info);
+}
+
+// See CompactLRU.h
+bool CompactLRU::PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) {
+    std::lock_guard<std::mutex> lck(_mt);
+    if (*Live(key, hash) != 0) {
+        return false;
+    }
+    return Store(key, hash, value, info);
+}
+
+// See CompactLRU.h
+bool CompactLRU::Set(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) {
+    std::lock_guard<std::mutex> lck(_mt);
+    if (*Live(key, hash) == 0) {
+        return false;
+    }
+    return Store(key, hash, value, info);
+}
+
+// See CompactLRU.h
+bool CompactLRU::Delete(const std::string &key, uint64_t hash) {
+    std::lock_guard<std::mutex> lck(_mt);
+    uint32_t *slot = Live(key, hash);
+    if (*slot == 0) {
+        return false;
+    }
+    Remove(slot);
+    return true;
+}
+
+// See CompactLRU.h
+bool CompactLRU::Get(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info) const {
+    std::lock_guard<std::mutex> lck(_mt);
+    uint32_t ref = *Live(key, hash);
+    if (ref == 0) {
+        return false;
+    }
+
+    item *it = ItemAt(ref);
+    value.assign(it->data() + it->key_size, it->value_size);
+    info = ItemInfo();
+    info.expire = it->expire;
+    info.flags = it->flags;
+    info.cas = it->cas;
+
+    Unlink(ref);
+    PushFront(ref);
+    return true;
+}
+
+// See CompactLRU.h
+Storage::CasStatus CompactLRU::CompareAndSwap(const std::string &key, uint64_t hash, const std::string &value,
+                                              const ItemInfo &info, uint64_t cas) {
+    std::lock_guard<std::mutex> lck(_mt);
+    uint32_t ref = *Live(key, hash);
+    if (ref == 0) {
+        return CasStatus::kNotFound;
+    } else if (ItemAt(ref)->cas != cas) {
+        return CasStatus::kExists;
+    }
+    return Store(key, hash, value, info) ? CasStatus::kStored : CasStatus::kNotStored;
+}
+
+// See CompactLRU.h
+Storage::CounterStatus CompactLRU::Increment(const std::string &key, uint64_t hash, uint64_t delta, bool decrement,
+                                             uint64_t &result) {
+    std::lock_guard<std::mutex> lck(_mt);
+    uint32_t ref = *Live(key, hash);
+    if (ref == 0) {
+        return CounterStatus::kNotFound;
+    }
+
+    item *it = ItemAt(ref);
+    uint64_t counter;
+    if (!ParseCounter(std::string(it->data() + it->key_size, it->value_size), counter)) {
+        return CounterStatus::kNotNumber;
+    }
+    result = ApplyDelta(counter, delta, decrement);
+
+    ItemInfo info;
+    info.expire = it->expire;
+    info.flags = it->flags;
+    return Store(key, hash, std::to_string(result), info) ? CounterStatus::kOk : CounterStatus::kNotStored;
+}
+
+// See CompactLRU.h
+void CompactLRU::GetStats(std::vector<std::pair<std::string, std::string>> &stats) const {
+    std::lock_guard<std::mutex> lck(_mt);
+    stats.emplace_back("curr_items", std::to_string(_stats.items));
+    stats.emplace_back("bytes", std::to_string(_stats.bytes));
+    stats.emplace_back("limit_maxbytes", std::to_string(uint64_t(_max_pages) * kPageSize));
+    stats.emplace_back("evictions", std::to_string(_stats.evictions));
+    stats.emplace_back("compact_pages", std::to_string(_pages.size()));
+    stats.emplace_back("compact_metadata_bytes",
+                       std::to_string(_stats.items * sizeof(item) + _buckets.size() * sizeof(uint32_t)));
+}
+
+} // namespace Backend
+} // namespace Afina
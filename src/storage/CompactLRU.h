@@ -0,0 +1,177 @@
+#ifndef AFINA_STORAGE_COMPACT_LRU_H
+#define AFINA_STORAGE_COMPACT_LRU_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <afina/Hash.h>
+#include <afina/Storage.h>
+
+#include "ChunkLRU.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # LRU cache with 32-bit links
+ * Items live in chunks carved out of fixed size pages, every link - LRU neighbours, index chain, index
+ * buckets and free lists - is a 32-bit reference to the chunk: page number and offset inside the page in
+ * 8 byte units. Item takes 48 bytes of metadata in front of key and value and one 4 byte index bucket
+ * per a few items, no per item heap allocations at all.
+ *
+ * Pages are split into chunks by size classes the way memcached does: each class has its own free list
+ * and LRU list. Page is given to a class as a whole, once all pages are in use class evicts its least
+ * recently used items. Class without items of its own takes page away from the class having most of
+ * them, evicting everything on that page.
+ *
+ * Soft TTL and leases are not supported. Thread safe, single lock.
+ */
+class CompactLRU : public Afina::Storage, private ChunkLRU<CompactLRU, uint32_t> {
+public:
+    // Size of each page, the biggest item has to fit into one page
+    static const uint32_t kPageSize = 1024 * 1024;
+
+    /**
+     * @param max_size memory limit, rounded down to the whole number of pages but at least one page
+     */
+    CompactLRU(size_t max_size = 64 * 1024 * 1024);
+    ~CompactLRU() {}
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override { return Put(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        return PutIfAbsent(key, KeyHash::Of(key), value);
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override { return Set(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override { return Delete(key, KeyHash::Of(key)); }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) const override { return Get(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const std::string &value) override {
+        return Put(key, hash, value, ItemInfo());
+    }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value) override {
+        return PutIfAbsent(key, hash, value, ItemInfo());
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, uint64_t hash, const std::string &value) override {
+        return Set(key, hash, value, ItemInfo());
+    }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value) const override {
+        ItemInfo info;
+        return Get(key, hash, value, info);
+    }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key, uint64_t hash) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info) const override;
+
+    // Implements Afina::Storage interface
+    CasStatus CompareAndSwap(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info,
+                             uint64_t cas) override;
+
+    // Implements Afina::Storage interface
+    CounterStatus Increment(const std::string &key, uint64_t hash, uint64_t delta, bool decrement,
+                            uint64_t &result) override;
+
+    // Implements Afina::Storage interface
+    void GetStats(std::vector<std::pair<std::string, std::string>> &stats) const override;
+
+private:
+    friend class ChunkLRU<CompactLRU, uint32_t>;
+
+    struct item;
+
+    // Reference is page number in the high bits and offset in 8 byte units in the low ones, zero is "none"
+    static const uint32_t kOffsetBits = 17;
+
+    struct size_class {
+        // Size of each chunk in class
+        uint32_t size;
+
+        // Number of pages given to the class
+        uint32_t pages;
+
+        // Head of the free chunks list, linked by item::next
+        uint32_t free;
+
+        // Most and least recently used items of the class
+        uint32_t head;
+        uint32_t tail;
+    };
+
+    struct page {
+        std::unique_ptr<char[]> data;
+
+        // Class page is carved for
+        uint32_t cls;
+    };
+
+    inline item *ItemAt(uint32_t ref) const {
+        return reinterpret_cast<item *>(_pages[ref >> kOffsetBits].data.get() +
+                                        (size_t(ref & ((1 << kOffsetBits) - 1)) << 3));
+    }
+
+    // See ChunkLRU.h
+    inline size_class &ClassAt(uint32_t cls) const { return _classes[cls]; }
+    inline uint32_t ClassCount() const { return _classes.size(); }
+    inline uint32_t &Bucket(uint64_t hash) const { return _buckets[hash & (_buckets.size() - 1)]; }
+    inline chunk_stats &Stats() const { return _stats; }
+    void Fill(item *it, const ItemInfo &info) const;
+
+    // Same as Slot, but expired item is removed and the zero link is returned
+    uint32_t *Live(const std::string &key, uint64_t hash) const;
+
+    // Gives new page to the class unless memory limit is reached
+    bool Grow(uint32_t cls);
+
+    // Gives page to the class, all its chunks become free
+    void Carve(uint32_t page_no, uint32_t cls);
+
+    // Takes page away from the class having most pages, evicting its items
+    bool Steal(uint32_t cls);
+
+    const uint32_t _max_pages;
+    mutable std::vector<page> _pages;
+    mutable std::vector<size_class> _classes;
+
+    // Index: heads of bucket chains linked by item::hnext
+    mutable std::vector<uint32_t> _buckets;
+
+    mutable chunk_stats _stats;
+
+    mutable std::mutex _mt;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_COMPACT_LRU_H
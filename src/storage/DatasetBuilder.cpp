@@ -0,0 +1,168 @@
+#include "DatasetBuilder.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <unistd.h>
+
+namespace Afina {
+namespace Backend {
+
+// Average number of keys per bucket
+static const uint64_t kKeysPerBucket = 4;
+
+// Number of seeds to try before giving up
+static const uint64_t kMaxAttempts = 16;
+
+// See DatasetBuilder.h
+bool DatasetBuilder::Place(const std::vector<uint64_t> &hashes, uint64_t buckets,
+                           std::vector<uint32_t> &displacements, std::vector<uint64_t> &slots) const {
+    uint64_t count = hashes.size();
+    std::vector<std::vector<uint64_t>> members(buckets);
+    for (uint64_t i = 0; i < count; i++) {
+        members[MappedDataset::Bucket(hashes[i], buckets)].push_back(i);
+    }
+
+    // Big buckets are placed first, while there is a lot of free slots
+    std::vector<uint64_t> order(buckets);
+    for (uint64_t b = 0; b < buckets; b++) {
+        order[b] = b;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&members](uint64_t a, uint64_t b) { return members[a].size() > members[b].size(); });
+
+    // The last singletons need about count tries on average, much more means the seed is bad
+    uint64_t max_displacement = std::min<uint64_t>(UINT32_MAX, std::max<uint64_t>(1 << 20, 64 * count));
+
+    displacements.assign(buckets, 0);
+    slots.assign(count, 0);
+    std::vector<bool> taken(count, false);
+    std::vector<uint64_t> candidate;
+    for (uint64_t b : order) {
+        const std::vector<uint64_t> &keys = members[b];
+        if (keys.empty()) {
+            break;
+        }
+
+        // Keys of the same hash could never be separated
+        for (size_t i = 0; i < keys.size(); i++) {
+            for (size_t j = i + 1; j < keys.size(); j++) {
+                if (hashes[keys[i]] == hashes[keys[j]]) {
+                    return false;
+                }
+            }
+        }
+
+        uint64_t d = 0;
+        for (; d < max_displacement; d++) {
+            candidate.clear();
+            for (uint64_t key : keys) {
+                uint64_t slot = MappedDataset::Slot(hashes[key], d, count);
+                if (taken[slot] || std::find(candidate.begin(), candidate.end(), slot) != candidate.end()) {
+                    break;
+                }
+                candidate.push_back(slot);
+            }
+            if (candidate.size() == keys.size()) {
+                break;
+            }
+        }
+        if (d == max_displacement) {
+            return false;
+        }
+
+        displacements[b] = d;
+        for (size_t i = 0; i < keys.size(); i++) {
+            taken[candidate[i]] = true;
+            slots[keys[i]] = candidate[i];
+        }
+    }
+    return true;
+}
+
+// See DatasetBuilder.h
+void DatasetBuilder::Write(const std::string &path) const {
+    uint64_t count = _records.size();
+    if (count == 0) {
+        throw std::runtime_error("Dataset is empty");
+    }
+    uint64_t buckets = count / kKeysPerBucket + 1;
+
+    MappedDataset::header h;
+    std::memset(&h, 0, sizeof(h));
+    std::vector<uint64_t> hashes(count);
+    std::vector<uint32_t> displacements;
+    std::vector<uint64_t> slots;
+
+    bool placed = false;
+    for (uint64_t attempt = 0; attempt < kMaxAttempts && !placed; attempt++) {
+        h.seed_k0 = 0x6166696e61647374ULL;
+        h.seed_k1 = attempt;
+
+        uint64_t i = 0;
+        for (auto &record : _records) {
+            KeyHash hash(HashSeed{h.seed_k0, h.seed_k1});
+            hash.Update(record.first.data(), record.first.size());
+            hashes[i++] = hash.Digest();
+        }
+        placed = Place(hashes, buckets, displacements, slots);
+    }
+    if (!placed) {
+        throw std::runtime_error("Failed to build perfect hash");
+    }
+
+    // Records follow tables in the keys order, slot table points to them
+    h.magic = MappedDataset::kMagic;
+    h.version = MappedDataset::kVersion;
+    h.count = count;
+    h.buckets = buckets;
+    h.displacements = sizeof(h);
+    h.slots = (h.displacements + buckets * sizeof(uint32_t) + 7) & ~uint64_t(7);
+
+    std::vector<uint64_t> offsets(count);
+    uint64_t offset = h.slots + count * sizeof(uint64_t);
+    uint64_t i = 0;
+    for (auto &record : _records) {
+        if (record.first.size() > UINT32_MAX || record.second.size() > UINT32_MAX) {
+            throw std::runtime_error("Record is too big");
+        }
+        offsets[slots[i++]] = offset;
+        offset += MappedDataset::kRecordHead + record.first.size() + record.second.size();
+    }
+    h.size = offset;
+    h.checksum = MappedDataset::Checksum(h);
+
+    std::string tmp_path = path + ".tmp";
+    FILE *out = fopen(tmp_path.c_str(), "wb");
+    if (out == nullptr) {
+        throw std::runtime_error("Failed to open " + tmp_path + ": " + std::string(strerror(errno)));
+    }
+
+    static const char padding[8] = {0};
+    bool ok = fwrite(&h, sizeof(h), 1, out) == 1 &&
+              fwrite(displacements.data(), sizeof(uint32_t), buckets, out) == buckets &&
+              fwrite(padding, 1, h.slots - h.displacements - buckets * sizeof(uint32_t), out) ==
+                  h.slots - h.displacements - buckets * sizeof(uint32_t) &&
+              fwrite(offsets.data(), sizeof(uint64_t), count, out) == count;
+    for (auto it = _records.begin(); ok && it != _records.end(); ++it) {
+        uint32_t sizes[2] = {uint32_t(it->first.size()), uint32_t(it->second.size())};
+        ok = fwrite(sizes, sizeof(sizes), 1, out) == 1 &&
+             fwrite(it->first.data(), 1, it->first.size(), out) == it->first.size() &&
+             fwrite(it->second.data(), 1, it->second.size(), out) == it->second.size();
+    }
+    ok = ok && fflush(out) == 0 && fsync(fileno(out)) == 0;
+    int err = errno;
+    fclose(out);
+
+    if (!ok || rename(tmp_path.c_str(), path.c_str()) == -1) {
+        err = ok ? errno : err;
+        unlink(tmp_path.c_str());
+        throw std::runtime_error("Failed to write " + path + ": " + std::string(strerror(err)));
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
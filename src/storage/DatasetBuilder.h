@@ -0,0 +1,49 @@
+#ifndef AFINA_STORAGE_DATASET_BUILDER_H
+#define AFINA_STORAGE_DATASET_BUILDER_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "MappedDataset.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Offline builder of MappedDataset files
+ * Collects all the records in memory, then searches for minimal perfect hash over their keys and writes
+ * file down. Not thread safe.
+ */
+class DatasetBuilder {
+public:
+    DatasetBuilder() {}
+    ~DatasetBuilder() {}
+
+    /**
+     * Adds record to the dataset, value replaces previous one of the same key
+     */
+    void Add(const std::string &key, const std::string &value) { _records[key] = value; }
+
+    inline size_t count() const { return _records.size(); }
+
+    /**
+     * Writes dataset to the given path. File is written under temporary name and then renamed, so that
+     * server watching the path never sees it partially written. Throws std::runtime_error on failure
+     */
+    void Write(const std::string &path) const;
+
+private:
+    // Searches displacement of each bucket, so that all keys get distinct slots. Returns false if there is
+    // no such displacements for the given seed
+    bool Place(const std::vector<uint64_t> &hashes, uint64_t buckets, std::vector<uint32_t> &displacements,
+               std::vector<uint64_t> &slots) const;
+
+    std::map<std::string, std::string> _records;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_DATASET_BUILDER_H
@@ -0,0 +1,113 @@
+#include "DatasetStorage.h"
+
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+namespace Afina {
+namespace Backend {
+
+// Period between checks of dataset file, ms
+static const int kWatchPeriod = 1000;
+
+// See DatasetStorage.h
+DatasetStorage::DatasetStorage(const std::string &path)
+    : _path(path), _reloads(0), _reload_errors(0), _watching(false) {
+    if (!Stat(_loaded)) {
+        throw std::runtime_error("Failed to stat " + path + ": " + std::string(strerror(errno)));
+    }
+    _dataset = std::make_shared<const MappedDataset>(path);
+}
+
+// See DatasetStorage.h
+void DatasetStorage::Start() {
+    std::lock_guard<std::mutex> lck(_watcher_mt);
+    if (_watching) {
+        return;
+    }
+    _watching = true;
+    _watcher = std::thread(&DatasetStorage::Watcher, this);
+}
+
+// See DatasetStorage.h
+void DatasetStorage::Stop() {
+    {
+        std::lock_guard<std::mutex> lck(_watcher_mt);
+        if (!_watching) {
+            return;
+        }
+        _watching = false;
+    }
+    _watcher_cv.notify_all();
+    _watcher.join();
+}
+
+// See DatasetStorage.h
+bool DatasetStorage::Reload() {
+    std::lock_guard<std::mutex> lck(_reload_mt);
+    file_id id;
+    if (!Stat(id) || id == _loaded) {
+        return false;
+    }
+
+    // File could be replaced once again between stat and open, then the next check picks it up
+    std::shared_ptr<const MappedDataset> dataset;
+    try {
+        dataset = std::make_shared<const MappedDataset>(_path);
+    } catch (std::runtime_error &ex) {
+        // Don't try the same broken file again
+        _loaded = id;
+        _reload_errors++;
+        throw;
+    }
+
+    std::atomic_store(&_dataset, dataset);
+    _loaded = id;
+    _reloads++;
+    return true;
+}
+
+// See DatasetStorage.h
+void DatasetStorage::GetStats(std::vector<std::pair<std::string, std::string>> &stats) const {
+    std::shared_ptr<const MappedDataset> dataset = std::atomic_load(&_dataset);
+    stats.emplace_back("curr_items", std::to_string(dataset->count()));
+    stats.emplace_back("bytes", std::to_string(dataset->size()));
+    stats.emplace_back("dataset_reloads", std::to_string(_reloads.load()));
+    stats.emplace_back("dataset_reload_errors", std::to_string(_reload_errors.load()));
+}
+
+// See DatasetStorage.h
+bool DatasetStorage::Stat(file_id &id) const {
+    struct stat st;
+    if (stat(_path.c_str(), &st) == -1) {
+        return false;
+    }
+    id.dev = st.st_dev;
+    id.ino = st.st_ino;
+    id.size = st.st_size;
+    id.mtime = uint64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+// See DatasetStorage.h
+void DatasetStorage::Watcher() {
+    std::unique_lock<std::mutex> lck(_watcher_mt);
+    while (_watching) {
+        _watcher_cv.wait_for(lck, std::chrono::milliseconds(kWatchPeriod));
+        if (!_watching) {
+            break;
+        }
+
+        try {
+            Reload();
+        } catch (std::runtime_error &ex) {
+            // Counted by Reload, old dataset stays in use
+        }
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,99 @@
+#ifndef AFINA_STORAGE_DATASET_STORAGE_H
+#define AFINA_STORAGE_DATASET_STORAGE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <afina/Storage.h>
+
+#include "MappedDataset.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Read only storage serving MappedDataset
+ * All writes are rejected. Start runs background thread that checks dataset path once a second and
+ * maps new file as soon as it gets replaced (see DatasetBuilder::Write). New dataset is swapped in
+ * atomically: requests in flight finish with the old one, which is unmapped after the last of them.
+ * If new file is broken, the old one stays in use.
+ */
+class DatasetStorage : public Afina::Storage {
+public:
+    DatasetStorage(const std::string &path);
+    ~DatasetStorage() { Stop(); }
+
+    // Implements Afina::Storage interface
+    void Start() override;
+
+    // Implements Afina::Storage interface
+    void Stop() override;
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override { return false; }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override { return false; }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override { return false; }
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override { return false; }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) const override {
+        return std::atomic_load(&_dataset)->Get(key, value);
+    }
+
+    // Implements Afina::Storage interface
+    void GetStats(std::vector<std::pair<std::string, std::string>> &stats) const override;
+
+    /**
+     * Maps dataset file again if it was changed since the last load, returns true if dataset was swapped.
+     * Throws std::runtime_error if new file is broken
+     */
+    bool Reload();
+
+private:
+    // Identity of the file dataset was loaded from
+    struct file_id {
+        uint64_t dev, ino, size, mtime;
+        bool operator==(const file_id &other) const {
+            return dev == other.dev && ino == other.ino && size == other.size && mtime == other.mtime;
+        }
+    };
+
+    bool Stat(file_id &id) const;
+
+    void Watcher();
+
+    const std::string _path;
+
+    // Dataset in use, accessed by std::atomic_load/atomic_store only
+    std::shared_ptr<const MappedDataset> _dataset;
+
+    // File current dataset was mapped from, protected by _reload_mt
+    std::mutex _reload_mt;
+    file_id _loaded;
+
+    std::atomic<uint64_t> _reloads;
+    std::atomic<uint64_t> _reload_errors;
+
+    // Background watcher state
+    std::mutex _watcher_mt;
+    std::condition_variable _watcher_cv;
+    std::thread _watcher;
+    bool _watching;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_DATASET_STORAGE_H
@@ -0,0 +1,48 @@
+#include "FileLoader.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Backend {
+
+// See FileLoader.h
+bool FileLoader::Load(const std::string &key, std::string &value) {
+    if (key.empty() || key == "." || key == ".." || key.find('/') != std::string::npos) {
+        return false;
+    }
+
+    std::string path = _dir + "/" + key;
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        if (errno == ENOENT || errno == ENOTDIR) {
+            return false;
+        }
+        throw std::runtime_error("Failed to open " + path + ": " + std::string(strerror(errno)));
+    }
+
+    std::string result;
+    char buffer[4096];
+    ssize_t readed_bytes;
+    while ((readed_bytes = read(fd, buffer, sizeof(buffer))) != 0) {
+        if (readed_bytes == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            close(fd);
+            throw std::runtime_error("Failed to read " + path + ": " + std::string(strerror(errno)));
+        }
+        result.append(buffer, readed_bytes);
+    }
+    close(fd);
+
+    value.swap(result);
+    return true;
+}
+
+} // namespace Backend
+} // namespace Afina
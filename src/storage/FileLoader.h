@@ -0,0 +1,31 @@
+#ifndef AFINA_STORAGE_FILE_LOADER_H
+#define AFINA_STORAGE_FILE_LOADER_H
+
+#include <string>
+
+#include <afina/Loader.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Directory backed loader
+ * Value for key is the content of the file with the same name in the given directory. Keys that
+ * could escape directory are treated as missing
+ */
+class FileLoader : public Afina::Loader {
+public:
+    FileLoader(const std::string &dir) : _dir(dir) {}
+    ~FileLoader() {}
+
+    // Implements Afina::Loader interface
+    bool Load(const std::string &key, std::string &value) override;
+
+private:
+    const std::string _dir;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_FILE_LOADER_H
@@ -0,0 +1,25 @@
+#include <afina/Hash.h>
+
+#include <random>
+
+namespace Afina {
+
+namespace {
+
+HashSeed GenerateSeed() {
+    std::random_device rd;
+    HashSeed seed;
+    seed.k0 = (uint64_t(rd()) << 32) | rd();
+    seed.k1 = (uint64_t(rd()) << 32) | rd();
+    return seed;
+}
+
+} // namespace
+
+// See Hash.h
+const HashSeed &KeyHash::ProcessSeed() {
+    static const HashSeed seed = GenerateSeed();
+    return seed;
+}
+
+} // namespace Afina
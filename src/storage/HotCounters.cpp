@@ -0,0 +1,151 @@
+#include "HotCounters.h"
+
+#include <thread>
+
+#include <sched.h>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+// See HotCounters.h
+HotCounters::HotCounters() : _count(0) {
+    for (auto &e : _entries) {
+        e.hash.store(0);
+        e.present.store(false);
+        e.base.store(0);
+        e.expire.store(0);
+        e.ops.store(0);
+        e.applied = 0;
+        for (auto &s : e.slots) {
+            s.delta.store(0);
+            s.active.store(0);
+        }
+    }
+}
+
+// See HotCounters.h
+bool HotCounters::Add(const std::string &key, uint64_t hash, uint64_t delta, uint64_t &result, bool &fold) {
+    if (hash == 0) {
+        return false;
+    }
+
+    int cpu = sched_getcpu();
+    size_t own = size_t(cpu < 0 ? 0 : cpu) % kSlots;
+    for (auto &e : _entries) {
+        if (e.hash.load(std::memory_order_relaxed) != hash) {
+            continue;
+        }
+
+        // Pairs with Demote: either it sees the slot active and waits, or this sees entry gone. Key
+        // can't change while slot is active
+        slot &s = e.slots[own];
+        s.active.fetch_add(1);
+        if (!e.present.load() || e.hash.load() != hash || e.key != key) {
+            s.active.fetch_sub(1);
+            continue;
+        }
+
+        // Expired key is gone for good, owner demotes counter on the next locked access
+        uint64_t expire = e.expire.load(std::memory_order_relaxed);
+        if (expire != 0 && ItemInfo::Now() >= expire) {
+            s.active.fetch_sub(1);
+            return false;
+        }
+
+        s.delta.fetch_add(delta);
+        uint64_t ops = e.ops.fetch_add(1, std::memory_order_relaxed) + 1;
+        result = e.base.load(std::memory_order_relaxed) + Total(e);
+        s.active.fetch_sub(1);
+
+        fold = ops % kFoldEvery == 0;
+        return true;
+    }
+    return false;
+}
+
+// See HotCounters.h
+bool HotCounters::Promote(const std::string &key, uint64_t hash, uint64_t value, uint64_t expire) {
+    if (hash == 0) {
+        return false;
+    } else if (Find(key, hash) != nullptr) {
+        return true;
+    }
+
+    for (auto &e : _entries) {
+        if (e.hash.load() == 0) {
+            e.key = key;
+            e.base.store(value);
+            e.expire.store(expire);
+            e.ops.store(0);
+            e.applied = 0;
+            e.hash.store(hash);
+            e.present.store(true);
+            _count++;
+            return true;
+        }
+    }
+    return false;
+}
+
+// See HotCounters.h
+bool HotCounters::Fold(const std::string &key, uint64_t hash, uint64_t &delta) {
+    entry *e = Find(key, hash);
+    if (e == nullptr) {
+        return false;
+    }
+
+    uint64_t total = Total(*e);
+    delta = total - e->applied;
+    e->applied = total;
+    return true;
+}
+
+// See HotCounters.h
+bool HotCounters::Demote(const std::string &key, uint64_t hash, uint64_t &delta) {
+    entry *e = Find(key, hash);
+    if (e == nullptr) {
+        return false;
+    }
+
+    e->present.store(false);
+    for (auto &s : e->slots) {
+        while (s.active.load() != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    delta = Total(*e) - e->applied;
+    for (auto &s : e->slots) {
+        s.delta.store(0);
+    }
+    e->hash.store(0);
+    _count--;
+    return true;
+}
+
+// See HotCounters.h
+HotCounters::entry *HotCounters::Find(const std::string &key, uint64_t hash) {
+    if (hash == 0 || Empty()) {
+        return nullptr;
+    }
+    for (auto &e : _entries) {
+        if (e.hash.load() == hash && e.present.load() && e.key == key) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+// See HotCounters.h
+uint64_t HotCounters::Total(const entry &e) const {
+    uint64_t total = 0;
+    for (auto &s : e.slots) {
+        total += s.delta.load();
+    }
+    return total;
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,116 @@
+#ifndef AFINA_STORAGE_HOT_COUNTERS_H
+#define AFINA_STORAGE_HOT_COUNTERS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Per-CPU striped counters
+ * Keeps small set of counters that are incremented too often to go through the storage lock. Each one
+ * has a slot per CPU, increments are added to the slot of CPU thread runs on and the storage value
+ * isn't touched until counter gets folded: deltas not applied yet are handed to the owner, which adds
+ * them to the stored value. Owner must fold counter before reading it and demote it before overwriting
+ * or deleting the key.
+ *
+ * Only Add runs without locks, all other methods must be called under the lock owner uses to write the
+ * key, so they never race each other. Slots are never drained while counter stays hot, so reply of
+ * fast increment (value at promotion plus everything added since) never goes backwards: call that starts
+ * after another one returned gets bigger number. Concurrent calls could still get the same one.
+ * Decrements never take fast path.
+ */
+class HotCounters {
+public:
+    // Max number of hot counters
+    static const size_t kEntries = 16;
+
+    // Number of per-CPU slots each counter has
+    static const size_t kSlots = 16;
+
+    // Number of fast increments after which counter asks to be folded
+    static const uint64_t kFoldEvery = 1024;
+
+    HotCounters();
+    ~HotCounters() {}
+
+    /**
+     * Returns true if there is no hot counters at all, so that caller could skip lookups
+     */
+    inline bool Empty() const { return _count.load(std::memory_order_relaxed) == 0; }
+
+    /**
+     * Adds delta to the counter of given key without taking any locks. Returns false if counter isn't
+     * hot or has expired. Sets fold to true once counter has to be folded
+     */
+    bool Add(const std::string &key, uint64_t hash, uint64_t delta, uint64_t &result, bool &fold);
+
+    /**
+     * Makes counter hot, value is the one stored under the key, expire is time (see ItemInfo::Now) key
+     * stops to exist at or zero. Returns false if table is full
+     */
+    bool Promote(const std::string &key, uint64_t hash, uint64_t value, uint64_t expire);
+
+    /**
+     * Sets delta to the sum of increments not applied to the stored value yet and marks them as applied.
+     * Returns false if counter isn't hot
+     */
+    bool Fold(const std::string &key, uint64_t hash, uint64_t &delta);
+
+    /**
+     * Same as Fold, also makes counter regular one
+     */
+    bool Demote(const std::string &key, uint64_t hash, uint64_t &delta);
+
+private:
+    struct slot {
+        // Sum of all increments made through this slot since promotion
+        std::atomic<uint64_t> delta;
+
+        // Number of increments in progress, Demote waits them out
+        std::atomic<uint32_t> active;
+
+        // Slots of different CPUs shouldn't share cache line
+        char padding[64 - sizeof(std::atomic<uint64_t>) - sizeof(std::atomic<uint32_t>)];
+    };
+
+    struct entry {
+        // Hash of the key, zero for free entry
+        std::atomic<uint64_t> hash;
+
+        // Set once entry is ready to take increments
+        std::atomic<bool> present;
+
+        // Counter value at promotion
+        std::atomic<uint64_t> base;
+
+        // Time key expires at, zero means never
+        std::atomic<uint64_t> expire;
+
+        // Number of fast increments done
+        std::atomic<uint64_t> ops;
+
+        // Part of slots sum already added to the stored value, changed by owner only
+        uint64_t applied;
+
+        // Key counter belongs to, written only while entry is free
+        std::string key;
+
+        slot slots[kSlots];
+    };
+
+    entry *Find(const std::string &key, uint64_t hash);
+
+    // Sum of all the slots
+    uint64_t Total(const entry &e) const;
+
+    std::atomic<size_t> _count;
+    entry _entries[kEntries];
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_HOT_COUNTERS_H
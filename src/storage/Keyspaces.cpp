@@ -0,0 +1,73 @@
+#include "Keyspaces.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace Afina {
+namespace Backend {
+
+// See Keyspaces.h
+void Keyspaces::Add(const std::string &name, std::shared_ptr<Afina::Storage> storage) {
+    if (name.empty() || name.find(_delimiter) != std::string::npos) {
+        throw std::runtime_error("Invalid keyspace name: " + name);
+    }
+    for (auto &keyspace : _keyspaces) {
+        if (keyspace.first == name) {
+            throw std::runtime_error("Duplicate keyspace: " + name);
+        }
+    }
+    _keyspaces.emplace_back(name, storage);
+}
+
+// See Keyspaces.h
+void Keyspaces::Start() {
+    _fallback->Start();
+    for (auto &keyspace : _keyspaces) {
+        keyspace.second->Start();
+    }
+}
+
+// See Keyspaces.h
+void Keyspaces::Stop() {
+    for (auto &keyspace : _keyspaces) {
+        keyspace.second->Stop();
+    }
+    _fallback->Stop();
+}
+
+// See Keyspaces.h
+bool Keyspaces::InvalidateTag(uint64_t tag) {
+    bool supported = _fallback->InvalidateTag(tag);
+    for (auto &keyspace : _keyspaces) {
+        supported = keyspace.second->InvalidateTag(tag) || supported;
+    }
+    return supported;
+}
+
+// See Keyspaces.h
+void Keyspaces::GetStats(std::vector<std::pair<std::string, std::string>> &stats) const {
+    _fallback->GetStats(stats);
+    for (auto &keyspace : _keyspaces) {
+        std::vector<std::pair<std::string, std::string>> keyspace_stats;
+        keyspace.second->GetStats(keyspace_stats);
+        for (auto &stat : keyspace_stats) {
+            stats.emplace_back("keyspace:" + keyspace.first + ":" + stat.first, stat.second);
+        }
+    }
+}
+
+// See Keyspaces.h
+Afina::Storage &Keyspaces::Route(const std::string &key) const {
+    size_t end = key.find(_delimiter);
+    if (end != std::string::npos) {
+        for (auto &keyspace : _keyspaces) {
+            if (keyspace.first.size() == end && std::memcmp(keyspace.first.data(), key.data(), end) == 0) {
+                return *keyspace.second;
+            }
+        }
+    }
+    return *_fallback;
+}
+
+} // namespace Backend
+} // namespace Afina
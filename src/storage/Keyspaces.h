@@ -0,0 +1,153 @@
+#ifndef AFINA_STORAGE_KEYSPACES_H
+#define AFINA_STORAGE_KEYSPACES_H
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <afina/Hash.h>
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Named keyspaces
+ * Routes each key to the storage of its keyspace, selected by key prefix: key "<name><delimiter>..."
+ * belongs to keyspace <name>, keys without known prefix go to the default storage. Keys are stored
+ * as is, prefix included.
+ *
+ * Each keyspace has its own storage with its own memory limit and eviction, so that load of one tenant
+ * never evicts items of others. Stats of keyspaces are reported as "keyspace:<name>:<stat>" after the
+ * stats of default storage.
+ *
+ * Keyspaces have to be added before Start, then routing table is read only
+ */
+class Keyspaces : public Afina::Storage {
+public:
+    Keyspaces(std::shared_ptr<Afina::Storage> fallback, char delimiter = ':')
+        : _fallback(fallback), _delimiter(delimiter) {}
+    ~Keyspaces() {}
+
+    /**
+     * Adds keyspace served by the given storage. Throws std::runtime_error if name is invalid or taken
+     */
+    void Add(const std::string &name, std::shared_ptr<Afina::Storage> storage);
+
+    // Implements Afina::Storage interface
+    void Start() override;
+
+    // Implements Afina::Storage interface
+    void Stop() override;
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override { return Put(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        return PutIfAbsent(key, KeyHash::Of(key), value);
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override { return Set(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override { return Delete(key, KeyHash::Of(key)); }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) const override { return Get(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const std::string &value) override {
+        return Route(key).Put(key, hash, value);
+    }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value) override {
+        return Route(key).PutIfAbsent(key, hash, value);
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, uint64_t hash, const std::string &value) override {
+        return Route(key).Set(key, hash, value);
+    }
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key, uint64_t hash) override { return Route(key).Delete(key, hash); }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value) const override {
+        return Route(key).Get(key, hash, value);
+    }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override {
+        return Route(key).Put(key, hash, value, info);
+    }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override {
+        return Route(key).PutIfAbsent(key, hash, value, info);
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override {
+        return Route(key).Set(key, hash, value, info);
+    }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info) const override {
+        return Route(key).Get(key, hash, value, info);
+    }
+
+    // Implements Afina::Storage interface
+    CounterStatus Increment(const std::string &key, uint64_t hash, uint64_t delta, bool decrement,
+                            uint64_t &result) override {
+        return Route(key).Increment(key, hash, delta, decrement, result);
+    }
+
+    // Implements Afina::Storage interface
+    CasStatus CompareAndSwap(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info,
+                             uint64_t cas) override {
+        return Route(key).CompareAndSwap(key, hash, value, info, cas);
+    }
+
+    // Implements Afina::Storage interface
+    bool AppendValue(const std::string &key, uint64_t hash, std::string &out, bool versioned) const override {
+        return Route(key).AppendValue(key, hash, out, versioned);
+    }
+
+    // Implements Afina::Storage interface
+    LeaseStatus GetLeased(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info,
+                          uint64_t &token) override {
+        return Route(key).GetLeased(key, hash, value, info, token);
+    }
+
+    // Implements Afina::Storage interface
+    bool PutLeased(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info,
+                   uint64_t token) override {
+        return Route(key).PutLeased(key, hash, value, info, token);
+    }
+
+    // Implements Afina::Storage interface, tag is invalidated in every keyspace
+    bool InvalidateTag(uint64_t tag) override;
+
+    // Implements Afina::Storage interface
+    void GetStats(std::vector<std::pair<std::string, std::string>> &stats) const override;
+
+private:
+    // Returns storage of the keyspace key belongs to
+    Afina::Storage &Route(const std::string &key) const;
+
+    std::shared_ptr<Afina::Storage> _fallback;
+    const char _delimiter;
+
+    // Keyspaces by name. There are a few of them, so linear scan beats hashing the prefix
+    std::vector<std::pair<std::string, std::shared_ptr<Afina::Storage>>> _keyspaces;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_KEYSPACES_H
@@ -0,0 +1,138 @@
+#include "LeaseTable.h"
+
+#include <random>
+
+namespace Afina {
+namespace Backend {
+
+// How many operations could pass between expired entries purge
+static const uint32_t kPurgePeriod = 1024;
+
+// See LeaseTable.h
+LeaseTable::LeaseTable(uint32_t lease_ms, uint32_t stale_ms)
+    : _lease_ms(lease_ms), _stale_ms(stale_ms), _epoch(clock::now()), _ops(0) {
+    std::random_device rd;
+    _next_token = (uint64_t(rd()) << 32) | rd();
+}
+
+// See LeaseTable.h
+LeaseTable::Status LeaseTable::Acquire(const key_ref &key, uint64_t &token, std::string &value, uint32_t &flags) {
+    uint64_t now = Now();
+    MaybePurge(now);
+
+    auto it = Find(_leases, key);
+    if (it != _leases.end() && it->second.expire_ms > now) {
+        auto st = Find(_stale, key);
+        if (st != _stale.end() && st->second.expire_ms > now) {
+            value = st->second.value;
+            flags = st->second.flags;
+            return Status::kStale;
+        }
+        return Status::kHotMiss;
+    }
+
+    // Zero token is never granted, so it could be used as "no lease"
+    if (++_next_token == 0) {
+        ++_next_token;
+    }
+    token = _next_token;
+
+    if (it == _leases.end()) {
+        it = _leases.emplace(key.hash, lease());
+        it->second.key.assign(key.data, key.size);
+    }
+    it->second.token = token;
+    it->second.expire_ms = now + _lease_ms;
+    return Status::kGranted;
+}
+
+// See LeaseTable.h
+bool LeaseTable::Release(const key_ref &key, uint64_t token) {
+    auto it = Find(_leases, key);
+    if (it == _leases.end()) {
+        return false;
+    }
+
+    bool valid = it->second.token == token && it->second.expire_ms > Now();
+    if (valid) {
+        _leases.erase(it);
+        auto st = Find(_stale, key);
+        if (st != _stale.end()) {
+            _stale.erase(st);
+        }
+    }
+    return valid;
+}
+
+// See LeaseTable.h
+void LeaseTable::Revoke(const key_ref &key) {
+    if (!_leases.empty()) {
+        auto it = Find(_leases, key);
+        if (it != _leases.end()) {
+            _leases.erase(it);
+        }
+    }
+    if (!_stale.empty()) {
+        auto st = Find(_stale, key);
+        if (st != _stale.end()) {
+            _stale.erase(st);
+        }
+    }
+}
+
+// See LeaseTable.h
+void LeaseTable::Retire(const key_ref &key, const std::string &value, uint32_t flags) {
+    if (!_leases.empty()) {
+        auto it = Find(_leases, key);
+        if (it != _leases.end()) {
+            _leases.erase(it);
+        }
+    }
+    if (_stale_ms == 0) {
+        return;
+    }
+
+    uint64_t now = Now();
+    MaybePurge(now);
+
+    auto st = Find(_stale, key);
+    if (st == _stale.end()) {
+        st = _stale.emplace(key.hash, stale_value());
+        st->second.key.assign(key.data, key.size);
+    }
+    st->second.value = value;
+    st->second.flags = flags;
+    st->second.expire_ms = now + _stale_ms;
+}
+
+// See LeaseTable.h
+uint64_t LeaseTable::Now() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - _epoch).count();
+}
+
+// See LeaseTable.h
+void LeaseTable::MaybePurge(uint64_t now) {
+    if (++_ops < kPurgePeriod) {
+        return;
+    }
+    _ops = 0;
+
+    for (auto it = _leases.begin(); it != _leases.end();) {
+        if (it->second.expire_ms <= now) {
+            it = _leases.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto it = _stale.begin(); it != _stale.end();) {
+        if (it->second.expire_ms <= now) {
+            it = _stale.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,129 @@
+#ifndef AFINA_STORAGE_LEASE_TABLE_H
+#define AFINA_STORAGE_LEASE_TABLE_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Leases on missed keys
+ * The first client missed a key gets a lease token, which is the only permission to set the key back.
+ * Until lease expires the rest of clients are told to back off, and get the value key had before delete
+ * if there is one. Any regular write or delete of the key revokes its lease, so that client holding an
+ * old token can't overwrite data fresher than it has loaded.
+ *
+ * Entries are indexed by key hash and keep the key itself, so that keys with the same hash never see each
+ * other's leases or values. Both leases and stale values expire automatically: lazily on access and by
+ * periodic purge.
+ *
+ * That is NOT thread safe implementaiton!!
+ */
+class LeaseTable {
+public:
+    LeaseTable(uint32_t lease_ms = 1000, uint32_t stale_ms = 1000);
+    ~LeaseTable() {}
+
+    // Key and its hash, points to the caller's memory
+    using key_ref = struct key_ref {
+        template <typename String>
+        key_ref(const String &_key, uint64_t _hash) : data(_key.data()), size(_key.size()), hash(_hash) {}
+        const char *data;
+        std::size_t size;
+        uint64_t hash;
+    };
+
+    enum class Status {
+        // New lease granted to the caller
+        kGranted,
+
+        // Somebody else holds the lease, no stale value known
+        kHotMiss,
+
+        // Somebody else holds the lease, stale value returned
+        kStale
+    };
+
+    /**
+     * Called on cache miss: grant lease if there is no active one. In case if caller got kGranted then
+     * token is filled, if kStale then value and its flags are filled
+     */
+    Status Acquire(const key_ref &key, uint64_t &token, std::string &value, uint32_t &flags);
+
+    /**
+     * Checks that token is the active lease on the key and releases it. Returns true if caller is allowed
+     * to store value
+     */
+    bool Release(const key_ref &key, uint64_t token);
+
+    /**
+     * Key gets written by the regular command, lease and stale value are not valid anymore
+     */
+    void Revoke(const key_ref &key);
+
+    /**
+     * Key gets deleted, its value is kept to serve clients waiting on the lease
+     */
+    void Retire(const key_ref &key, const std::string &value, uint32_t flags);
+
+    /**
+     * Number of active leases and stale values
+     */
+    std::size_t Leases() const { return _leases.size(); }
+    std::size_t StaleValues() const { return _stale.size(); }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    // Milliseconds since table creation
+    uint64_t Now() const;
+
+    // Drop all expired entries every once in a while
+    void MaybePurge(uint64_t now);
+
+    using lease = struct lease {
+        std::string key;
+        uint64_t token;
+        uint64_t expire_ms;
+    };
+
+    using stale_value = struct stale_value {
+        std::string key;
+        std::string value;
+        uint32_t flags;
+        uint64_t expire_ms;
+    };
+
+    // Entry of the given key, table.end() if there is no one
+    template <typename Table> static typename Table::iterator Find(Table &table, const key_ref &key) {
+        auto range = table.equal_range(key.hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.key.size() == key.size && std::memcmp(it->second.key.data(), key.data, key.size) == 0) {
+                return it;
+            }
+        }
+        return table.end();
+    }
+
+    const uint32_t _lease_ms;
+    const uint32_t _stale_ms;
+    const clock::time_point _epoch;
+
+    // Token for the next lease, starts from random value so tokens are not predictable between restarts
+    uint64_t _next_token;
+
+    // Number of operations since last purge
+    uint32_t _ops;
+
+    std::unordered_multimap<uint64_t, lease> _leases;
+    std::unordered_multimap<uint64_t, stale_value> _stale;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_LEASE_TABLE_H
@@ -0,0 +1,107 @@
+#include "MappedDataset.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Backend {
+
+// "AFINAMPH" in little-endian
+const uint64_t MappedDataset::kMagic = 0x48504d414e494641ULL;
+
+// Must be changed on any format change
+const uint64_t MappedDataset::kVersion = 1;
+
+// See MappedDataset.h
+uint64_t MappedDataset::Checksum(const header &h) {
+    KeyHash hash(HashSeed{0, 0});
+    hash.Update(reinterpret_cast<const char *>(&h), offsetof(header, checksum));
+    return hash.Digest();
+}
+
+// See MappedDataset.h
+MappedDataset::MappedDataset(const std::string &path) : _base(nullptr), _size(0) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        throw std::runtime_error("Failed to open " + path + ": " + std::string(strerror(errno)));
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        int err = errno;
+        close(fd);
+        throw std::runtime_error("Failed to stat " + path + ": " + std::string(strerror(err)));
+    }
+    _size = st.st_size;
+    if (_size < sizeof(header)) {
+        close(fd);
+        throw std::runtime_error("Dataset " + path + " is truncated");
+    }
+
+    // Mapping stays valid after descriptor is closed
+    void *base = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+    int err = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("Failed to map " + path + ": " + std::string(strerror(err)));
+    }
+    _base = static_cast<const char *>(base);
+
+    header h;
+    std::memcpy(&h, _base, sizeof(h));
+    bool valid = h.magic == kMagic && h.version == kVersion && h.checksum == Checksum(h) && h.size == _size &&
+                 h.count > 0 && h.buckets > 0 && h.displacements >= sizeof(header) &&
+                 h.displacements + h.buckets * sizeof(uint32_t) <= h.slots &&
+                 h.slots + h.count * sizeof(uint64_t) <= _size;
+    if (!valid) {
+        munmap(const_cast<char *>(_base), _size);
+        throw std::runtime_error("Dataset " + path + " is broken");
+    }
+
+    _count = h.count;
+    _buckets = h.buckets;
+    _seed = HashSeed{h.seed_k0, h.seed_k1};
+    _displacements = _base + h.displacements;
+    _slots = _base + h.slots;
+
+    madvise(const_cast<char *>(_base), _size, MADV_RANDOM);
+}
+
+// See MappedDataset.h
+MappedDataset::~MappedDataset() { munmap(const_cast<char *>(_base), _size); }
+
+// See MappedDataset.h
+bool MappedDataset::Get(const std::string &key, std::string &value) const {
+    KeyHash key_hash(_seed);
+    key_hash.Update(key.data(), key.size());
+    uint64_t hash = key_hash.Digest();
+
+    uint32_t displacement;
+    std::memcpy(&displacement, _displacements + Bucket(hash, _buckets) * sizeof(uint32_t), sizeof(displacement));
+
+    uint64_t offset;
+    std::memcpy(&offset, _slots + Slot(hash, displacement, _count) * sizeof(uint64_t), sizeof(offset));
+    if (offset + kRecordHead > _size) {
+        return false;
+    }
+
+    uint32_t sizes[2];
+    std::memcpy(sizes, _base + offset, sizeof(sizes));
+    const char *data = _base + offset + kRecordHead;
+    if (offset + kRecordHead + sizes[0] + sizes[1] > _size || sizes[0] != key.size() ||
+        std::memcmp(data, key.data(), key.size()) != 0) {
+        return false;
+    }
+
+    value.assign(data + sizes[0], sizes[1]);
+    return true;
+}
+
+} // namespace Backend
+} // namespace Afina
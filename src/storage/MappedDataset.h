@@ -0,0 +1,108 @@
+#ifndef AFINA_STORAGE_MAPPED_DATASET_H
+#define AFINA_STORAGE_MAPPED_DATASET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <afina/Hash.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Read only key/value file mapped into memory
+ * File is made by DatasetBuilder and consists of:
+ * - header
+ * - displacements table: uint32_t per bucket
+ * - slots table: uint64_t offset of record per key
+ * - records: uint32_t key size, uint32_t value size, key bytes, value bytes
+ *
+ * Key gets its slot by the minimal perfect hash (hash and displace): key hash selects bucket, and
+ * bucket's displacement selects slot, such that every key of the dataset has its own slot and there
+ * are no empty ones. Unknown key also lands into some slot, so record key is compared on lookup.
+ *
+ * Lookup touches displacement, slot and record only, so data is served straight from page cache
+ * without any heap structures. Instance is immutable and could be used from any number of threads.
+ */
+class MappedDataset {
+public:
+    /**
+     * Maps file and validates its structure, throws std::runtime_error if file is broken
+     */
+    MappedDataset(const std::string &path);
+    ~MappedDataset();
+
+    MappedDataset(const MappedDataset &) = delete;
+    MappedDataset &operator=(const MappedDataset &) = delete;
+
+    /**
+     * Finds value of the key, returns false if key is not in dataset
+     */
+    bool Get(const std::string &key, std::string &value) const;
+
+    inline uint64_t count() const { return _count; }
+    inline size_t size() const { return _size; }
+
+    // File layout, shared with DatasetBuilder
+    struct header {
+        uint64_t magic;
+        uint64_t version;
+
+        // Size of the whole file
+        uint64_t size;
+
+        // Number of keys, which is the number of slots as well
+        uint64_t count;
+
+        // Seed of key hashes
+        uint64_t seed_k0;
+        uint64_t seed_k1;
+
+        // Number of buckets and offsets of tables
+        uint64_t buckets;
+        uint64_t displacements;
+        uint64_t slots;
+
+        // Checksum of all fields above
+        uint64_t checksum;
+    };
+
+    static const uint64_t kMagic;
+    static const uint64_t kVersion;
+
+    // Size of record head: key and value sizes
+    static const uint64_t kRecordHead = 2 * sizeof(uint32_t);
+
+    // Bucket of the key hash
+    static inline uint64_t Bucket(uint64_t hash, uint64_t buckets) { return (hash >> 32) % buckets; }
+
+    // Slot of the key hash given bucket's displacement
+    static inline uint64_t Slot(uint64_t hash, uint32_t displacement, uint64_t count) {
+        uint64_t x = hash + displacement * 0x9e3779b97f4a7c15ULL;
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x % count;
+    }
+
+    // Checksum of the header fields
+    static uint64_t Checksum(const header &h);
+
+private:
+    const char *_base;
+    size_t _size;
+
+    uint64_t _count;
+    uint64_t _buckets;
+    HashSeed _seed;
+    const char *_displacements;
+    const char *_slots;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_MAPPED_DATASET_H
@@ -0,0 +1,166 @@
+#include "MissRatioCurve.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Afina {
+namespace Backend {
+
+// Returns histogram bucket of the distance: ceil(log2(distance))
+static inline size_t Bucket(uint64_t distance, size_t buckets) {
+    if (distance <= 1) {
+        return 0;
+    }
+    return std::min<size_t>(64 - __builtin_clzll(distance - 1), buckets - 1);
+}
+
+// See MissRatioCurve.h
+MissRatioCurve::MissRatioCurve(double rate, size_t max_tracked)
+    : _max_tracked(max_tracked), _tree(2 * max_tracked + 2, 0), _now(0), _cold(0), _references(0) {
+    if (!(rate > 0 && rate <= 1) || max_tracked == 0) {
+        throw std::runtime_error("Invalid miss ratio curve sampling configuration");
+    }
+    _threshold.store(std::max<uint64_t>(1, uint64_t(rate * kScale)));
+    std::fill(_histogram, _histogram + kBuckets, 0.0);
+}
+
+// See MissRatioCurve.h
+void MissRatioCurve::Reference(uint64_t hash, uint64_t size) {
+    std::lock_guard<std::mutex> lck(_mt);
+    if (!Sampled(hash)) {
+        // Threshold got lowered after caller checked the key
+        return;
+    }
+
+    double rate = double(_threshold.load()) / kScale;
+    int64_t distance = Touch(hash, size);
+    if (distance < 0) {
+        _cold += 1 / rate;
+    } else {
+        _histogram[Bucket(uint64_t(distance / rate), kBuckets)] += 1 / rate;
+    }
+    _references++;
+    Shrink();
+}
+
+// See MissRatioCurve.h
+void MissRatioCurve::Update(uint64_t hash, uint64_t size) {
+    std::lock_guard<std::mutex> lck(_mt);
+    if (!Sampled(hash)) {
+        return;
+    }
+    Touch(hash, size);
+    Shrink();
+}
+
+// See MissRatioCurve.h
+void MissRatioCurve::Remove(uint64_t hash) {
+    std::lock_guard<std::mutex> lck(_mt);
+    auto it = _keys.find(hash);
+    if (it != _keys.end()) {
+        TreeAdd(it->second.time, -int64_t(it->second.size));
+        _keys.erase(it);
+    }
+}
+
+// See MissRatioCurve.h
+uint64_t MissRatioCurve::Curve(std::vector<std::pair<uint64_t, double>> &curve) const {
+    std::lock_guard<std::mutex> lck(_mt);
+    double total = _cold;
+    size_t first = kBuckets, last = 0;
+    for (size_t b = 0; b < kBuckets; b++) {
+        total += _histogram[b];
+        if (_histogram[b] > 0) {
+            first = std::min(first, b);
+            last = b;
+        }
+    }
+
+    double hits = 0;
+    for (size_t b = 0; b < kBuckets && first < kBuckets; b++) {
+        hits += _histogram[b];
+        if (b >= first && b <= last) {
+            curve.emplace_back(uint64_t(1) << b, hits / total);
+        }
+    }
+    return _references;
+}
+
+// See MissRatioCurve.h
+int64_t MissRatioCurve::Touch(uint64_t hash, uint64_t size) {
+    if (_now + 1 >= _tree.size()) {
+        Compact();
+    }
+
+    auto it = _keys.find(hash);
+    int64_t distance = -1;
+    if (it != _keys.end()) {
+        if (size == 0) {
+            size = it->second.size;
+        }
+        distance = TreeSum(_now) - TreeSum(it->second.time) + int64_t(size);
+        TreeAdd(it->second.time, -int64_t(it->second.size));
+    } else {
+        it = _keys.emplace(hash, tracked{0, 0}).first;
+    }
+
+    it->second.time = ++_now;
+    it->second.size = size;
+    TreeAdd(_now, int64_t(size));
+    return distance;
+}
+
+// See MissRatioCurve.h
+void MissRatioCurve::TreeAdd(uint64_t time, int64_t delta) {
+    for (; time < _tree.size(); time += time & (~time + 1)) {
+        _tree[time] += delta;
+    }
+}
+
+// See MissRatioCurve.h
+int64_t MissRatioCurve::TreeSum(uint64_t time) const {
+    int64_t sum = 0;
+    for (; time > 0; time -= time & (~time + 1)) {
+        sum += _tree[time];
+    }
+    return sum;
+}
+
+// See MissRatioCurve.h
+void MissRatioCurve::Compact() {
+    std::vector<std::pair<uint64_t, tracked *>> order;
+    order.reserve(_keys.size());
+    for (auto &key : _keys) {
+        order.emplace_back(key.second.time, &key.second);
+    }
+    std::sort(order.begin(), order.end(),
+              [](const std::pair<uint64_t, tracked *> &a, const std::pair<uint64_t, tracked *> &b) {
+                  return a.first < b.first;
+              });
+
+    std::fill(_tree.begin(), _tree.end(), 0);
+    _now = 0;
+    for (auto &entry : order) {
+        entry.second->time = ++_now;
+        TreeAdd(_now, int64_t(entry.second->size));
+    }
+}
+
+// See MissRatioCurve.h
+void MissRatioCurve::Shrink() {
+    while (_keys.size() > _max_tracked && _threshold.load() > 1) {
+        uint64_t threshold = _threshold.load() / 2;
+        _threshold.store(threshold);
+        for (auto it = _keys.begin(); it != _keys.end();) {
+            if (SampleValue(it->first) >= threshold) {
+                TreeAdd(it->second.time, -int64_t(it->second.size));
+                it = _keys.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
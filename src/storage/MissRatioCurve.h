@@ -0,0 +1,115 @@
+#ifndef AFINA_STORAGE_MISS_RATIO_CURVE_H
+#define AFINA_STORAGE_MISS_RATIO_CURVE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Online miss ratio curve estimation
+ * SHARDS-style sampler: only keys whose hash falls below the threshold are tracked, so that keeping
+ * exact LRU stack of them is cheap. For each sampled reference byte reuse distance is computed - total
+ * size of distinct sampled items touched since the previous reference of the same key, scaled by the
+ * sampling rate - and counted into log2 histogram. Cache of N bytes hits reference iff its distance is
+ * below N, so histogram prefix sums give hit ratio for any cache size.
+ *
+ * Not sampled keys cost a single comparison. Number of tracked keys is bounded: once it is exceeded
+ * threshold is lowered and keys above it are dropped.
+ *
+ * Thread safe, lock is taken for sampled keys only
+ */
+class MissRatioCurve {
+public:
+    // Sampling rate is threshold / kScale
+    static const uint64_t kScale = 1 << 24;
+
+    /**
+     * @param rate initial fraction of keys to sample, (0, 1]
+     * @param max_tracked bound on number of tracked keys
+     */
+    MissRatioCurve(double rate = 0.001, size_t max_tracked = 1 << 16);
+    ~MissRatioCurve() {}
+
+    /**
+     * Returns true if key of the given hash is sampled
+     */
+    inline bool Sampled(uint64_t hash) const {
+        return SampleValue(hash) < _threshold.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Counts read of the sampled key. Size is the item size, or zero if it isn't known (miss)
+     */
+    void Reference(uint64_t hash, uint64_t size);
+
+    /**
+     * Moves sampled key to the top of the stack without counting reference, as write does
+     */
+    void Update(uint64_t hash, uint64_t size);
+
+    /**
+     * Removes sampled key from the stack
+     */
+    void Remove(uint64_t hash);
+
+    /**
+     * Fills estimated hit ratio for cache sizes of 2^k bytes, from the smallest size some reference
+     * would hit at up to the size all non cold references hit at. Returns number of sampled references
+     */
+    uint64_t Curve(std::vector<std::pair<uint64_t, double>> &curve) const;
+
+    /**
+     * Current sampling rate
+     */
+    inline double rate() const { return double(_threshold.load(std::memory_order_relaxed)) / kScale; }
+
+private:
+    // Number of histogram buckets, bucket k counts distances in (2^(k-1), 2^k]
+    static const size_t kBuckets = 64;
+
+    struct tracked {
+        // Position of the last reference in the stack time
+        uint64_t time;
+        uint64_t size;
+    };
+
+    static inline uint64_t SampleValue(uint64_t hash) { return (hash >> 8) & (kScale - 1); }
+
+    // Places key on top of the stack, returns bytes of distinct keys touched since its previous access
+    // or -1 if it wasn't tracked
+    int64_t Touch(uint64_t hash, uint64_t size);
+
+    // Fenwick tree over stack time holding sizes of keys last referenced at that time
+    void TreeAdd(uint64_t time, int64_t delta);
+    int64_t TreeSum(uint64_t time) const;
+
+    // Renumbers stack times of tracked keys from 1, once time reaches tree capacity
+    void Compact();
+
+    // Lowers threshold until number of tracked keys fits into the bound
+    void Shrink();
+
+    std::atomic<uint64_t> _threshold;
+    const size_t _max_tracked;
+
+    mutable std::mutex _mt;
+    std::unordered_map<uint64_t, tracked> _keys;
+    std::vector<int64_t> _tree;
+    uint64_t _now;
+
+    // Histogram of references, each weighted by 1/rate at the moment it was counted
+    double _histogram[kBuckets];
+    double _cold;
+    uint64_t _references;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_MISS_RATIO_CURVE_H
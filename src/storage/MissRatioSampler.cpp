@@ -0,0 +1,26 @@
+#include "MissRatioSampler.h"
+
+#include <cstdio>
+
+namespace Afina {
+namespace Backend {
+
+// See MissRatioSampler.h
+void MissRatioSampler::GetStats(std::vector<std::pair<std::string, std::string>> &stats) const {
+    _backend->GetStats(stats);
+
+    std::vector<std::pair<uint64_t, double>> curve;
+    uint64_t references = _curve.Curve(curve);
+
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.6f", _curve.rate());
+    stats.emplace_back("mrc_sample_rate", buf);
+    stats.emplace_back("mrc_references", std::to_string(references));
+    for (auto &point : curve) {
+        snprintf(buf, sizeof(buf), "%.4f", point.second);
+        stats.emplace_back("mrc_hit_ratio:" + std::to_string(point.first), buf);
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,172 @@
+#ifndef AFINA_STORAGE_MISS_RATIO_SAMPLER_H
+#define AFINA_STORAGE_MISS_RATIO_SAMPLER_H
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <afina/Hash.h>
+#include <afina/Storage.h>
+
+#include "MissRatioCurve.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Storage that estimates its own miss ratio curve
+ * Wraps another storage and feeds sampled accesses into MissRatioCurve: reads are references, writes
+ * only move key to the top of LRU stack. Stats of wrapped storage are followed by:
+ * - mrc_sample_rate: current fraction of keys sampled
+ * - mrc_references: number of sampled references
+ * - mrc_hit_ratio:<bytes>: estimated hit ratio of LRU cache of that many bytes
+ *
+ * Thread safe as long as wrapped storage is
+ */
+class MissRatioSampler : public Afina::Storage {
+public:
+    MissRatioSampler(std::shared_ptr<Afina::Storage> backend, double rate = 0.001)
+        : _backend(backend), _curve(rate) {}
+    ~MissRatioSampler() {}
+
+    void Start() override { _backend->Start(); }
+    void Stop() override { _backend->Stop(); }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override { return Put(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        return PutIfAbsent(key, KeyHash::Of(key), value);
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override { return Set(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override { return Delete(key, KeyHash::Of(key)); }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) const override { return Get(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const std::string &value) override {
+        return Put(key, hash, value, ItemInfo());
+    }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value) override {
+        return PutIfAbsent(key, hash, value, ItemInfo());
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, uint64_t hash, const std::string &value) override {
+        return Set(key, hash, value, ItemInfo());
+    }
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key, uint64_t hash) override {
+        if (_curve.Sampled(hash)) {
+            _curve.Remove(hash);
+        }
+        return _backend->Delete(key, hash);
+    }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value) const override {
+        ItemInfo info;
+        return Get(key, hash, value, info);
+    }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override {
+        return Written(key, hash, value, _backend->Put(key, hash, value, info));
+    }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override {
+        return Written(key, hash, value, _backend->PutIfAbsent(key, hash, value, info));
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override {
+        return Written(key, hash, value, _backend->Set(key, hash, value, info));
+    }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info) const override {
+        bool found = _backend->Get(key, hash, value, info);
+        if (_curve.Sampled(hash)) {
+            _curve.Reference(hash, found ? key.size() + value.size() : 0);
+        }
+        return found;
+    }
+
+    // Implements Afina::Storage interface
+    CounterStatus Increment(const std::string &key, uint64_t hash, uint64_t delta, bool decrement,
+                            uint64_t &result) override {
+        CounterStatus status = _backend->Increment(key, hash, delta, decrement, result);
+        if (status == CounterStatus::kOk && _curve.Sampled(hash)) {
+            _curve.Update(hash, key.size() + std::to_string(result).size());
+        }
+        return status;
+    }
+
+    // Implements Afina::Storage interface
+    CasStatus CompareAndSwap(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info,
+                             uint64_t cas) override {
+        CasStatus status = _backend->CompareAndSwap(key, hash, value, info, cas);
+        Written(key, hash, value, status == CasStatus::kStored);
+        return status;
+    }
+
+    // Implements Afina::Storage interface, value size is what the block has between header and trailing \r\n
+    bool AppendValue(const std::string &key, uint64_t hash, std::string &out, bool versioned) const override {
+        size_t before = out.size();
+        bool found = _backend->AppendValue(key, hash, out, versioned);
+        if (_curve.Sampled(hash)) {
+            _curve.Reference(hash, found ? key.size() + out.size() - out.find("\r\n", before) - 4 : 0);
+        }
+        return found;
+    }
+
+    // Implements Afina::Storage interface
+    LeaseStatus GetLeased(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info,
+                          uint64_t &token) override {
+        LeaseStatus status = _backend->GetLeased(key, hash, value, info, token);
+        if (_curve.Sampled(hash)) {
+            _curve.Reference(hash, status == LeaseStatus::kHit ? key.size() + value.size() : 0);
+        }
+        return status;
+    }
+
+    // Implements Afina::Storage interface
+    bool PutLeased(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info,
+                   uint64_t token) override {
+        return Written(key, hash, value, _backend->PutLeased(key, hash, value, info, token));
+    }
+
+    // Implements Afina::Storage interface
+    bool InvalidateTag(uint64_t tag) override { return _backend->InvalidateTag(tag); }
+
+    // Implements Afina::Storage interface
+    void GetStats(std::vector<std::pair<std::string, std::string>> &stats) const override;
+
+private:
+    // Moves written key to the top of the stack, passes through result of the write
+    inline bool Written(const std::string &key, uint64_t hash, const std::string &value, bool stored) {
+        if (stored && _curve.Sampled(hash)) {
+            _curve.Update(hash, key.size() + value.size());
+        }
+        return stored;
+    }
+
+    std::shared_ptr<Afina::Storage> _backend;
+    mutable MissRatioCurve _curve;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_MISS_RATIO_SAMPLER_H
@@ -0,0 +1,116 @@
+#include "ProcessLoader.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+namespace Afina {
+namespace Backend {
+
+// See ProcessLoader.h
+bool ProcessLoader::Load(const std::string &key, std::string &value) {
+    int pipe_fd[2];
+    if (pipe2(pipe_fd, O_CLOEXEC) == -1) {
+        throw std::runtime_error("Failed to create pipe: " + std::string(strerror(errno)));
+    }
+
+    // Child gets pipe as stdout, key is passed as argument so no shell is involved
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, pipe_fd[1], STDOUT_FILENO);
+
+    std::string program = _program, argument = key;
+    char *argv[] = {&program[0], &argument[0], nullptr};
+
+    pid_t pid;
+    int err = posix_spawnp(&pid, program.c_str(), &actions, nullptr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(pipe_fd[1]);
+    if (err != 0) {
+        close(pipe_fd[0]);
+        throw std::runtime_error("Failed to run " + _program + ": " + std::string(strerror(err)));
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + _timeout;
+    bool timed_out = false;
+
+    std::string result;
+    char buffer[4096];
+    while (true) {
+        auto remains =
+            std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remains.count() <= 0) {
+            timed_out = true;
+            break;
+        }
+
+        struct pollfd pfd = {pipe_fd[0], POLLIN, 0};
+        int ready = poll(&pfd, 1, int(remains.count()));
+        if (ready == -1 && errno == EINTR) {
+            continue;
+        } else if (ready == -1) {
+            break;
+        } else if (ready == 0) {
+            timed_out = true;
+            break;
+        }
+
+        ssize_t readed_bytes = read(pipe_fd[0], buffer, sizeof(buffer));
+        if (readed_bytes == -1 && errno == EINTR) {
+            continue;
+        } else if (readed_bytes <= 0) {
+            break;
+        }
+        result.append(buffer, readed_bytes);
+    }
+    close(pipe_fd[0]);
+
+    // Program could close stdout and still hang, so exit is waited for until the same deadline. Hung program
+    // would block every client waiting for this key, it gets no second chance
+    int status;
+    while (true) {
+        if (timed_out) {
+            kill(pid, SIGKILL);
+        }
+
+        pid_t done = waitpid(pid, &status, timed_out ? 0 : WNOHANG);
+        if (done == pid) {
+            break;
+        } else if (done == -1 && errno != EINTR) {
+            throw std::runtime_error("Failed to wait for " + _program + ": " + std::string(strerror(errno)));
+        } else if (done == 0) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                timed_out = true;
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    if (timed_out) {
+        throw std::runtime_error("Loader " + _program + " timed out for key " + key);
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) > 1) {
+        throw std::runtime_error("Loader " + _program + " failed for key " + key);
+    } else if (WEXITSTATUS(status) == 1) {
+        return false;
+    }
+
+    value.swap(result);
+    return true;
+}
+
+} // namespace Backend
+} // namespace Afina
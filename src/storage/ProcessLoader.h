@@ -0,0 +1,35 @@
+#ifndef AFINA_STORAGE_PROCESS_LOADER_H
+#define AFINA_STORAGE_PROCESS_LOADER_H
+
+#include <chrono>
+#include <string>
+
+#include <afina/Loader.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # External program loader
+ * Runs given program with key as the only argument for each load. Program must write value to stdout
+ * and exit with code 0 if key is found, code 1 means there is no such key, anything else is an error.
+ * Program that doesn't finish within timeout is killed and load fails
+ */
+class ProcessLoader : public Afina::Loader {
+public:
+    ProcessLoader(const std::string &program, std::chrono::milliseconds timeout = std::chrono::seconds(5))
+        : _program(program), _timeout(timeout) {}
+    ~ProcessLoader() {}
+
+    // Implements Afina::Loader interface
+    bool Load(const std::string &key, std::string &value) override;
+
+private:
+    const std::string _program;
+    const std::chrono::milliseconds _timeout;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_PROCESS_LOADER_H
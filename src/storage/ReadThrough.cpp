@@ -0,0 +1,141 @@
+#include "ReadThrough.h"
+
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+
+namespace Afina {
+namespace Backend {
+
+// See ReadThrough.h
+bool ReadThrough::Get(const std::string &key, uint64_t hash, std::string &value) const {
+    if (_backend->Get(key, hash, value)) {
+        return true;
+    }
+
+    std::shared_ptr<pending_load> pending;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto it = Find(key, hash);
+        if (it != _pending.end()) {
+            // Somebody is loading the same key already, wait for result
+            pending = it->second;
+            _coalesced++;
+            if (!pending->ready.wait_for(lock, _load_timeout, [&pending] { return pending->done; })) {
+                _load_timeouts++;
+                return false;
+            }
+            if (pending->found) {
+                value = pending->value;
+            }
+            return pending->found;
+        }
+
+        pending = std::make_shared<pending_load>(key);
+        _pending.emplace(hash, pending);
+        _n_pending++;
+    }
+
+    pending_guard guard(*this, hash, pending);
+
+    // Value could be loaded by somebody else between cache miss above and registration
+    std::string loaded;
+    bool found = _backend->Get(key, hash, loaded) || Load(key, hash, loaded, *pending);
+    if (found) {
+        pending->value = loaded;
+        pending->found = true;
+        value.swap(loaded);
+    }
+    return found;
+}
+
+// See ReadThrough.h
+bool ReadThrough::Load(const std::string &key, uint64_t hash, std::string &value, const pending_load &pending) const {
+    auto start = std::chrono::steady_clock::now();
+
+    bool found = false;
+    try {
+        found = _loader->Load(key, value);
+    } catch (...) {
+        _load_errors++;
+    }
+
+    uint64_t elapsed =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    _loads++;
+    _load_time_us += elapsed;
+    uint64_t max = _load_time_max_us.load();
+    while (elapsed > max && !_load_time_max_us.compare_exchange_weak(max, elapsed)) {
+    }
+
+    if (!found) {
+        _load_misses++;
+        return false;
+    }
+
+    // Writers cancel the load before they touch the key, so checking the flag and caching value must be
+    // atomic with respect to Cancel. Client could also set fresh value before load has started, it must win
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!pending.cancelled) {
+        _backend->PutIfAbsent(key, hash, value);
+    }
+    return true;
+}
+
+// See ReadThrough.h
+ReadThrough::pending_guard::~pending_guard() {
+    {
+        std::lock_guard<std::mutex> lock(_owner._mutex);
+        _pending->done = true;
+        _owner._pending.erase(_owner.Find(_pending->key, _hash));
+        _owner._n_pending--;
+    }
+    _pending->ready.notify_all();
+}
+
+// See ReadThrough.h
+void ReadThrough::Cancel(const std::string &key, uint64_t hash) const {
+    // Load registered after this check sees the write once it re-reads backend
+    if (_n_pending.load() == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = Find(key, hash);
+    if (it != _pending.end()) {
+        it->second->cancelled = true;
+    }
+}
+
+// See ReadThrough.h
+std::unordered_multimap<uint64_t, std::shared_ptr<ReadThrough::pending_load>>::iterator
+ReadThrough::Find(const std::string &key, uint64_t hash) const {
+    auto range = _pending.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second->key == key) {
+            return it;
+        }
+    }
+    return _pending.end();
+}
+
+// See ReadThrough.h
+void ReadThrough::GetStats(std::vector<std::pair<std::string, std::string>> &stats) const {
+    _backend->GetStats(stats);
+
+    uint64_t loads = _loads.load(), coalesced = _coalesced.load();
+    char ratio[32];
+    std::snprintf(ratio, sizeof(ratio), "%.4f", loads + coalesced > 0 ? double(coalesced) / (loads + coalesced) : 0.0);
+
+    stats.emplace_back("loader_loads", std::to_string(loads));
+    stats.emplace_back("loader_misses", std::to_string(_load_misses.load()));
+    stats.emplace_back("loader_errors", std::to_string(_load_errors.load()));
+    stats.emplace_back("loader_coalesced", std::to_string(coalesced));
+    stats.emplace_back("loader_wait_timeouts", std::to_string(_load_timeouts.load()));
+    stats.emplace_back("loader_coalescing_ratio", ratio);
+    stats.emplace_back("loader_latency_avg_us", std::to_string(loads > 0 ? _load_time_us.load() / loads : 0));
+    stats.emplace_back("loader_latency_max_us", std::to_string(_load_time_max_us.load()));
+}
+
+} // namespace Backend
+} // namespace Afina
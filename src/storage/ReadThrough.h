@@ -0,0 +1,209 @@
+#ifndef AFINA_STORAGE_READ_THROUGH_H
+#define AFINA_STORAGE_READ_THROUGH_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <afina/Hash.h>
+#include <afina/Loader.h>
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Read-through cache
+ * Wraps another storage and asks loader for the value on each Get miss, loaded value gets cached in
+ * the wrapped storage. Concurrent misses on the same key are coalesced: only the first one calls
+ * loader, the rest wait for its result, but no longer than load timeout. Write to the key that is being loaded
+ * cancels caching of the load result, so that loaded value never overwrites newer one or resurrects deleted key.
+ *
+ * Thread safe as long as wrapped storage is
+ */
+class ReadThrough : public Afina::Storage {
+public:
+    ReadThrough(std::shared_ptr<Afina::Storage> backend, std::shared_ptr<Afina::Loader> loader,
+                std::chrono::milliseconds load_timeout = std::chrono::seconds(5))
+        : _backend(backend), _loader(loader), _load_timeout(load_timeout), _n_pending(0), _loads(0),
+          _load_misses(0), _load_errors(0), _coalesced(0), _load_timeouts(0), _load_time_us(0),
+          _load_time_max_us(0) {}
+    ~ReadThrough() {}
+
+    void Start() override { _backend->Start(); }
+    void Stop() override { _backend->Stop(); }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override { return Put(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        return PutIfAbsent(key, KeyHash::Of(key), value);
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override { return Set(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override { return Delete(key, KeyHash::Of(key)); }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) const override { return Get(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const std::string &value) override {
+        Cancel(key, hash);
+        return _backend->Put(key, hash, value);
+    }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value) override {
+        return _backend->PutIfAbsent(key, hash, value);
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, uint64_t hash, const std::string &value) override {
+        Cancel(key, hash);
+        return _backend->Set(key, hash, value);
+    }
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key, uint64_t hash) override {
+        Cancel(key, hash);
+        return _backend->Delete(key, hash);
+    }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value) const override;
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override {
+        Cancel(key, hash);
+        return _backend->Put(key, hash, value, info);
+    }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override {
+        return _backend->PutIfAbsent(key, hash, value, info);
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override {
+        Cancel(key, hash);
+        return _backend->Set(key, hash, value, info);
+    }
+
+    // Implements Afina::Storage interface, loaded items have default attributes
+    bool Get(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info) const override {
+        if (_backend->Get(key, hash, value, info)) {
+            return true;
+        }
+        info = ItemInfo();
+        return Get(key, hash, value);
+    }
+
+    // Implements Afina::Storage interface
+    CounterStatus Increment(const std::string &key, uint64_t hash, uint64_t delta, bool decrement,
+                            uint64_t &result) override {
+        return _backend->Increment(key, hash, delta, decrement, result);
+    }
+
+    // Implements Afina::Storage interface, missed key is loaded by Get
+    bool AppendValue(const std::string &key, uint64_t hash, std::string &out, bool versioned) const override {
+        return _backend->AppendValue(key, hash, out, versioned) || Storage::AppendValue(key, hash, out, versioned);
+    }
+
+    // Implements Afina::Storage interface
+    CasStatus CompareAndSwap(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info,
+                             uint64_t cas) override {
+        return _backend->CompareAndSwap(key, hash, value, info, cas);
+    }
+
+    // Implements Afina::Storage interface
+    LeaseStatus GetLeased(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info,
+                          uint64_t &token) override {
+        return _backend->GetLeased(key, hash, value, info, token);
+    }
+
+    // Implements Afina::Storage interface
+    bool PutLeased(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info,
+                   uint64_t token) override {
+        Cancel(key, hash);
+        return _backend->PutLeased(key, hash, value, info, token);
+    }
+
+    // Implements Afina::Storage interface
+    bool InvalidateTag(uint64_t tag) override { return _backend->InvalidateTag(tag); }
+
+    // Implements Afina::Storage interface
+    void GetStats(std::vector<std::pair<std::string, std::string>> &stats) const override;
+
+private:
+    // Load in progress, waiters are sleeping on the condition until owner fills result
+    struct pending_load {
+        pending_load(const std::string &_key) : key(_key), done(false), found(false), cancelled(false) {}
+        const std::string key;
+        bool done;
+        bool found;
+        // Key was written during load, result must not be cached
+        bool cancelled;
+        std::string value;
+        std::condition_variable ready;
+    };
+
+    // Marks load done and drops it from _pending once owner leaves Get, even by exception, so that the key
+    // is never left with a load nobody finishes. Result must be filled in before, waiters read it only once done
+    class pending_guard {
+    public:
+        pending_guard(const ReadThrough &owner, uint64_t hash, std::shared_ptr<pending_load> pending)
+            : _owner(owner), _hash(hash), _pending(pending) {}
+        ~pending_guard();
+
+    private:
+        const ReadThrough &_owner;
+        const uint64_t _hash;
+        std::shared_ptr<pending_load> _pending;
+    };
+
+    // Calls loader and caches result unless load gets cancelled, returns true if key was found
+    bool Load(const std::string &key, uint64_t hash, std::string &value, const pending_load &pending) const;
+
+    // Must be called before write to the key, so that concurrent load doesn't overwrite the written value
+    void Cancel(const std::string &key, uint64_t hash) const;
+
+    // Load of the given key in progress or end, must be called under _mutex
+    std::unordered_multimap<uint64_t, std::shared_ptr<pending_load>>::iterator Find(const std::string &key,
+                                                                                    uint64_t hash) const;
+
+    std::shared_ptr<Afina::Storage> _backend;
+    std::shared_ptr<Afina::Loader> _loader;
+
+    // How long waiters could wait for the load started by somebody else
+    const std::chrono::milliseconds _load_timeout;
+
+    // Loads in progress by key hash, keys with the same hash are told apart by pending_load::key.
+    // Protected by _mutex
+    mutable std::mutex _mutex;
+    mutable std::unordered_multimap<uint64_t, std::shared_ptr<pending_load>> _pending;
+
+    // Number of loads in progress, writers don't touch _mutex while it is zero
+    mutable std::atomic<size_t> _n_pending;
+
+    // Statistics
+    mutable std::atomic<uint64_t> _loads;
+    mutable std::atomic<uint64_t> _load_misses;
+    mutable std::atomic<uint64_t> _load_errors;
+    mutable std::atomic<uint64_t> _coalesced;
+    mutable std::atomic<uint64_t> _load_timeouts;
+    mutable std::atomic<uint64_t> _load_time_us;
+    mutable std::atomic<uint64_t> _load_time_max_us;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_READ_THROUGH_H
@@ -0,0 +1,518 @@
+#include "SharedLRU.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Backend {
+
+// "AFINASHM" in little-endian
+static const uint64_t kMagic = 0x4d48534e49464141ULL;
+
+// Must be changed on any layout change
+static const uint64_t kVersion = 3;
+
+// Maximum number of size classes
+static const uint32_t kMaxClasses = 64;
+
+// Smallest and largest chunks, each next class is about 1.25 times bigger than the previous one
+static const uint64_t kMinChunk = 128;
+static const uint64_t kMaxChunk = 1024 * 1024;
+
+// Index gets one bucket per this many bytes of segment
+static const uint64_t kBytesPerBucket = 512;
+
+static inline uint64_t Align(uint64_t value, uint64_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+// Fills chunk sizes of all classes, returns number of classes
+static uint32_t ClassSizes(uint64_t sizes[kMaxClasses]) {
+    uint32_t n = 0;
+    for (uint64_t chunk = kMinChunk; chunk < kMaxChunk && n < kMaxClasses - 1; chunk = Align(chunk * 5 / 4, 8)) {
+        sizes[n++] = chunk;
+    }
+    sizes[n++] = kMaxChunk;
+    return n;
+}
+
+// Size class state
+struct SharedLRU::shm_class {
+    // Size of each chunk in class
+    uint64_t size;
+
+    // Head of the list of free chunks, linked by shm_item::next
+    uint64_t free;
+
+    // Most and least recently used items of the class
+    uint64_t head;
+    uint64_t tail;
+};
+
+// Segment starts with header, followed by index buckets and then by chunks. All offsets are from the
+// segment start, zero means "none"
+struct SharedLRU::shm_header {
+    uint64_t magic;
+    uint64_t version;
+    uint64_t size;
+
+    // Seed of key hashes in index
+    uint64_t seed_k0;
+    uint64_t seed_k1;
+
+    // Index is an array of bucket_count offsets of chain heads
+    uint64_t bucket_count;
+    uint64_t buckets;
+
+    // Chunks are carved out of [data, size) sequentially, top is the first never used byte
+    uint64_t data;
+    uint64_t top;
+
+    uint64_t classes_count;
+    shm_class classes[kMaxClasses];
+
+    // Statistics and the last version given to an item
+    chunk_stats stats;
+
+    // Set on clean shutdown, along with checksum of all the fields above
+    uint64_t clean;
+    uint64_t checksum;
+};
+
+// Chunk header, key and value bytes follow it
+struct SharedLRU::shm_item {
+    // Next item in the bucket chain
+    uint64_t hnext;
+
+    // Neighbours in class LRU list, next is also used to link free chunks
+    uint64_t prev;
+    uint64_t next;
+
+    // Index hash of the key
+    uint64_t hash;
+
+    // See ItemInfo
+    uint64_t expire;
+    uint64_t soft_expire;
+
+    // See ItemInfo
+    uint64_t cas;
+
+    uint32_t key_size;
+    uint32_t value_size;
+
+    // See ItemInfo
+    uint32_t flags;
+    uint32_t reserved;
+
+    // Size class chunk belongs to, set once chunk is carved out
+    uint32_t cls;
+
+    // Set once item is completely written, reset before it gets removed
+    uint32_t live;
+
+    inline char *data() { return reinterpret_cast<char *>(this + 1); }
+    inline bool Expired(uint64_t now) const { return expire != 0 && now >= expire; }
+};
+
+// See SharedLRU.h
+SharedLRU::SharedLRU(const std::string &path, size_t size)
+    : _fd(-1), _size(size), _base(nullptr), _header(nullptr), _attach(Attach::kCreated),
+      _recovered(0) {
+    uint64_t bucket_count, buckets, data;
+    Layout(size, bucket_count, buckets, data);
+    if (data + kMaxChunk > size) {
+        throw std::runtime_error("Shared segment is too small");
+    }
+
+    auto fail = [this, &path](const std::string &what) {
+        int err = errno;
+        if (_base != nullptr) {
+            munmap(_base, _size);
+        }
+        close(_fd);
+        throw std::runtime_error(what + " " + path + ": " + std::string(strerror(err)));
+    };
+
+    _fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (_fd == -1) {
+        throw std::runtime_error("Failed to open " + path + ": " + std::string(strerror(errno)));
+    }
+    if (flock(_fd, LOCK_EX | LOCK_NB) == -1) {
+        fail("Failed to lock");
+    }
+
+    struct stat st;
+    if (fstat(_fd, &st) == -1) {
+        fail("Failed to stat");
+    }
+    bool fresh = uint64_t(st.st_size) != size;
+    if (fresh && ftruncate(_fd, size) == -1) {
+        fail("Failed to resize");
+    }
+
+    void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if (base == MAP_FAILED) {
+        fail("Failed to map");
+    }
+    _base = static_cast<char *>(base);
+    _header = At<shm_header>(0);
+
+    if (fresh || !Compatible()) {
+        Format();
+        _attach = Attach::kCreated;
+    } else if (_header->clean == 1 && _header->checksum == Checksum()) {
+        _attach = Attach::kClean;
+    } else {
+        Recover();
+        _attach = Attach::kRecovered;
+    }
+
+    const HashSeed &seed = KeyHash::ProcessSeed();
+    if (seed.k0 != _header->seed_k0 || seed.k1 != _header->seed_k1) {
+        Reindex();
+    }
+}
+
+// See SharedLRU.h
+SharedLRU::~SharedLRU() {
+    Stop();
+    munmap(_base, _size);
+    close(_fd);
+}
+
+// See SharedLRU.h
+void SharedLRU::Stop() {
+    std::lock_guard<std::mutex> lck(_mt);
+    if (_header->clean == 1) {
+        return;
+    }
+    _header->clean = 1;
+    _header->checksum = Checksum();
+    msync(_base, _size, MS_ASYNC);
+}
+
+// See SharedLRU.h
+void SharedLRU::Layout(uint64_t size, uint64_t &bucket_count, uint64_t &buckets, uint64_t &data) {
+    bucket_count = 64;
+    while (bucket_count * kBytesPerBucket < size) {
+        bucket_count <<= 1;
+    }
+    buckets = Align(sizeof(shm_header), 64);
+    data = Align(buckets + bucket_count * sizeof(uint64_t), 64);
+}
+
+// See SharedLRU.h
+void SharedLRU::Format() {
+    std::memset(_header, 0, sizeof(shm_header));
+    _header->version = kVersion;
+    _header->size = _size;
+
+    const HashSeed &seed = KeyHash::ProcessSeed();
+    _header->seed_k0 = seed.k0;
+    _header->seed_k1 = seed.k1;
+
+    Layout(_size, _header->bucket_count, _header->buckets, _header->data);
+    _header->top = _header->data;
+    std::memset(At<char>(_header->buckets), 0, _header->bucket_count * sizeof(uint64_t));
+
+    uint64_t sizes[kMaxClasses];
+    _header->classes_count = ClassSizes(sizes);
+    for (uint32_t i = 0; i < _header->classes_count; i++) {
+        _header->classes[i].size = sizes[i];
+    }
+
+    // Segment half-formatted by crashed process must not be accepted
+    std::atomic_signal_fence(std::memory_order_release);
+    _header->magic = kMagic;
+}
+
+// See SharedLRU.h
+bool SharedLRU::Compatible() const {
+    if (_header->magic != kMagic || _header->version != kVersion || _header->size != _size) {
+        return false;
+    }
+
+    uint64_t bucket_count, buckets, data;
+    Layout(_size, bucket_count, buckets, data);
+    if (_header->bucket_count != bucket_count || _header->buckets != buckets || _header->data != data ||
+        _header->top < data || _header->top > _size) {
+        return false;
+    }
+
+    uint64_t sizes[kMaxClasses];
+    uint32_t count = ClassSizes(sizes);
+    if (_header->classes_count != count) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (_header->classes[i].size != sizes[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// See SharedLRU.h
+uint64_t SharedLRU::Checksum() const {
+    KeyHash hash(HashSeed{0, 0});
+    hash.Update(reinterpret_cast<const char *>(_header), offsetof(shm_header, checksum));
+    return hash.Digest();
+}
+
+// See SharedLRU.h
+void SharedLRU::Recover() {
+    std::memset(At<char>(_header->buckets), 0, _header->bucket_count * sizeof(uint64_t));
+    for (uint32_t i = 0; i < _header->classes_count; i++) {
+        _header->classes[i].free = _header->classes[i].head = _header->classes[i].tail = 0;
+    }
+    _header->stats.items = _header->stats.bytes = 0;
+
+    HashSeed seed{_header->seed_k0, _header->seed_k1};
+    uint64_t offset = _header->data;
+    while (offset < _header->top) {
+        shm_item *item = At<shm_item>(offset);
+        if (item->cls >= _header->classes_count || offset + _header->classes[item->cls].size > _header->top) {
+            // Chunk was being carved out when process died
+            _header->top = offset;
+            break;
+        }
+        shm_class &cls = _header->classes[item->cls];
+
+        bool valid = item->live == 1 && sizeof(shm_item) + uint64_t(item->key_size) + item->value_size <= cls.size;
+        if (valid) {
+            KeyHash hash(seed);
+            hash.Update(item->data(), item->key_size);
+            valid = hash.Digest() == item->hash;
+        }
+
+        uint64_t *slot = valid ? Slot(item->data(), item->key_size, item->hash) : nullptr;
+        if (valid && *slot == 0) {
+            item->hnext = 0;
+            *slot = offset;
+            PushFront(offset);
+            _header->stats.items++;
+            _header->stats.bytes += item->key_size + item->value_size;
+            _header->stats.cas = std::max(_header->stats.cas, item->cas);
+        } else {
+            item->live = 0;
+            item->next = cls.free;
+            cls.free = offset;
+        }
+
+        offset += cls.size;
+    }
+
+    _header->clean = 0;
+    _recovered = _header->stats.items;
+}
+
+// See SharedLRU.h
+void SharedLRU::Dirty() const {
+    if (_header->clean != 0) {
+        _header->clean = 0;
+    }
+}
+
+// See SharedLRU.h
+void SharedLRU::Reindex() {
+    // Crash in the middle leaves items with hashes of the new seed only, recovery drops the rest
+    Dirty();
+    std::atomic_signal_fence(std::memory_order_release);
+    const HashSeed &seed = KeyHash::ProcessSeed();
+    _header->seed_k0 = seed.k0;
+    _header->seed_k1 = seed.k1;
+
+    uint64_t *buckets = At<uint64_t>(_header->buckets);
+    std::memset(buckets, 0, _header->bucket_count * sizeof(uint64_t));
+    for (uint32_t i = 0; i < _header->classes_count; i++) {
+        for (uint64_t offset = _header->classes[i].head; offset != 0;) {
+            shm_item *item = At<shm_item>(offset);
+            KeyHash hash(seed);
+            hash.Update(item->data(), item->key_size);
+            item->hash = hash.Digest();
+
+            uint64_t &bucket = buckets[item->hash & (_header->bucket_count - 1)];
+            item->hnext = bucket;
+            bucket = offset;
+            offset = item->next;
+        }
+    }
+}
+
+// See SharedLRU.h
+SharedLRU::shm_class &SharedLRU::ClassAt(uint32_t cls) const { return _header->classes[cls]; }
+
+// See SharedLRU.h
+uint32_t SharedLRU::ClassCount() const { return _header->classes_count; }
+
+// See SharedLRU.h
+uint64_t &SharedLRU::Bucket(uint64_t hash) const {
+    return At<uint64_t>(_header->buckets)[hash & (_header->bucket_count - 1)];
+}
+
+// See SharedLRU.h
+chunk_stats &SharedLRU::Stats() const { return _header->stats; }
+
+// See SharedLRU.h
+void SharedLRU::Fill(shm_item *item, const ItemInfo &info) const {
+    item->expire = info.expire;
+    item->soft_expire = info.soft_expire;
+    item->flags = info.flags;
+}
+
+// See SharedLRU.h
+bool SharedLRU::Grow(uint32_t cls) {
+    shm_class &c = _header->classes[cls];
+    if (_header->top + c.size > _header->size) {
+        return false;
+    }
+
+    shm_item *item = At<shm_item>(_header->top);
+    item->cls = cls;
+    item->live = 0;
+    item->next = c.free;
+
+    // Recovery walk relies on chunk class to be set before chunk is below top
+    std::atomic_signal_fence(std::memory_order_release);
+    c.free = _header->top;
+    _header->top += c.size;
+    return true;
+}
+
+// See SharedLRU.h
+bool SharedLRU::Put(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) {
+    std::lock_guard<std::mutex> lck(_mt);
+    Dirty();
+    return Store(key, hash, value, info);
+}
+
+// See SharedLRU.h
+bool SharedLRU::PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) {
+    std::lock_guard<std::mutex> lck(_mt);
+    Dirty();
+    uint64_t *slot = Slot(key.data(), key.size(), hash);
+    if (*slot != 0 && !At<shm_item>(*slot)->Expired(ItemInfo::Now())) {
+        return false;
+    }
+    return Store(key, hash, value, info);
+}
+
+// See SharedLRU.h
+bool SharedLRU::Set(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) {
+    std::lock_guard<std::mutex> lck(_mt);
+    Dirty();
+    uint64_t *slot = Slot(key.data(), key.size(), hash);
+    if (*slot == 0 || At<shm_item>(*slot)->Expired(ItemInfo::Now())) {
+        return false;
+    }
+    return Store(key, hash, value, info);
+}
+
+// See SharedLRU.h
+bool SharedLRU::Delete(const std::string &key, uint64_t hash) {
+    std::lock_guard<std::mutex> lck(_mt);
+    Dirty();
+    uint64_t *slot = Slot(key.data(), key.size(), hash);
+    if (*slot == 0) {
+        return false;
+    }
+
+    bool expired = At<shm_item>(*slot)->Expired(ItemInfo::Now());
+    Remove(slot);
+    return !expired;
+}
+
+// See SharedLRU.h
+bool SharedLRU::Get(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info) const {
+    std::lock_guard<std::mutex> lck(_mt);
+    Dirty();
+    uint64_t *slot = Slot(key.data(), key.size(), hash);
+    if (*slot == 0) {
+        return false;
+    }
+
+    uint64_t offset = *slot;
+    shm_item *item = At<shm_item>(offset);
+    if (item->Expired(ItemInfo::Now())) {
+        Remove(slot);
+        return false;
+    }
+
+    value.assign(item->data() + item->key_size, item->value_size);
+    info.expire = item->expire;
+    info.soft_expire = item->soft_expire;
+    info.flags = item->flags;
+    info.cas = item->cas;
+
+    Unlink(offset);
+    PushFront(offset);
+    return true;
+}
+
+// See SharedLRU.h
+Storage::CounterStatus SharedLRU::Increment(const std::string &key, uint64_t hash, uint64_t delta, bool decrement,
+                                            uint64_t &result) {
+    std::lock_guard<std::mutex> lck(_mt);
+    Dirty();
+    uint64_t *slot = Slot(key.data(), key.size(), hash);
+    if (*slot == 0 || At<shm_item>(*slot)->Expired(ItemInfo::Now())) {
+        return CounterStatus::kNotFound;
+    }
+
+    shm_item *item = At<shm_item>(*slot);
+    uint64_t counter;
+    if (!ParseCounter(std::string(item->data() + item->key_size, item->value_size), counter)) {
+        return CounterStatus::kNotNumber;
+    }
+    result = ApplyDelta(counter, delta, decrement);
+
+    ItemInfo info;
+    info.expire = item->expire;
+    info.soft_expire = item->soft_expire;
+    info.flags = item->flags;
+    return Store(key, hash, std::to_string(result), info) ? CounterStatus::kOk : CounterStatus::kNotStored;
+}
+
+// See SharedLRU.h
+Storage::CasStatus SharedLRU::CompareAndSwap(const std::string &key, uint64_t hash, const std::string &value,
+                                             const ItemInfo &info, uint64_t cas) {
+    std::lock_guard<std::mutex> lck(_mt);
+    Dirty();
+    uint64_t *slot = Slot(key.data(), key.size(), hash);
+    if (*slot == 0 || At<shm_item>(*slot)->Expired(ItemInfo::Now())) {
+        return CasStatus::kNotFound;
+    } else if (At<shm_item>(*slot)->cas != cas) {
+        return CasStatus::kExists;
+    }
+    return Store(key, hash, value, info) ? CasStatus::kStored : CasStatus::kNotStored;
+}
+
+// See SharedLRU.h
+void SharedLRU::GetStats(std::vector<std::pair<std::string, std::string>> &stats) const {
+    std::lock_guard<std::mutex> lck(_mt);
+    stats.emplace_back("curr_items", std::to_string(_header->stats.items));
+    stats.emplace_back("bytes", std::to_string(_header->stats.bytes));
+    stats.emplace_back("limit_maxbytes", std::to_string(_size));
+    stats.emplace_back("evictions", std::to_string(_header->stats.evictions));
+
+    const char *attach = "created";
+    if (_attach == Attach::kClean) {
+        attach = "clean";
+    } else if (_attach == Attach::kRecovered) {
+        attach = "recovered";
+    }
+    stats.emplace_back("shm_attach", attach);
+    stats.emplace_back("shm_recovered_items", std::to_string(_recovered));
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,195 @@
+#ifndef AFINA_STORAGE_SHARED_LRU_H
+#define AFINA_STORAGE_SHARED_LRU_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <afina/Hash.h>
+#include <afina/Storage.h>
+
+#include "ChunkLRU.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # LRU cache living in the memory mapped file
+ * Whole state - header, index and items - is kept in a single file mapped into memory, e.g. in /dev/shm,
+ * all links inside are offsets from the mapping start. Restarted process maps the same file again and
+ * continues with the data previous one left instead of warming cache up from scratch.
+ *
+ * Memory is splitted by size classes the way memcached does: each item takes a chunk of the smallest
+ * class it fits into, each class has its own free list and LRU list, so eviction always frees a chunk
+ * of the right size.
+ *
+ * On clean shutdown (Stop or destruction) header gets checksum and "clean" mark, which is dropped by the
+ * first modification after the attach. Segment found without valid mark is recovered by the walk over
+ * all chunks: index and lists are rebuilt from the items those are completely written. Index of the segment
+ * made by another process is rebuilt once on attach, because key hashes are seeded per process.
+ *
+ * Thread safe, one process at a time could use a segment.
+ */
+class SharedLRU : public Afina::Storage, private ChunkLRU<SharedLRU, uint64_t> {
+public:
+    /**
+     * Maps segment at the given path creating or formatting it if necessary
+     *
+     * @param path file to keep data in
+     * @param size total size of the segment, including index
+     */
+    SharedLRU(const std::string &path, size_t size = 64 * 1024 * 1024);
+    ~SharedLRU();
+
+    // Implements Afina::Storage interface
+    void Start() override {}
+
+    // Implements Afina::Storage interface, marks segment clean
+    void Stop() override;
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override { return Put(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        return PutIfAbsent(key, KeyHash::Of(key), value);
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override { return Set(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override { return Delete(key, KeyHash::Of(key)); }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) const override { return Get(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const std::string &value) override {
+        return Put(key, hash, value, ItemInfo());
+    }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value) override {
+        return PutIfAbsent(key, hash, value, ItemInfo());
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, uint64_t hash, const std::string &value) override {
+        return Set(key, hash, value, ItemInfo());
+    }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value) const override {
+        ItemInfo info;
+        return Get(key, hash, value, info);
+    }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key, uint64_t hash) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info) const override;
+
+    // Implements Afina::Storage interface
+    CasStatus CompareAndSwap(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info,
+                             uint64_t cas) override;
+
+    // Implements Afina::Storage interface
+    CounterStatus Increment(const std::string &key, uint64_t hash, uint64_t delta, bool decrement,
+                            uint64_t &result) override;
+
+    // Implements Afina::Storage interface
+    void GetStats(std::vector<std::pair<std::string, std::string>> &stats) const override;
+
+    /**
+     * How segment was attached
+     */
+    enum class Attach {
+        // New or incompatible segment was formatted
+        kCreated,
+
+        // Segment was closed cleanly, used as is
+        kClean,
+
+        // Segment was not closed cleanly, index was rebuilt
+        kRecovered
+    };
+
+    inline Attach attach() const { return _attach; }
+
+private:
+    friend class ChunkLRU<SharedLRU, uint64_t>;
+
+    struct shm_header;
+    struct shm_class;
+    struct shm_item;
+
+    // Methods below are const as long as they don't change the mapping itself, segment content is
+    // not a part of the object state
+
+    template <typename T> inline T *At(uint64_t offset) const { return reinterpret_cast<T *>(_base + offset); }
+
+    // Offsets of index and the first chunk in segment of the given size
+    static void Layout(uint64_t size, uint64_t &bucket_count, uint64_t &buckets, uint64_t &data);
+
+    // Fills header and index of the empty segment
+    void Format();
+
+    // Checks that header describes segment of the same layout
+    bool Compatible() const;
+
+    // Checksum of the header
+    uint64_t Checksum() const;
+
+    // Rebuilds index, lists and free lists from chunks
+    void Recover();
+
+    // Drops clean mark before the first modification
+    void Dirty() const;
+
+    // Segment made by another process was indexed with its seed, rehashes keys with the process one so that
+    // hashes computed by parser could be used as is
+    void Reindex();
+
+    // See ChunkLRU.h
+    inline shm_item *ItemAt(uint64_t offset) const { return At<shm_item>(offset); }
+    shm_class &ClassAt(uint32_t cls) const;
+    uint32_t ClassCount() const;
+    uint64_t &Bucket(uint64_t hash) const;
+    chunk_stats &Stats() const;
+    void Fill(shm_item *item, const ItemInfo &info) const;
+
+    // Carves new chunk for the class out of the never used space, if there is any left
+    bool Grow(uint32_t cls);
+
+    // Segment never moves memory between classes
+    inline bool Steal(uint32_t cls) { return false; }
+
+    // Segment file and mapping
+    int _fd;
+    size_t _size;
+    char *_base;
+    shm_header *_header;
+
+    Attach _attach;
+    uint64_t _recovered;
+
+    mutable std::mutex _mt;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_SHARED_LRU_H
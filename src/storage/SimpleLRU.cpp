@@ -3,26 +3,38 @@
 namespace Afina {
 namespace Backend {
 
+// Number of index buckets swept on each insert
+static const std::size_t kSweepOnInsert = 2;
+
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Put(const std::string &key, const std::string &value) {
-    auto it = _lru_index.find(key);
+bool SimpleLRU::Put(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) {
+    _leases.Revoke({key, hash});
+    auto it = _lru_index.find(lru_key(key, hash));
     if (it == _lru_index.end()) {
         std::size_t size = key.size() + value.size();
-        CheckLRUCache(size);
-        return InsertNode(key, value);
+        if (size > _max_size) {
+            return false;
+        }
+        SimpleLRU::Sweep(kSweepOnInsert);
+        return InsertNode(key, hash, value, info);
     } else {
-        lru_node *node = &(it->second.get());
-        node->value = value;
-        return UpdateNode(node);
+        return SetNode(&(it->second.get()), value, info);
     }
 }
 
-bool SimpleLRU::InsertNode(const std::string &key, const std::string &value) {
+SimpleLRU::lru_node *SimpleLRU::Find(const std::string &key, uint64_t hash, uint64_t now) const {
+    auto it = _lru_index.find(lru_key(key, hash));
+    if (it == _lru_index.end() || Dead(&(it->second.get()), now)) {
+        return nullptr;
+    }
+    return &(it->second.get());
+}
 
-    std::size_t size = key.size() + value.size();
-    _cur_size += size;
+bool SimpleLRU::InsertNode(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) {
 
-    std::unique_ptr<lru_node> node(new lru_node(key, value, _lru_tail));
+    _cur_size += key.size();
+    std::unique_ptr<lru_node> node(new lru_node(key, hash, _lru_tail, _alloc));
+    AssignValue(node.get(), value, info);
     if (!_lru_head) {
         _lru_head = std::move(node);
         _lru_tail = _lru_head.get();
@@ -31,19 +43,16 @@ bool SimpleLRU::InsertNode(const std::string &key, const std::string &value) {
         _lru_tail = _lru_tail->next.get();
     }
 
-    _lru_index.insert(std::pair<std::reference_wrapper<const std::string>, std::reference_wrapper<lru_node>>(
-        _lru_tail->key, *_lru_tail));
+    _lru_index.insert(std::make_pair(lru_key(_lru_tail->key, hash), std::ref(*_lru_tail)));
+
+    // New node is the freshest one, caller made sure it fits alone
+    CheckLRUCache();
     return true;
 }
 
-bool SimpleLRU::CheckLRUCache(const std::size_t size) {
-    if (_cur_size + size > _max_size) {
-        while (_lru_head && (_cur_size + size > _max_size)) {
-            std::size_t node_size = _lru_head->value.size() + _lru_head->key.size();
-            _cur_size -= node_size;
-            _lru_index.erase(_lru_head->key);
-            _lru_head = std::move(_lru_head->next);
-        }
+bool SimpleLRU::CheckLRUCache() {
+    while (_lru_head && _cur_size > _max_size) {
+        RemoveNode(_lru_head.get());
     }
     return true;
 }
@@ -73,48 +82,318 @@ bool SimpleLRU::UpdateNode(lru_node *node) const {
     return true;
 }
 
-// See MapBasedGlobalLockImpl.h
-bool SimpleLRU::PutIfAbsent(const std::string &key, const std::string &value) {
-    auto it = _lru_index.find(key);
-    if (it == _lru_index.end()) {
+bool SimpleLRU::SetNode(lru_node *node, const std::string &value, const ItemInfo &info) {
+    if (node->key.size() + value.size() > _max_size) {
         return false;
+    }
+
+    // Node becomes the freshest one, so eviction below reaches it last. Even then it stops before,
+    // because node's own key and the new value fit into the cache. Value is charged before eviction, so
+    // that one already in the pool doesn't push out items for bytes it doesn't take
+    UpdateNode(node);
+    ReleaseValue(node);
+    AssignValue(node, value, info);
+    CheckLRUCache();
+    return true;
+}
+
+void SimpleLRU::AssignValue(lru_node *node, const std::string &value, const ItemInfo &info) {
+    if (_dedup_min != 0 && value.size() >= _dedup_min) {
+        bool created;
+        node->shared = _pool.Intern(value, created);
+        _cur_size += created ? value.size() : 0;
+    } else {
+        node->value.assign(value.data(), value.size());
+        _cur_size += value.size();
+    }
+
+    node->info = info;
+    node->info.cas = ++_cas;
+    node->tag_stamp = _tags ? _tags->Stamp() : 0;
+    node->header.clear();
+    RenderHeader(node->key, info.flags, value.size(), node->header);
+}
+
+void SimpleLRU::ReleaseValue(lru_node *node) {
+    if (node->shared) {
+        std::size_t size = node->shared->data.size();
+        _cur_size -= _pool.Release(node->shared) ? size : 0;
+    } else {
+        _cur_size -= node->value.size();
+        lru_string(_alloc).swap(node->value);
+    }
+}
+
+void SimpleLRU::RemoveNode(lru_node *node) {
+    if (node->hot) {
+        OnHotRemoved(std::string(node->key.data(), node->key.size()), node->hash);
+    }
+
+    _cur_size -= node->key.size();
+    ReleaseValue(node);
+    _lru_index.erase(lru_key(node->key, node->hash));
+
+    if (node->next) {
+        node->next->prev = node->prev;
     } else {
-        return InsertNode(key, value);
+        _lru_tail = node->prev;
+    }
+
+    // Node gets destroyed once its owner pointer is overwritten
+    if (node->prev) {
+        node->prev->next = std::move(node->next);
+    } else {
+        _lru_head = std::move(node->next);
     }
 }
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Set(const std::string &key, const std::string &value) {
-    auto it = _lru_index.find(key);
-    if (it == _lru_index.end()) {
+bool SimpleLRU::PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) {
+    auto it = _lru_index.find(lru_key(key, hash));
+    if (it != _lru_index.end()) {
+        // Expired item is the same as absent one
+        lru_node *node = &(it->second.get());
+        if (!Dead(node, ItemInfo::Now())) {
+            return false;
+        }
+        _leases.Revoke({key, hash});
+        return SetNode(node, value, info);
+    }
+
+    std::size_t size = key.size() + value.size();
+    if (size > _max_size) {
         return false;
     }
-    lru_node *node = &(it->second.get());
-    node->value = value;
-    return UpdateNode(node);
+    _leases.Revoke({key, hash});
+    SimpleLRU::Sweep(kSweepOnInsert);
+    return InsertNode(key, hash, value, info);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Set(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) {
+    lru_node *node = Find(key, hash, ItemInfo::Now());
+    if (node == nullptr) {
+        return false;
+    }
+    _leases.Revoke({key, hash});
+    return SetNode(node, value, info);
 }
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Delete(const std::string &key) {
-    auto it = _lru_index.find(key);
+bool SimpleLRU::Delete(const std::string &key, uint64_t hash) {
+    auto it = _lru_index.find(lru_key(key, hash));
     if (it == _lru_index.end()) {
         return false;
     }
-    _cur_size -= key.size() + it->second.get().value.size();
-    _lru_index.erase(key);
+
+    lru_node *node = &(it->second.get());
+    if (Dead(node, ItemInfo::Now())) {
+        _leases.Revoke({key, hash});
+        RemoveNode(node);
+        _expired++;
+        return false;
+    }
+
+    _leases.Retire({key, hash}, std::string(node->ValueData(), node->ValueSize()), node->info.flags);
+    RemoveNode(node);
     return true;
 }
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Get(const std::string &key, std::string &value) const {
-    auto it = _lru_index.find(key);
-    if (it == _lru_index.end()) {
+bool SimpleLRU::Get(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info) const {
+    lru_node *node = Find(key, hash, ItemInfo::Now());
+    if (node == nullptr) {
         return false;
+    }
+
+    value.assign(node->ValueData(), node->ValueSize());
+    info = node->info;
+    return UpdateNode(node);
+}
+
+// See Storage.h
+Storage::CounterStatus SimpleLRU::Increment(const std::string &key, uint64_t hash, uint64_t delta, bool decrement,
+                                            uint64_t &result) {
+    lru_node *node = Find(key, hash, ItemInfo::Now());
+    if (node == nullptr) {
+        return CounterStatus::kNotFound;
+    }
+
+    uint64_t counter;
+    if (!ParseCounter(std::string(node->ValueData(), node->ValueSize()), counter)) {
+        return CounterStatus::kNotNumber;
+    }
+    counter = ApplyDelta(counter, delta, decrement);
+
+    // Counter is derived from the old value, so invalidation that happens meanwhile has to drop it
+    _leases.Revoke({key, hash});
+
+    char digits[20];
+    std::size_t size = 0;
+    for (uint64_t rest = counter; size == 0 || rest != 0; rest /= 10) {
+        digits[sizeof(digits) - ++size] = char('0' + rest % 10);
+    }
+
+    // Value that has got longer could need eviction, it takes the regular write path
+    if (node->shared || size > node->value.size()) {
+        ItemInfo info = node->info;
+        uint64_t tag_stamp = node->tag_stamp;
+        if (!SetNode(node, std::string(digits + sizeof(digits) - size, size), info)) {
+            return CounterStatus::kNotStored;
+        }
+        node->tag_stamp = tag_stamp;
+        result = counter;
+        return CounterStatus::kOk;
+    }
+
+    // Shorter or equal digits go over the old ones, buffer keeps its capacity
+    if (size != node->value.size()) {
+        _cur_size -= node->value.size() - size;
+        node->header.clear();
+        RenderHeader(node->key, node->info.flags, size, node->header);
+    }
+    node->value.assign(digits + sizeof(digits) - size, size);
+    node->info.cas = ++_cas;
+    UpdateNode(node);
+    result = counter;
+    return CounterStatus::kOk;
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::MarkHot(const std::string &key, uint64_t hash, uint64_t &value, uint64_t &expire) {
+    lru_node *node = Find(key, hash, ItemInfo::Now());
+    if (node == nullptr || !node->info.tags.empty() ||
+        !ParseCounter(std::string(node->ValueData(), node->ValueSize()), value)) {
+        return false;
+    }
+
+    node->hot = true;
+    expire = node->info.expire;
+    return true;
+}
+
+// See Storage.h
+Storage::CasStatus SimpleLRU::CompareAndSwap(const std::string &key, uint64_t hash, const std::string &value,
+                                             const ItemInfo &info, uint64_t cas) {
+    lru_node *node = Find(key, hash, ItemInfo::Now());
+    if (node == nullptr) {
+        return CasStatus::kNotFound;
+    } else if (node->info.cas != cas) {
+        return CasStatus::kExists;
+    }
+
+    _leases.Revoke({key, hash});
+    return SetNode(node, value, info) ? CasStatus::kStored : CasStatus::kNotStored;
+}
+
+// See Storage.h
+bool SimpleLRU::AppendValue(const std::string &key, uint64_t hash, std::string &out, bool versioned) const {
+    lru_node *node = Find(key, hash, ItemInfo::Now());
+    if (node == nullptr) {
+        return false;
+    }
+
+    if (versioned) {
+        out.append(node->header.data(), node->header.size() - 2);
+        out.append(" ").append(std::to_string(node->info.cas)).append("\r\n");
     } else {
-        lru_node *node = &(it->second.get());
-        value = node->value;
-        return UpdateNode(node);
+        out.append(node->header.data(), node->header.size());
     }
+    out.append(node->ValueData(), node->ValueSize()).append("\r\n");
+    return UpdateNode(node);
 }
+
+// See Storage.h
+Storage::LeaseStatus SimpleLRU::GetLeased(const std::string &key, uint64_t hash, std::string &value,
+                                          ItemInfo &info, uint64_t &token) {
+    uint64_t now = ItemInfo::Now();
+    lru_node *node = Find(key, hash, now);
+    if (node != nullptr) {
+        UpdateNode(node);
+        value.assign(node->ValueData(), node->ValueSize());
+        info = node->info;
+        if (!node->info.SoftExpired(now)) {
+            return LeaseStatus::kHit;
+        }
+
+        // Stale while revalidate: everybody gets value, but only one is asked to refresh it
+        std::string unused;
+        uint32_t unused_flags;
+        if (_leases.Acquire({key, hash}, token, unused, unused_flags) == LeaseTable::Status::kGranted) {
+            return LeaseStatus::kRefresh;
+        }
+        return LeaseStatus::kStale;
+    }
+
+    info = ItemInfo();
+    switch (_leases.Acquire({key, hash}, token, value, info.flags)) {
+    case LeaseTable::Status::kGranted:
+        return LeaseStatus::kGranted;
+    case LeaseTable::Status::kStale:
+        return LeaseStatus::kStale;
+    default:
+        return LeaseStatus::kHotMiss;
+    }
+}
+
+// See Storage.h
+bool SimpleLRU::PutLeased(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info,
+                          uint64_t token) {
+    if (!_leases.Release({key, hash}, token)) {
+        return false;
+    }
+    return SimpleLRU::Put(key, hash, value, info);
+}
+
+// See Storage.h
+bool SimpleLRU::InvalidateTag(uint64_t tag) {
+    if (!_tags) {
+        _tags = std::make_shared<TagTable>();
+    }
+    _tags->Invalidate(tag);
+    return true;
+}
+
+// See Storage.h
+void SimpleLRU::GetStats(std::vector<std::pair<std::string, std::string>> &stats) const {
+    stats.emplace_back("curr_items", std::to_string(_lru_index.size()));
+    stats.emplace_back("bytes", std::to_string(_cur_size));
+    stats.emplace_back("limit_maxbytes", std::to_string(_max_size));
+    stats.emplace_back("expired", std::to_string(_expired));
+    stats.emplace_back("leases_active", std::to_string(_leases.Leases()));
+    stats.emplace_back("leases_stale_values", std::to_string(_leases.StaleValues()));
+    stats.emplace_back("dedup_values", std::to_string(_pool.Values()));
+    stats.emplace_back("dedup_saved_bytes", std::to_string(_pool.SavedBytes()));
+}
+
+// See SimpleLRU.h
+std::size_t SimpleLRU::Sweep(std::size_t buckets) {
+    std::size_t bucket_count = _lru_index.bucket_count();
+    if (_lru_index.empty() || bucket_count == 0) {
+        return 0;
+    }
+
+    uint64_t now = ItemInfo::Now();
+    for (std::size_t i = 0; i < buckets && i < bucket_count; i++) {
+        std::size_t bucket = _sweep_cursor++ % bucket_count;
+        for (auto it = _lru_index.begin(bucket); it != _lru_index.end(bucket); ++it) {
+            if (Dead(&(it->second.get()), now)) {
+                _sweep_found.push_back(&(it->second.get()));
+            }
+        }
+    }
+    _sweep_cursor %= bucket_count;
+
+    std::size_t removed = _sweep_found.size();
+    for (auto node : _sweep_found) {
+        _leases.Revoke({node->key, node->hash});
+        RemoveNode(node);
+    }
+    _sweep_found.clear();
+
+    _expired += removed;
+    return removed;
+}
+
 } // namespace Backend
 } // namespace Afina
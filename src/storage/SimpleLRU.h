@@ -1,23 +1,52 @@
 #ifndef AFINA_STORAGE_SIMPLE_LRU_H
 #define AFINA_STORAGE_SIMPLE_LRU_H
 
-#include <map>
+#include <cstring>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <iostream>
+#include <afina/Hash.h>
 #include <afina/Storage.h>
+#include <afina/allocator/Pooled.h>
+#include <afina/allocator/StdAllocator.h>
+
+#include "LeaseTable.h"
+#include "TagTable.h"
+#include "ValuePool.h"
 
 namespace Afina {
 namespace Backend {
 
 /**
- * # Map based implementation
+ * # Hash map based implementation
  * That is NOT thread safe implementaiton!!
+ *
+ * Expired items are never returned, memory they hold is reclaimed by Sweep, which is called a bit
+ * on each insert and could be called by the owner periodically.
+ *
+ * Optionally values starting from some size are deduplicated (see ValuePool): items with equal values
+ * share single copy, which is charged against memory limit once.
+ *
+ * Items written with tags are dropped by InvalidateTag lazily: they look absent once invalidated (see
+ * TagTable) and are reclaimed by Sweep the same way expired ones are.
+ *
+ * Keys, values and index nodes take memory from allocator_type. Making aliases below refer to
+ * Allocator::StdAllocator puts all of them into bounded arena given to the constructor.
  */
 class SimpleLRU : public Afina::Storage {
 public:
-    SimpleLRU(size_t max_size = 1024) : _max_size(max_size) {}
+    template <typename T> using allocator = std::allocator<T>;
+    using allocator_type = allocator<char>;
+    using lru_string = std::basic_string<char, std::char_traits<char>, allocator_type>;
+
+    SimpleLRU(size_t max_size = 1024, uint32_t lease_ms = 1000, uint32_t stale_ms = 1000,
+              const allocator_type &alloc = allocator_type())
+        : _max_size(max_size), _lru_tail(nullptr), _alloc(alloc), _lru_index(0, lru_key_hash(), lru_key_equal(), alloc),
+          _leases(lease_ms, stale_ms), _sweep_cursor(0), _expired(0), _cas(0), _dedup_min(0) {}
 
     ~SimpleLRU() {
         _lru_index.clear();
@@ -27,31 +56,166 @@ public:
     }
 
     // Implements Afina::Storage interface
-    bool Put(const std::string &key, const std::string &value) override;
+    bool Put(const std::string &key, const std::string &value) override { return Put(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        return PutIfAbsent(key, KeyHash::Of(key), value);
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override { return Set(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override { return Delete(key, KeyHash::Of(key)); }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) const override { return Get(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const std::string &value) override {
+        return Put(key, hash, value, ItemInfo());
+    }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value) override {
+        return PutIfAbsent(key, hash, value, ItemInfo());
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, uint64_t hash, const std::string &value) override {
+        return Set(key, hash, value, ItemInfo());
+    }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value) const override {
+        ItemInfo info;
+        return Get(key, hash, value, info);
+    }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key, uint64_t hash) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info) const override;
+
+    // Implements Afina::Storage interface, value is updated in place unless it gets longer
+    CounterStatus Increment(const std::string &key, uint64_t hash, uint64_t delta, bool decrement,
+                            uint64_t &result) override;
+
+    // Implements Afina::Storage interface
+    CasStatus CompareAndSwap(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info,
+                             uint64_t cas) override;
+
+    // Implements Afina::Storage interface, header of the block is rendered on write
+    bool AppendValue(const std::string &key, uint64_t hash, std::string &out, bool versioned) const override;
 
     // Implements Afina::Storage interface
-    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+    LeaseStatus GetLeased(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info,
+                          uint64_t &token) override;
 
     // Implements Afina::Storage interface
-    bool Set(const std::string &key, const std::string &value) override;
+    bool PutLeased(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info,
+                   uint64_t token) override;
 
     // Implements Afina::Storage interface
-    bool Delete(const std::string &key) override;
+    bool InvalidateTag(uint64_t tag) override;
 
     // Implements Afina::Storage interface
-    bool Get(const std::string &key, std::string &value) const override;
+    void GetStats(std::vector<std::pair<std::string, std::string>> &stats) const override;
+
+    /**
+     * Makes storage use given tag generations, so that a few storages could be invalidated at once. By
+     * default storage creates its own table on the first InvalidateTag
+     */
+    void ShareTags(std::shared_ptr<TagTable> tags) { _tags = tags; }
+
+    /**
+     * Turns on deduplication of values at least min_size bytes long, zero turns it off. Affects values
+     * written after the call
+     */
+    void Deduplicate(std::size_t min_size) { _dedup_min = min_size; }
+
+    /**
+     * Removes expired and invalidated items from the next few buckets of the index, returns number of removed items.
+     * Each call continues from the bucket previous one stopped at
+     *
+     * @param buckets number of index buckets to check
+     */
+    virtual std::size_t Sweep(std::size_t buckets);
+
+protected:
+    /**
+     * Marks counter under the key as kept outside of the storage (see HotCounters), so that OnHotRemoved
+     * is called once its node goes away. Sets current value and expiration time of the counter. Returns
+     * false if key is missing, isn't a number or has tags, such counters are never kept outside
+     */
+    bool MarkHot(const std::string &key, uint64_t hash, uint64_t &value, uint64_t &expire);
+
+    /**
+     * Called when node marked by MarkHot is evicted, deleted or reclaimed after expiration. Could be
+     * called for counter the owner stopped to keep already
+     */
+    virtual void OnHotRemoved(const std::string &key, uint64_t hash) {}
 
 private:
-    // LRU cache node
-    using lru_node = struct lru_node {
-      lru_node(const std::string _key, const std::string _value, lru_node* prev):
-      key(_key), value(_value), prev(prev), next(nullptr) {}
-        const std::string key;
-        std::string value;
+    // LRU cache node, allocated from pool as there is one per item
+    using lru_node = struct lru_node : public Allocator::Pooled {
+        lru_node(const std::string &_key, uint64_t _hash, lru_node *prev, const allocator_type &alloc)
+            : key(_key.data(), _key.size(), alloc), hash(_hash), value(alloc), tag_stamp(0), hot(false),
+              header(alloc), prev(prev), next(nullptr) {}
+        const lru_string key;
+        const uint64_t hash;
+
+        // Value is either owned by the node or shared through the pool
+        lru_string value;
+        ValuePool::value_ptr shared;
+        ItemInfo info;
+
+        // TagTable clock tick node was written at, matters only if it has tags
+        uint64_t tag_stamp;
+
+        // Set by MarkHot
+        bool hot;
+
+        inline const char *ValueData() const { return shared ? shared->data.data() : value.data(); }
+        inline std::size_t ValueSize() const { return shared ? shared->data.size() : value.size(); }
+
+        // "VALUE <key> <flags> <bytes>\r\n" for get response
+        lru_string header;
         lru_node* prev;
         std::unique_ptr<lru_node> next;
     };
 
+    // Index key: bytes of the node key along with its precomputed hash, so that index never walks over
+    // key bytes to find bucket
+    using lru_key = struct lru_key {
+        template <typename String>
+        lru_key(const String &_key, uint64_t _hash) : data(_key.data()), size(_key.size()), hash(_hash) {}
+        const char *data;
+        std::size_t size;
+        uint64_t hash;
+    };
+
+    struct lru_key_hash {
+        std::size_t operator()(const lru_key &k) const { return k.hash; }
+    };
+
+    struct lru_key_equal {
+        bool operator()(const lru_key &a, const lru_key &b) const {
+            return a.hash == b.hash && a.size == b.size && std::memcmp(a.data, b.data, a.size) == 0;
+        }
+    };
+
     // Maximum number of bytes could be stored in this cache.
     // i.e all (keys+values) must be less the _max_size
     std::size_t _max_size, _cur_size = 0;
@@ -63,14 +227,61 @@ private:
     mutable std::unique_ptr<lru_node> _lru_head;
     mutable lru_node* _lru_tail;
 
-    bool InsertNode(const std::string &key, const std::string &value);
+    // Returns node for the key, unless there is no one or it is expired
+    lru_node *Find(const std::string &key, uint64_t hash, uint64_t now) const;
+
+    // Node is expired or invalidated by one of its tags, so it is only waiting to be reclaimed
+    inline bool Dead(const lru_node *node, uint64_t now) const {
+        return node->info.Expired(now) ||
+               (!node->info.tags.empty() && _tags && _tags->Stale(node->info.tags, node->tag_stamp));
+    }
+
+    bool InsertNode(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info);
 
     bool UpdateNode(lru_node *node) const;
 
-    bool CheckLRUCache(const std::size_t size);
+    bool SetNode(lru_node *node, const std::string &value, const ItemInfo &info);
+
+    void RemoveNode(lru_node *node);
+
+    // Gives node new value and attributes, charges value bytes
+    void AssignValue(lru_node *node, const std::string &value, const ItemInfo &info);
+
+    // Drops node's value, bytes are released unless value is still shared by others
+    void ReleaseValue(lru_node *node);
+
+    // Evicts least recently used nodes until charged bytes fit into the limit
+    bool CheckLRUCache();
+
+    // Memory of node keys and values
+    allocator_type _alloc;
 
     // Index of nodes from list above, allows fast random access to elements by lru_node#key
-    std::map<std::reference_wrapper<const std::string>, std::reference_wrapper<lru_node>, std::less<std::string>> _lru_index;
+    std::unordered_map<lru_key, std::reference_wrapper<lru_node>, lru_key_hash, lru_key_equal,
+                       allocator<std::pair<const lru_key, std::reference_wrapper<lru_node>>>>
+        _lru_index;
+
+    // Leases granted on missed keys
+    LeaseTable _leases;
+
+    // Index bucket next Sweep starts from
+    std::size_t _sweep_cursor;
+
+    // Expired nodes found by Sweep
+    std::vector<lru_node *> _sweep_found;
+
+    // Number of items reclaimed after expiration or invalidation
+    uint64_t _expired;
+
+    // Generations of tags, created on demand
+    std::shared_ptr<TagTable> _tags;
+
+    // Last version given to an item
+    uint64_t _cas;
+
+    // Values of at least that size go to the pool, zero if deduplication is off
+    std::size_t _dedup_min;
+    ValuePool _pool;
 };
 
 } // namespace Backend
@@ -0,0 +1,191 @@
+#ifndef AFINA_STORAGE_STRIPED_LRU_H
+#define AFINA_STORAGE_STRIPED_LRU_H
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ThreadSafeSimpleLRU.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Sharded SimpleLRU
+ * Splits key space on the number of independent ThreadSafeSimplLRU shards, each has its own lock and
+ * gets equal part of memory. Shard selected by key hash, the same hash is passed into shard to probe index.
+ *
+ * Each shard keeps its own hot counters (see ThreadSafeSimplLRU), so that no lock is shared across shards.
+ *
+ * All shards share tag generations, so that InvalidateTag takes no shard locks.
+ */
+class StripedLRU : public Afina::Storage {
+public:
+    StripedLRU(size_t max_size = 1024, size_t stripes = 4) : _tags(std::make_shared<TagTable>()) {
+        if (stripes == 0 || max_size / stripes == 0) {
+            throw std::runtime_error("Invalid stripes configuration");
+        }
+        _shards.reserve(stripes);
+        for (size_t i = 0; i < stripes; i++) {
+            _shards.emplace_back(new ThreadSafeSimplLRU(max_size / stripes));
+            _shards.back()->ShareTags(_tags);
+        }
+    }
+    ~StripedLRU() {}
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override { return Put(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        return PutIfAbsent(key, KeyHash::Of(key), value);
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override { return Set(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override { return Delete(key, KeyHash::Of(key)); }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) const override { return Get(key, KeyHash::Of(key), value); }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const std::string &value) override {
+        return Put(key, hash, value, ItemInfo());
+    }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value) override {
+        return PutIfAbsent(key, hash, value, ItemInfo());
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, uint64_t hash, const std::string &value) override {
+        return Set(key, hash, value, ItemInfo());
+    }
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key, uint64_t hash) override {
+        return Shard(hash).Delete(key, hash);
+    }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value) const override {
+        ItemInfo info;
+        return Get(key, hash, value, info);
+    }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override {
+        return Shard(hash).Put(key, hash, value, info);
+    }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override {
+        return Shard(hash).PutIfAbsent(key, hash, value, info);
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override {
+        return Shard(hash).Set(key, hash, value, info);
+    }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info) const override {
+        return Shard(hash).Get(key, hash, value, info);
+    }
+
+    // Implements Afina::Storage interface
+    bool AppendValue(const std::string &key, uint64_t hash, std::string &out, bool versioned) const override {
+        return Shard(hash).AppendValue(key, hash, out, versioned);
+    }
+
+    // Implements Afina::Storage interface
+    CasStatus CompareAndSwap(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info,
+                             uint64_t cas) override {
+        return Shard(hash).CompareAndSwap(key, hash, value, info, cas);
+    }
+
+    // Implements Afina::Storage interface
+    LeaseStatus GetLeased(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info,
+                          uint64_t &token) override {
+        return Shard(hash).GetLeased(key, hash, value, info, token);
+    }
+
+    // Implements Afina::Storage interface
+    bool PutLeased(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info,
+                   uint64_t token) override {
+        return Shard(hash).PutLeased(key, hash, value, info, token);
+    }
+
+    // Implements Afina::Storage interface
+    CounterStatus Increment(const std::string &key, uint64_t hash, uint64_t delta, bool decrement,
+                            uint64_t &result) override {
+        return Shard(hash).Increment(key, hash, delta, decrement, result);
+    }
+
+    /**
+     * Turns on deduplication of large values in each shard, see SimpleLRU::Deduplicate. Equal values
+     * are shared within the shard only
+     */
+    void Deduplicate(std::size_t min_size) {
+        for (auto &shard : _shards) {
+            shard->Deduplicate(min_size);
+        }
+    }
+
+    // Implements Afina::Storage interface
+    void Start() override {
+        for (auto &shard : _shards) {
+            shard->Start();
+        }
+    }
+
+    // Implements Afina::Storage interface
+    void Stop() override {
+        for (auto &shard : _shards) {
+            shard->Stop();
+        }
+    }
+
+    // Implements Afina::Storage interface
+    bool InvalidateTag(uint64_t tag) override {
+        _tags->Invalidate(tag);
+        return true;
+    }
+
+    // Implements Afina::Storage interface, counters are summed up over all shards
+    void GetStats(std::vector<std::pair<std::string, std::string>> &stats) const override {
+        std::vector<std::pair<std::string, uint64_t>> total;
+        for (auto &shard : _shards) {
+            std::vector<std::pair<std::string, std::string>> shard_stats;
+            shard->GetStats(shard_stats);
+            for (std::size_t i = 0; i < shard_stats.size(); i++) {
+                if (total.size() <= i) {
+                    total.emplace_back(shard_stats[i].first, 0);
+                }
+                total[i].second += std::stoull(shard_stats[i].second);
+            }
+        }
+
+        for (auto &stat : total) {
+            stats.emplace_back(stat.first, std::to_string(stat.second));
+        }
+    }
+
+private:
+    // Shard index uses high bits of hash, low ones are used by shard's index to select bucket
+    inline ThreadSafeSimplLRU &Shard(uint64_t hash) const { return *_shards[(hash >> 32) % _shards.size()]; }
+
+    // Tag generations shared by all the shards
+    std::shared_ptr<TagTable> _tags;
+
+    std::vector<std::unique_ptr<ThreadSafeSimplLRU>> _shards;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_STRIPED_LRU_H
@@ -0,0 +1,40 @@
+#include "TagTable.h"
+
+#include <stdexcept>
+
+namespace Afina {
+namespace Backend {
+
+// See TagTable.h
+TagTable::TagTable(std::size_t slots) : _clock(0), _generations(new std::atomic<uint64_t>[slots]), _mask(slots - 1) {
+    if (slots == 0 || (slots & (slots - 1)) != 0) {
+        throw std::runtime_error("Number of tag slots must be power of two");
+    }
+    for (std::size_t i = 0; i < slots; i++) {
+        _generations[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+// See TagTable.h
+void TagTable::Invalidate(uint64_t tag) {
+    uint64_t generation = _clock.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+    // Concurrent invalidations of the same slot must leave the latest generation there
+    std::atomic<uint64_t> &slot = _generations[tag & _mask];
+    uint64_t current = slot.load(std::memory_order_relaxed);
+    while (current < generation && !slot.compare_exchange_weak(current, generation, std::memory_order_release)) {
+    }
+}
+
+// See TagTable.h
+bool TagTable::Stale(const std::vector<uint64_t> &tags, uint64_t stamp) const {
+    for (uint64_t tag : tags) {
+        if (_generations[tag & _mask].load(std::memory_order_acquire) > stamp) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace Backend
+} // namespace Afina
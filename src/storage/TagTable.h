@@ -0,0 +1,56 @@
+#ifndef AFINA_STORAGE_TAG_TABLE_H
+#define AFINA_STORAGE_TAG_TABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Tag generations
+ * Invalidation of the tag doesn't touch items: it just moves the tag generation to the next tick of the
+ * global clock. Item remembers clock tick it was written at, it is invalidated once any of its tags has
+ * generation above that. Storage checks that lazily on read and reclaims memory on sweep.
+ *
+ * Generations are kept in fixed number of slots selected by tag hash, so memory doesn't grow with number
+ * of tags. Tags sharing slot are invalidated together, which costs extra misses but never returns item
+ * that should be gone.
+ *
+ * Thread safe, lock free
+ */
+class TagTable {
+public:
+    /**
+     * @param slots number of generation slots, power of two
+     */
+    TagTable(std::size_t slots = 1 << 16);
+    ~TagTable() {}
+
+    /**
+     * Clock tick to mark item written now with
+     */
+    inline uint64_t Stamp() const { return _clock.load(std::memory_order_acquire); }
+
+    /**
+     * Invalidates items written with the tag before the call
+     */
+    void Invalidate(uint64_t tag);
+
+    /**
+     * Returns true if item with given tags written at stamp is invalidated
+     */
+    bool Stale(const std::vector<uint64_t> &tags, uint64_t stamp) const;
+
+private:
+    std::atomic<uint64_t> _clock;
+    std::unique_ptr<std::atomic<uint64_t>[]> _generations;
+    const std::size_t _mask;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_TAG_TABLE_H
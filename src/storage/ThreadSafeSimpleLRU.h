@@ -1,11 +1,14 @@
 #ifndef AFINA_STORAGE_THREAD_SAFE_SIMPLE_LRU_H
 #define AFINA_STORAGE_THREAD_SAFE_SIMPLE_LRU_H
 
+#include <chrono>
 #include <map>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <condition_variable>
 
+#include "HotCounters.h"
 #include "SimpleLRU.h"
 
 namespace Afina {
@@ -13,52 +16,234 @@ namespace Backend {
 
 /**
  * # SimpleLRU thread safe version
+ * Only the most specific operations are taking lock, all others are forwarded to them by SimpleLRU.
+ * Start runs background thread that reclaims expired items.
  *
- *
+ * Counter which increments keep running into busy lock is made hot (see HotCounters): increments of it
+ * go into per-CPU slots without taking the lock and get folded into the storage on read of the key or
+ * every HotCounters::kFoldEvery ops. Writes of the key demote counter in the same critical section.
  */
 class ThreadSafeSimplLRU : public SimpleLRU {
 public:
-    ThreadSafeSimplLRU(size_t max_size = 1024) : SimpleLRU(max_size) {}
-    ~ThreadSafeSimplLRU() {}
+    ThreadSafeSimplLRU(size_t max_size = 1024) : SimpleLRU(max_size), _sweeping(false) {}
+    ~ThreadSafeSimplLRU() { Stop(); }
+
+    using SimpleLRU::Put;
+    using SimpleLRU::PutIfAbsent;
+    using SimpleLRU::Set;
+    using SimpleLRU::Delete;
+    using SimpleLRU::Get;
+
+    // see SimpleLRU.h
+    bool Put(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override {
+        std::lock_guard<std::mutex> lck(_mt);
+        Demote(key, hash);
+        return SimpleLRU::Put(key, hash, value, info);
+    }
 
     // see SimpleLRU.h
-    bool Put(const std::string &key, const std::string &value) override {
-        // TODO: sinchronization
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override {
         std::lock_guard<std::mutex> lck(_mt);
-        return SimpleLRU::Put(key, value);
+        Demote(key, hash);
+        return SimpleLRU::PutIfAbsent(key, hash, value, info);
     }
 
     // see SimpleLRU.h
-    bool PutIfAbsent(const std::string &key, const std::string &value) override {
-        // TODO: sinchronization
+    bool Set(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override {
         std::lock_guard<std::mutex> lck(_mt);
-        return SimpleLRU::PutIfAbsent(key, value);
+        Demote(key, hash);
+        return SimpleLRU::Set(key, hash, value, info);
     }
 
     // see SimpleLRU.h
-    bool Set(const std::string &key, const std::string &value) override {
-        // TODO: sinchronization
+    bool Delete(const std::string &key, uint64_t hash) override {
         std::lock_guard<std::mutex> lck(_mt);
-        return SimpleLRU::Set(key, value);
+        Demote(key, hash);
+        return SimpleLRU::Delete(key, hash);
+    }
+
+    // see SimpleLRU.h
+    bool Get(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info) const override {
+        std::lock_guard<std::mutex> lck(_mt);
+        Fold(key, hash);
+        return SimpleLRU::Get(key, hash, value, info);
+    }
+
+    // see SimpleLRU.h, increments of hot counter don't take the lock
+    CounterStatus Increment(const std::string &key, uint64_t hash, uint64_t delta, bool decrement,
+                            uint64_t &result) override {
+        bool fold = false;
+        if (!decrement && !_counters.Empty() && _counters.Add(key, hash, delta, result, fold)) {
+            if (fold) {
+                std::lock_guard<std::mutex> lck(_mt);
+                Fold(key, hash);
+            }
+            return CounterStatus::kOk;
+        }
+
+        std::unique_lock<std::mutex> lck(_mt, std::try_to_lock);
+        bool contended = !lck.owns_lock();
+        if (contended) {
+            lck.lock();
+        }
+
+        // Counter could get hot while we were waiting, decrement has to see all the increments to stop at zero
+        if (!_counters.Empty()) {
+            if (!decrement && _counters.Add(key, hash, delta, result, fold)) {
+                return CounterStatus::kOk;
+            }
+            Demote(key, hash);
+        }
+
+        CounterStatus status = SimpleLRU::Increment(key, hash, delta, decrement, result);
+        if (status == CounterStatus::kOk && contended && !decrement) {
+            PromoteLocked(key, hash);
+        }
+        return status;
     }
 
     // see SimpleLRU.h
-    bool Delete(const std::string &key) override {
-        // TODO: sinchronization
+    bool AppendValue(const std::string &key, uint64_t hash, std::string &out, bool versioned) const override {
         std::lock_guard<std::mutex> lck(_mt);
-        return SimpleLRU::Delete(key);
+        Fold(key, hash);
+        return SimpleLRU::AppendValue(key, hash, out, versioned);
     }
 
     // see SimpleLRU.h
-    bool Get(const std::string &key, std::string &value) const override {
-        // TODO: sinchronization
+    CasStatus CompareAndSwap(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info,
+                             uint64_t cas) override {
         std::lock_guard<std::mutex> lck(_mt);
-        return SimpleLRU::Get(key, value);
+        Demote(key, hash);
+        return SimpleLRU::CompareAndSwap(key, hash, value, info, cas);
+    }
+
+    // see SimpleLRU.h
+    LeaseStatus GetLeased(const std::string &key, uint64_t hash, std::string &value, ItemInfo &info,
+                          uint64_t &token) override {
+        std::lock_guard<std::mutex> lck(_mt);
+        Fold(key, hash);
+        return SimpleLRU::GetLeased(key, hash, value, info, token);
+    }
+
+    // see SimpleLRU.h
+    bool PutLeased(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info,
+                   uint64_t token) override {
+        std::lock_guard<std::mutex> lck(_mt);
+        Demote(key, hash);
+        return SimpleLRU::PutLeased(key, hash, value, info, token);
+    }
+
+    // see SimpleLRU.h
+    bool InvalidateTag(uint64_t tag) override {
+        std::lock_guard<std::mutex> lck(_mt);
+        return SimpleLRU::InvalidateTag(tag);
+    }
+
+    // see SimpleLRU.h
+    void GetStats(std::vector<std::pair<std::string, std::string>> &stats) const override {
+        std::lock_guard<std::mutex> lck(_mt);
+        SimpleLRU::GetStats(stats);
+    }
+
+    // see SimpleLRU.h
+    std::size_t Sweep(std::size_t buckets) override {
+        std::lock_guard<std::mutex> lck(_mt);
+        return SimpleLRU::Sweep(buckets);
+    }
+
+    // See Storage.h
+    void Start() override {
+        std::lock_guard<std::mutex> lck(_sweeper_mt);
+        if (_sweeping) {
+            return;
+        }
+        _sweeping = true;
+        _sweeper = std::thread(&ThreadSafeSimplLRU::Sweeper, this);
+    }
+
+    // See Storage.h
+    void Stop() override {
+        {
+            std::lock_guard<std::mutex> lck(_sweeper_mt);
+            if (!_sweeping) {
+                return;
+            }
+            _sweeping = false;
+        }
+        _sweeper_cv.notify_all();
+        _sweeper.join();
+    }
+
+protected:
+    /**
+     * Makes counter under the key hot as if its increments were contended, returns false if the key
+     * can't be
+     */
+    bool Promote(const std::string &key, uint64_t hash) {
+        std::lock_guard<std::mutex> lck(_mt);
+        return PromoteLocked(key, hash);
+    }
+
+    // see SimpleLRU.h, called under the lock
+    void OnHotRemoved(const std::string &key, uint64_t hash) override {
+        uint64_t delta;
+        _counters.Demote(key, hash, delta);
     }
 
 private:
-    // TODO: sinchronization primitives
+    // Period between background sweeps, ms
+    static const int kSweepPeriod = 100;
+
+    // Number of index buckets checked by one background sweep, lock is held for one bucket at a time
+    static const std::size_t kSweepBuckets = 256;
+
+    void Sweeper() {
+        std::unique_lock<std::mutex> lck(_sweeper_mt);
+        while (_sweeping) {
+            _sweeper_cv.wait_for(lck, std::chrono::milliseconds(int(kSweepPeriod)));
+            for (std::size_t i = 0; _sweeping && i < kSweepBuckets; i++) {
+                Sweep(1);
+            }
+        }
+    }
+
+    bool PromoteLocked(const std::string &key, uint64_t hash) {
+        uint64_t value, expire;
+        return MarkHot(key, hash, value, expire) && _counters.Promote(key, hash, value, expire);
+    }
+
+    // Applies pending increments of hot counter, must be called under the lock
+    void Fold(const std::string &key, uint64_t hash) const {
+        uint64_t delta, unused;
+        if (_counters.Empty() || !_counters.Fold(key, hash, delta) || delta == 0) {
+            return;
+        }
+
+        // Read of the key changes stored value, not the one client sees
+        auto self = const_cast<ThreadSafeSimplLRU *>(this);
+        if (self->SimpleLRU::Increment(key, hash, delta, false, unused) != CounterStatus::kOk) {
+            _counters.Demote(key, hash, delta);
+        }
+    }
+
+    // Applies pending increments of hot counter and makes it regular one, must be called under the lock
+    void Demote(const std::string &key, uint64_t hash) {
+        uint64_t delta, unused;
+        if (!_counters.Empty() && _counters.Demote(key, hash, delta) && delta != 0) {
+            SimpleLRU::Increment(key, hash, delta, false, unused);
+        }
+    }
+
     mutable std::mutex _mt;
+
+    // Counters that are incremented too often to take the lock each time
+    mutable HotCounters _counters;
+
+    // Background sweeper state
+    std::mutex _sweeper_mt;
+    std::condition_variable _sweeper_cv;
+    std::thread _sweeper;
+    bool _sweeping;
 };
 
 } // namespace Backend
@@ -0,0 +1,46 @@
+#include "ValuePool.h"
+
+#include <afina/Hash.h>
+
+namespace Afina {
+namespace Backend {
+
+// See ValuePool.h
+ValuePool::value_ptr ValuePool::Intern(const std::string &value, bool &created) {
+    uint64_t hash = KeyHash::Of(value);
+    auto range = _values.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second->data == value) {
+            created = false;
+            _saved += value.size();
+            return it->second;
+        }
+    }
+
+    created = true;
+    value_ptr shared = std::make_shared<const pooled_value>(value, hash);
+    _values.emplace(hash, shared);
+    return shared;
+}
+
+// See ValuePool.h
+bool ValuePool::Release(value_ptr &value) {
+    // The pool holds one reference, caller another one
+    bool last = value.use_count() == 2;
+    if (last) {
+        auto range = _values.equal_range(value->hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == value) {
+                _values.erase(it);
+                break;
+            }
+        }
+    } else {
+        _saved -= value->data.size();
+    }
+    value.reset();
+    return last;
+}
+
+} // namespace Backend
+} // namespace Afina
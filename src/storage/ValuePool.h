@@ -0,0 +1,61 @@
+#ifndef AFINA_STORAGE_VALUE_POOL_H
+#define AFINA_STORAGE_VALUE_POOL_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Content addressed store of large values
+ * Keeps single copy of each distinct value, indexed by hash of its content. Items holding the same
+ * value share one immutable string, so writing to the item never touches value of others: it gets the
+ * new value in place of the old reference. Value is dropped as soon as the last item releases it.
+ *
+ * Hash only selects candidates, content is always compared, so collisions never merge different values.
+ *
+ * That is NOT thread safe implementaiton!!
+ */
+class ValuePool {
+public:
+    // Pooled value along with hash of its content
+    struct pooled_value {
+        pooled_value(const std::string &_data, uint64_t _hash) : data(_data), hash(_hash) {}
+        const std::string data;
+        const uint64_t hash;
+    };
+
+    using value_ptr = std::shared_ptr<const pooled_value>;
+
+    ValuePool() : _saved(0) {}
+    ~ValuePool() {}
+
+    /**
+     * Returns shared copy of the value. Sets created to true if the value wasn't in the pool, so that
+     * caller got charged for its bytes
+     */
+    value_ptr Intern(const std::string &value, bool &created);
+
+    /**
+     * Drops caller's reference. Returns true if it was the last one and the value is gone
+     */
+    bool Release(value_ptr &value);
+
+    /**
+     * Number of distinct values and bytes that would be taken by extra copies without pool
+     */
+    inline std::size_t Values() const { return _values.size(); }
+    inline uint64_t SavedBytes() const { return _saved; }
+
+private:
+    std::unordered_multimap<uint64_t, value_ptr> _values;
+    uint64_t _saved;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_VALUE_POOL_H
@@ -0,0 +1,89 @@
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <afina/allocator/Arena.h>
+#include <afina/allocator/StdAllocator.h>
+
+using namespace std;
+using namespace Afina::Allocator;
+
+TEST(ArenaTest, BumpAndReset) {
+    Arena arena(1024);
+
+    char *a = static_cast<char *>(arena.allocate(10));
+    char *b = static_cast<char *>(arena.allocate(20));
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(a) % 16);
+    EXPECT_EQ(a + 16, b);
+    EXPECT_EQ(48, arena.Used());
+
+    // Memory goes on from the next chunks
+    for (int i = 0; i < 100; i++) {
+        memset(arena.allocate(100), i, 100);
+    }
+    size_t capacity = arena.Capacity();
+    EXPECT_GT(capacity, 1024);
+
+    // Chunks are kept, so the same requests take nothing new
+    arena.Reset();
+    EXPECT_EQ(0, arena.Used());
+    EXPECT_EQ(a, arena.allocate(10));
+    for (int i = 0; i < 100; i++) {
+        arena.allocate(100);
+    }
+    EXPECT_EQ(capacity, arena.Capacity());
+}
+
+TEST(ArenaTest, BigRequests) {
+    Arena arena(1024);
+    char *small = static_cast<char *>(arena.allocate(16));
+    char *big = static_cast<char *>(arena.allocate(10000));
+    memset(big, 1, 10000);
+    EXPECT_EQ(small + 16, arena.allocate(16));
+
+    // Big chunks are released on reset
+    size_t capacity = arena.Capacity();
+    arena.Reset();
+    EXPECT_LT(arena.Capacity(), capacity - 10000);
+}
+
+namespace {
+
+struct Counted {
+    Counted(int &alive) : _alive(alive) { _alive++; }
+    ~Counted() { _alive--; }
+    int &_alive;
+};
+
+} // namespace
+
+TEST(ArenaTest, NewDestroysObjects) {
+    Arena arena;
+    int alive = 0;
+    {
+        Arena::ptr<Counted> a = arena.New<Counted>(alive);
+        Arena::ptr<Counted> b = arena.New<Counted>(alive);
+        EXPECT_EQ(2, alive);
+    }
+    EXPECT_EQ(0, alive);
+}
+
+TEST(ArenaTest, Containers) {
+    Arena arena(256);
+    {
+        vector<int, StdAllocator<int, Arena>> v{StdAllocator<int, Arena>(arena)};
+        for (int i = 0; i < 1000; i++) {
+            v.push_back(i);
+        }
+        for (int i = 0; i < 1000; i++) {
+            ASSERT_EQ(i, v[i]);
+        }
+    }
+    arena.Reset();
+
+    // Default arena takes memory from the heap
+    vector<int, StdAllocator<int, Arena>> v;
+    v.assign(1000, 7);
+    EXPECT_EQ(&Arena::Default(), &v.get_allocator().arena());
+}
@@ -322,3 +322,117 @@ TEST(SimpleTest, ReallocGrow) {
     a.free(p);
     a.free(p2);
 }
+
+TEST(SimpleTest, DefragIncremental) {
+    Simple a(buf, sizeof(buf));
+
+    vector<Pointer> ptrs;
+    int size = 135;
+
+    ASSERT_TRUE(fillUp(a, size, ptrs));
+    for (size_t i = 0; i < ptrs.size(); i += 2) {
+        a.free(ptrs[i]);
+    }
+    vector<Pointer> live;
+    for (size_t i = 1; i < ptrs.size(); i += 2) {
+        live.push_back(ptrs[i]);
+    }
+
+    // Each step moves about one block, memory allocated in between is moved along
+    int steps = 0;
+    while (!a.defrag(size)) {
+        steps++;
+        if (steps == 10) {
+            live.push_back(a.alloc(size));
+            writeTo(live.back(), size);
+        }
+        for (Pointer &p : live) {
+            ASSERT_TRUE(isDataOk(p, size));
+        }
+    }
+    EXPECT_GT(steps, 10);
+
+    // All free space is in one piece now
+    Pointer big = a.alloc(size * (live.size() - 2));
+    writeTo(big, size * (live.size() - 2));
+    for (Pointer &p : live) {
+        EXPECT_TRUE(isDataOk(p, size));
+        a.free(p);
+    }
+    a.free(big);
+}
+
+TEST(SimpleTest, RandomOperations) {
+    Simple a(buf, sizeof(buf));
+
+    // Each live pointer keeps its size, content is checked after every defrag
+    vector<pair<Pointer, size_t>> live;
+    unsigned seed = 1;
+    for (int i = 0; i < 20000; i++) {
+        seed = seed * 1103515245 + 12345;
+        unsigned op = (seed >> 16) % 10;
+        size_t size = 1 + (seed >> 8) % 700;
+        try {
+            if (op < 4 || live.empty()) {
+                live.emplace_back(a.alloc(size), size);
+                writeTo(live.back().first, size);
+            } else if (op < 7) {
+                size_t j = (seed >> 4) % live.size();
+                a.free(live[j].first);
+                live.erase(live.begin() + j);
+            } else if (op < 9) {
+                size_t j = (seed >> 4) % live.size();
+                a.realloc(live[j].first, size);
+                ASSERT_TRUE(isDataOk(live[j].first, min(size, live[j].second)));
+                writeTo(live[j].first, size);
+                live[j].second = size;
+            } else {
+                a.defrag(1024);
+            }
+        } catch (AllocError &e) {
+            ASSERT_EQ(e.getType(), AllocErrorType::NoMemory);
+            a.defrag();
+        }
+
+        for (auto &p : live) {
+            ASSERT_TRUE(isValidMemory(p.first, p.second));
+        }
+    }
+
+    for (auto &p : live) {
+        EXPECT_TRUE(isDataOk(p.first, p.second));
+        a.free(p.first);
+    }
+
+    // Everything is free again
+    Pointer p = a.alloc(sizeof(buf) / 2);
+    a.free(p);
+}
+
+TEST(SimpleTest, DumpFragmentationMap) {
+    Simple a(buf, sizeof(buf));
+
+    Pointer p1 = a.alloc(100);
+    Pointer p2 = a.alloc(100);
+    void *pinned = a.allocate(32);
+    Pointer p3 = a.alloc(100);
+    a.free(p2);
+
+    // Blocks are 16 byte header plus payload rounded up to 16 bytes, descriptor table takes a slot per pointer
+    string dump = a.dump();
+    EXPECT_NE(string::npos, dump.find("\"used\":256,\"pinned\":48,\"free\":128,")) << dump;
+    EXPECT_NE(string::npos, dump.find("\"blocks\":4,\"free_blocks\":1,")) << dump;
+    EXPECT_NE(string::npos, dump.find("\"map\":[[\"U\",0,128],[\"F\",128,128],[\"P\",256,48],[\"U\",304,128],"
+                                      "[\"W\",432,"))
+        << dump;
+    EXPECT_EQ('}', dump.back());
+
+    // Once free space is contiguous there is no fragmentation
+    a.free(p1);
+    a.deallocate(pinned);
+    a.defrag();
+    dump = a.dump();
+    EXPECT_NE(string::npos, dump.find("\"fragmentation\":0.000000")) << dump;
+    EXPECT_NE(string::npos, dump.find("\"map\":[[\"U\",0,128],[\"W\",128,")) << dump;
+    a.free(p3);
+}
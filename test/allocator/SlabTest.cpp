@@ -0,0 +1,158 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <afina/allocator/Mempool.h>
+#include <afina/allocator/Pooled.h>
+#include <afina/allocator/SlabCache.h>
+
+using namespace std;
+using namespace Afina::Allocator;
+
+TEST(SlabTest, AllocFree) {
+    Mempool pool(40);
+    EXPECT_EQ(48, pool.size());
+
+    set<void *> seen;
+    vector<void *> objects;
+    for (int i = 0; i < 10000; i++) {
+        void *p = pool.Alloc();
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % 16);
+        EXPECT_TRUE(seen.insert(p).second) << "object given out twice";
+        memset(p, i & 0xff, pool.size());
+        objects.push_back(p);
+    }
+    EXPECT_GE(pool.Used(), 10000);
+    EXPECT_GE(pool.Slabs(), 10000 * 48 / SlabCache::kSlabSize);
+
+    for (size_t i = 0; i < objects.size(); i++) {
+        EXPECT_EQ(char(i & 0xff), *reinterpret_cast<char *>(objects[i]) + 0) << "object " << i;
+        EXPECT_EQ(char(i & 0xff), reinterpret_cast<char *>(objects[i])[47]) << "object " << i;
+    }
+    for (void *p : objects) {
+        pool.Free(p);
+    }
+
+    // Only objects sitting in the thread cache are left out of slabs
+    EXPECT_LE(pool.Used(), 2 * Mempool::kBatch);
+    EXPECT_LE(pool.Slabs(), 2);
+}
+
+TEST(SlabTest, EmptySlabsAreReused) {
+    size_t free_before;
+    {
+        Mempool pool(1024);
+        vector<void *> objects;
+        for (int i = 0; i < 1000; i++) {
+            objects.push_back(pool.Alloc());
+        }
+        free_before = SlabCache::Instance().FreeSlabs();
+        for (void *p : objects) {
+            pool.Free(p);
+        }
+        EXPECT_GT(SlabCache::Instance().FreeSlabs(), free_before);
+    }
+
+    // Mapped memory is only reused
+    size_t mapped = SlabCache::Instance().Slabs();
+    Mempool pool(1024);
+    vector<void *> objects;
+    for (int i = 0; i < 1000; i++) {
+        objects.push_back(pool.Alloc());
+    }
+    EXPECT_EQ(mapped, SlabCache::Instance().Slabs());
+    for (void *p : objects) {
+        pool.Free(p);
+    }
+}
+
+TEST(SlabTest, CrossThreadFree) {
+    Mempool pool(64);
+    const int kThreads = 4;
+    const int kRounds = 200;
+    const int kObjects = 500;
+
+    // Each thread allocates objects and hands them to the next one to free
+    vector<vector<void *>> inbox(kThreads);
+    vector<mutex> locks(kThreads);
+    atomic<int> corrupted(0);
+
+    vector<thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&, t] {
+            for (int r = 0; r < kRounds; r++) {
+                vector<void *> mine;
+                for (int i = 0; i < kObjects; i++) {
+                    void *p = pool.Alloc();
+                    *reinterpret_cast<uint64_t *>(p) = uint64_t(t);
+                    reinterpret_cast<uint64_t *>(p)[7] = uint64_t(t);
+                    mine.push_back(p);
+                }
+
+                vector<void *> received;
+                {
+                    lock_guard<mutex> lck(locks[(t + 1) % kThreads]);
+                    inbox[(t + 1) % kThreads].insert(inbox[(t + 1) % kThreads].end(), mine.begin(), mine.end());
+                }
+                {
+                    lock_guard<mutex> lck(locks[t]);
+                    received.swap(inbox[t]);
+                }
+                for (void *p : received) {
+                    uint64_t owner = *reinterpret_cast<uint64_t *>(p);
+                    if (owner != reinterpret_cast<uint64_t *>(p)[7] || owner != uint64_t((t + kThreads - 1) % kThreads)) {
+                        corrupted++;
+                    }
+                    pool.Free(p);
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    for (auto &box : inbox) {
+        for (void *p : box) {
+            pool.Free(p);
+        }
+    }
+
+    EXPECT_EQ(0, corrupted.load());
+
+    // Caches of exited threads are flushed, so only this thread could hold objects
+    EXPECT_LE(pool.Used(), 2 * Mempool::kBatch);
+}
+
+namespace {
+
+struct Object : public Pooled {
+    Object(int v) : value(v) {}
+    int value;
+    char payload[100];
+};
+
+struct Huge : public Pooled {
+    char payload[4096];
+};
+
+} // namespace
+
+TEST(SlabTest, PooledNewDelete) {
+    vector<Object *> objects;
+    for (int i = 0; i < 1000; i++) {
+        objects.push_back(new Object(i));
+    }
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(i, objects[i]->value);
+        delete objects[i];
+    }
+
+    Huge *h = new Huge();
+    memset(h->payload, 1, sizeof(h->payload));
+    delete h;
+}
@@ -0,0 +1,115 @@
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <afina/allocator/Error.h>
+#include <afina/allocator/Pointer.h>
+#include <afina/allocator/Simple.h>
+#include <afina/allocator/SlabArena.h>
+#include <afina/allocator/StdAllocator.h>
+
+using namespace std;
+using namespace Afina::Allocator;
+
+template <typename Arena>
+using arena_string = basic_string<char, char_traits<char>, StdAllocator<char, Arena>>;
+
+template <typename Arena> static void FillContainers(Arena &arena) {
+    using string_type = arena_string<Arena>;
+    using allocator_type = StdAllocator<char, Arena>;
+
+    vector<uint64_t, StdAllocator<uint64_t, Arena>> numbers{allocator_type(arena)};
+    for (uint64_t i = 0; i < 1000; i++) {
+        numbers.push_back(i * i);
+    }
+
+    map<string_type, string_type, less<string_type>, StdAllocator<pair<const string_type, string_type>, Arena>>
+        dict{allocator_type(arena)};
+    for (int i = 0; i < 200; i++) {
+        string_type key(("key-that-does-not-fit-into-small-string-" + to_string(i)).c_str(), allocator_type(arena));
+        dict.emplace(key, string_type(size_t(i), 'x', allocator_type(arena)));
+    }
+
+    for (uint64_t i = 0; i < 1000; i++) {
+        ASSERT_EQ(i * i, numbers[i]);
+    }
+    ASSERT_EQ(200, dict.size());
+    for (auto &it : dict) {
+        ASSERT_EQ(0, it.first.find("key-that-does-not-fit-into-small-string-"));
+        ASSERT_EQ(stoul(string(it.first.begin() + it.first.rfind('-') + 1, it.first.end())), it.second.size());
+    }
+}
+
+TEST(StdAllocatorTest, SimpleBackedContainers) {
+    vector<char> area(1024 * 1024);
+    Simple arena(area.data(), area.size());
+
+    FillContainers(arena);
+
+    // Everything is released, so the whole area could be taken again
+    void *p = arena.allocate(area.size() / 2);
+    arena.deallocate(p);
+}
+
+TEST(StdAllocatorTest, SlabArenaBackedContainers) {
+    SlabArena arena;
+    FillContainers(arena);
+    EXPECT_EQ(0, arena.Used());
+    EXPECT_GT(arena.Peak(), 1000 * sizeof(uint64_t));
+}
+
+TEST(StdAllocatorTest, SlabArenaLimit) {
+    SlabArena arena(4096);
+    arena_string<SlabArena> s{StdAllocator<char, SlabArena>(arena)};
+
+    s.assign(1000, 'a');
+    EXPECT_LE(arena.Used(), 4096);
+    EXPECT_THROW(s.assign(10000, 'b'), std::bad_alloc);
+    EXPECT_EQ(string(1000, 'a'), s.c_str());
+}
+
+TEST(StdAllocatorTest, SimpleOutOfMemory) {
+    char area[4096];
+    Simple arena(area, sizeof(area));
+    vector<char, StdAllocator<char, Simple>> v{StdAllocator<char, Simple>(arena)};
+
+    EXPECT_THROW(v.resize(sizeof(area)), AllocError);
+    v.resize(sizeof(area) / 4);
+    EXPECT_EQ(sizeof(area) / 4, v.size());
+}
+
+TEST(StdAllocatorTest, DefragKeepsPinnedBlocks) {
+    vector<char> area(65536);
+    Simple a(area.data(), area.size());
+
+    Pointer first = a.alloc(100);
+    char *pinned = reinterpret_cast<char *>(a.allocate(200));
+    Pointer second = a.alloc(100);
+    Pointer third = a.alloc(300);
+    memset(pinned, 7, 200);
+    memset(third.get(), 9, 300);
+
+    a.free(first);
+    a.free(second);
+    a.defrag();
+
+    // Pinned block stays, movable one slides right behind it
+    for (int i = 0; i < 200; i++) {
+        ASSERT_EQ(7, pinned[i]);
+    }
+    EXPECT_EQ(pinned + 208 + 16, reinterpret_cast<char *>(third.get()));
+    for (int i = 0; i < 300; i++) {
+        ASSERT_EQ(9, reinterpret_cast<char *>(third.get())[i]);
+    }
+
+    // Space below pinned block is still there to reuse
+    Pointer reused = a.alloc(100);
+    EXPECT_LT(reinterpret_cast<char *>(reused.get()), pinned);
+
+    EXPECT_THROW(a.deallocate(third.get()), AllocError);
+    a.deallocate(pinned);
+    a.free(reused);
+    a.free(third);
+}
@@ -0,0 +1,238 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <afina/Executor.h>
+
+using namespace Afina;
+
+// Allocations made by the current thread are counted while the flag is set
+static thread_local bool count_allocations = false;
+static std::atomic<std::size_t> allocations(0);
+
+void *operator new(std::size_t size) {
+    if (count_allocations) {
+        allocations++;
+    }
+    void *p = std::malloc(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+namespace {
+
+// Keeps tasks running until opened
+class Gate {
+public:
+    void Wait() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _waiting++;
+        _changed.notify_all();
+        _changed.wait(lock, [this] { return _open; });
+    }
+
+    void AwaitWaiting(std::size_t n) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _changed.wait(lock, [this, n] { return _waiting >= n; });
+    }
+
+    void Open() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _open = true;
+        _changed.notify_all();
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    std::size_t _waiting = 0;
+    bool _open = false;
+};
+
+} // namespace
+
+TEST(ExecutorTest, RunsAllTasksBeforeStop) {
+    std::atomic<int> done(0);
+    {
+        Executor executor("test", 2, 4, 1000, std::chrono::milliseconds(100));
+        for (int i = 0; i < 1000; i++) {
+            ASSERT_TRUE(executor.Execute([&done](int n) { done += n; }, 1));
+        }
+        executor.Stop(true);
+        EXPECT_EQ(0, executor.Threads());
+        EXPECT_FALSE(executor.Execute([] {}));
+    }
+    EXPECT_EQ(1000, done.load());
+}
+
+TEST(ExecutorTest, GrowsToHighWatermark) {
+    Gate gate;
+    Executor executor("test", 1, 3, 10, std::chrono::seconds(10));
+    EXPECT_EQ(1, executor.Threads());
+
+    for (int i = 0; i < 5; i++) {
+        ASSERT_TRUE(executor.Execute([&gate] { gate.Wait(); }));
+    }
+    gate.AwaitWaiting(3);
+    EXPECT_EQ(3, executor.Threads());
+    EXPECT_EQ(2, executor.Queued());
+
+    gate.Open();
+    executor.Stop(true);
+}
+
+TEST(ExecutorTest, RefusesTasksOverQueueLimit) {
+    Gate gate;
+    Executor executor("test", 1, 1, 2, std::chrono::seconds(10));
+    ASSERT_TRUE(executor.Execute([&gate] { gate.Wait(); }));
+    gate.AwaitWaiting(1);
+
+    EXPECT_TRUE(executor.Execute([] {}));
+    EXPECT_TRUE(executor.Execute([] {}));
+    EXPECT_FALSE(executor.Execute([] {}));
+
+    gate.Open();
+    executor.Stop(true);
+}
+
+TEST(ExecutorTest, ShrinksToLowWatermarkWhenIdle) {
+    Gate gate;
+    Executor executor("test", 1, 4, 10, std::chrono::milliseconds(20));
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(executor.Execute([&gate] { gate.Wait(); }));
+    }
+    gate.AwaitWaiting(4);
+    EXPECT_EQ(4, executor.Threads());
+    gate.Open();
+
+    for (int i = 0; i < 500 && executor.Threads() > 1; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(1, executor.Threads());
+}
+
+TEST(ExecutorTest, SurvivesThrowingTask) {
+    std::atomic<bool> done(false);
+    Executor executor("test", 1, 1, 10, std::chrono::seconds(10));
+    ASSERT_TRUE(executor.Execute([] { throw std::runtime_error("task failed"); }));
+    ASSERT_TRUE(executor.Execute([&done] { done = true; }));
+    executor.Stop(true);
+    EXPECT_TRUE(done.load());
+}
+
+TEST(ExecutorTest, BatchKeepsOrder) {
+    std::mutex mutex;
+    std::vector<int> order;
+    Executor executor("test", 1, 1, 64, std::chrono::seconds(10));
+
+    std::vector<Task> batch;
+    for (int i = 0; i < 10; i++) {
+        batch.emplace_back([&mutex, &order, i] {
+            std::unique_lock<std::mutex> lock(mutex);
+            order.push_back(i);
+        });
+    }
+    ASSERT_EQ(10, executor.ExecuteBatch(batch.data(), batch.size()));
+    EXPECT_FALSE(bool(batch[0]));
+    executor.Stop(true);
+
+    ASSERT_EQ(10, order.size());
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(i, order[i]);
+    }
+}
+
+TEST(ExecutorTest, BatchStopsWhenQueueIsFull) {
+    Gate gate;
+    Executor executor("test", 1, 1, 4, std::chrono::seconds(10));
+    ASSERT_TRUE(executor.Execute([&gate] { gate.Wait(); }));
+    gate.AwaitWaiting(1);
+
+    std::vector<Task> batch;
+    for (int i = 0; i < 6; i++) {
+        batch.emplace_back([] {});
+    }
+    EXPECT_EQ(4, executor.ExecuteBatch(batch.data(), batch.size()));
+    EXPECT_TRUE(bool(batch[4]));
+
+    gate.Open();
+    executor.Stop(true);
+}
+
+TEST(ExecutorTest, SubmissionDoesNotAllocate) {
+    struct Counter {
+        void Add(int n) { done += n; }
+        std::atomic<int> done;
+    } counter;
+    counter.done = 0;
+    Executor executor("test", 2, 2, 1024, std::chrono::seconds(10));
+
+    // Member function bound to object and argument, the way servers submit work, is too big for std::function
+    count_allocations = true;
+    for (int i = 0; i < 1000; i++) {
+        while (!executor.Execute(&Counter::Add, &counter, 1)) {
+            std::this_thread::yield();
+        }
+    }
+    count_allocations = false;
+
+    executor.Stop(true);
+    EXPECT_EQ(1000, counter.done.load());
+    EXPECT_EQ(0, allocations.load());
+}
+
+TEST(ExecutorTest, ReportsQueueAndRunTimes) {
+    Gate gate;
+    Executor executor("stats_test", 1, 1, 16, std::chrono::seconds(10));
+    ASSERT_TRUE(executor.Execute([&gate] { gate.Wait(); }));
+    gate.AwaitWaiting(1);
+    for (int i = 0; i < 3; i++) {
+        ASSERT_TRUE(executor.Execute([] {}));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    gate.Open();
+    executor.Stop(true);
+
+    std::vector<std::pair<std::string, std::string>> stats;
+    Executor::GetAllStats(stats);
+    std::map<std::string, uint64_t> values;
+    for (auto &stat : stats) {
+        if (stat.first.compare(0, 20, "executor:stats_test:") == 0) {
+            values[stat.first.substr(20)] = std::stoull(stat.second);
+        }
+    }
+
+    EXPECT_EQ(4, values["tasks"]);
+    EXPECT_EQ(0, values["queued"]);
+    // Gate was closed for 20ms, tasks queued behind it have waited that long
+    EXPECT_GE(values["wait_ns_max"], 20000000);
+    EXPECT_GE(values["run_ns_max"], 20000000);
+    EXPECT_GE(values["queue_depth_max"], 3);
+    EXPECT_LE(values["queue_depth_p50"], values["queue_depth_max"]);
+}
+
+TEST(ExecutorTest, FormatsStatsAsOneLine) {
+    Executor executor("format_test", 1, 1, 16, std::chrono::seconds(10));
+    ASSERT_TRUE(executor.Execute([] {}));
+    executor.Stop(true);
+
+    std::vector<std::pair<std::string, std::string>> stats;
+    executor.GetStats(stats);
+    std::string line = executor.FormatStats();
+    EXPECT_EQ(0, line.find("executor:format_test:threads=0 executor:format_test:queued=0"));
+    EXPECT_EQ(stats.size() - 1, size_t(std::count(line.begin(), line.end(), ' ')));
+    EXPECT_NE(std::string::npos, line.find(" executor:format_test:tasks=1 "));
+}
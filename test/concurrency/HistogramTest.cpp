@@ -0,0 +1,51 @@
+#include "gtest/gtest.h"
+
+#include <cstdint>
+
+#include "concurrency/Histogram.h"
+
+using Afina::Concurrency::Histogram;
+
+TEST(HistogramTest, BucketsCoverAllValues) {
+    uint64_t values[] = {0, 1, 7, 8, 9, 15, 16, 17, 100, 1000, 123456789, uint64_t(1) << 40, ~uint64_t(0)};
+    for (uint64_t value : values) {
+        int index = Histogram::Index(value);
+        ASSERT_LT(index, int(Histogram::kBuckets));
+        EXPECT_LE(value, Histogram::Upper(index)) << value;
+        if (index > 0) {
+            EXPECT_GT(value, Histogram::Upper(index - 1)) << value;
+        }
+        // Relative error is bounded by bucket width
+        EXPECT_LE(Histogram::Upper(index) - value, value / uint64_t(Histogram::kSubBuckets)) << value;
+    }
+}
+
+TEST(HistogramTest, Quantiles) {
+    Histogram histogram;
+    EXPECT_EQ(0, histogram.Quantile(0.5));
+    EXPECT_EQ(0, histogram.Max());
+
+    for (uint64_t i = 1; i <= 1000; i++) {
+        histogram.Record(i);
+    }
+    EXPECT_EQ(1000, histogram.Count());
+
+    // Upper bound of the bucket is reported, it is at most 1/8 above the real value
+    EXPECT_GE(histogram.Quantile(0.5), 500);
+    EXPECT_LE(histogram.Quantile(0.5), 500 + 500 / 8);
+    EXPECT_GE(histogram.Quantile(0.99), 990);
+    EXPECT_LE(histogram.Quantile(0.99), 990 + 990 / 8);
+    EXPECT_GE(histogram.Max(), 1000);
+    EXPECT_LE(histogram.Max(), 1000 + 1000 / 8);
+}
+
+TEST(HistogramTest, Merge) {
+    Histogram a, b;
+    a.Record(10);
+    b.Record(10);
+    b.Record(1000000);
+    a.Merge(b);
+    EXPECT_EQ(3, a.Count());
+    EXPECT_EQ(Histogram::Upper(Histogram::Index(10)), a.Quantile(0.5));
+    EXPECT_EQ(Histogram::Upper(Histogram::Index(1000000)), a.Max());
+}
@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+
+#include <array>
+#include <functional>
+#include <memory>
+
+#include <afina/Task.h>
+
+using namespace Afina;
+
+namespace {
+
+// Counts live copies to make sure task destroys everything it captured
+struct Tracked {
+    explicit Tracked(int &live) : live(&live) { (*this->live)++; }
+    Tracked(const Tracked &other) : live(other.live) { (*live)++; }
+    Tracked(Tracked &&other) noexcept : live(other.live) { (*live)++; }
+    ~Tracked() { (*live)--; }
+    void operator()() {}
+
+    int *live;
+};
+
+} // namespace
+
+TEST(TaskTest, FitsCacheLine) { EXPECT_EQ(64, sizeof(Task)); }
+
+TEST(TaskTest, RunsInlineCallable) {
+    int result = 0;
+    Task task([&result] { result = 42; });
+    ASSERT_TRUE(bool(task));
+    task();
+    EXPECT_EQ(42, result);
+}
+
+TEST(TaskTest, RunsBigCallable) {
+    std::array<int, 64> data;
+    data.fill(1);
+    int result = 0;
+    Task task([data, &result] {
+        for (int x : data) {
+            result += x;
+        }
+    });
+    Task moved(std::move(task));
+    EXPECT_FALSE(bool(task));
+    moved();
+    EXPECT_EQ(64, result);
+}
+
+TEST(TaskTest, HoldsMoveOnlyCallable) {
+    std::unique_ptr<int> value(new int(7));
+    int result = 0;
+    Task task(std::bind([&result](std::unique_ptr<int> &p) { result = *p; }, std::move(value)));
+    Task other;
+    other = std::move(task);
+    other();
+    EXPECT_EQ(7, result);
+}
+
+TEST(TaskTest, DestroysCapturedState) {
+    int live = 0;
+    {
+        Task small{Tracked(live)};
+        EXPECT_EQ(1, live);
+
+        // Doesn't fit inline storage
+        std::array<char, 100> padding{};
+        Task big(std::bind([](Tracked &, std::array<char, 100> &) {}, Tracked(live), padding));
+        EXPECT_EQ(2, live);
+
+        Task moved(std::move(small));
+        EXPECT_EQ(2, live);
+        moved.Reset();
+        EXPECT_EQ(1, live);
+
+        Task moved_big(std::move(big));
+        big = Task();
+        EXPECT_EQ(1, live);
+        moved_big = Task();
+        EXPECT_EQ(0, live);
+
+        small = Task(Tracked(live));
+        EXPECT_EQ(1, live);
+    }
+    EXPECT_EQ(0, live);
+}
@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <afina/WorkStealingExecutor.h>
+
+#include "concurrency/ChaseLevDeque.h"
+
+using namespace Afina;
+
+TEST(ChaseLevDequeTest, OwnerTakesInLifoOrder) {
+    Concurrency::ChaseLevDeque<int> deque(2);
+    std::vector<int> items(100);
+    for (auto &item : items) {
+        deque.Push(&item);
+    }
+    EXPECT_EQ(100, deque.Size());
+
+    // Thieves get the oldest element, owner the newest one
+    EXPECT_EQ(&items[0], deque.Steal());
+    for (int i = 99; i > 0; i--) {
+        ASSERT_EQ(&items[i], deque.Take());
+    }
+    EXPECT_EQ(nullptr, deque.Take());
+    EXPECT_EQ(nullptr, deque.Steal());
+}
+
+TEST(ChaseLevDequeTest, EveryElementIsTakenOnce) {
+    const int n = 200000;
+    std::vector<int> items(n);
+    std::vector<std::atomic<int>> taken(n);
+    Concurrency::ChaseLevDeque<int> deque(16);
+    std::atomic<bool> done(false);
+
+    auto count = [&](int *x) { taken[x - items.data()]++; };
+    std::vector<std::thread> thieves;
+    for (int i = 0; i < 3; i++) {
+        thieves.emplace_back([&] {
+            while (!done.load() || deque.Size() > 0) {
+                int *x = deque.Steal();
+                if (x != nullptr) {
+                    count(x);
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < n; i++) {
+        deque.Push(&items[i]);
+        if (i % 3 == 0) {
+            int *x = deque.Take();
+            if (x != nullptr) {
+                count(x);
+            }
+        }
+    }
+    done.store(true);
+    for (auto &thief : thieves) {
+        thief.join();
+    }
+    for (int *x = deque.Take(); x != nullptr; x = deque.Take()) {
+        count(x);
+    }
+
+    for (int i = 0; i < n; i++) {
+        ASSERT_EQ(1, taken[i].load()) << "element " << i;
+    }
+}
+
+TEST(WorkStealingExecutorTest, RunsAllTasksBeforeStop) {
+    std::atomic<int> done(0);
+    WorkStealingExecutor executor("test", 4);
+    for (int i = 0; i < 10000; i++) {
+        ASSERT_TRUE(executor.Execute([&done](int n) { done += n; }, 1));
+    }
+    executor.Stop(true);
+    EXPECT_EQ(10000, done.load());
+    EXPECT_FALSE(executor.Execute([] {}));
+}
+
+// Each task splits its range in two until it is small enough, so that most of the tasks are submitted from
+// inside the pool and spread over threads by stealing only
+void Sum(WorkStealingExecutor &executor, std::atomic<long> &sum, long from, long to) {
+    if (to - from <= 16) {
+        long local = 0;
+        for (long i = from; i < to; i++) {
+            local += i;
+        }
+        sum += local;
+        return;
+    }
+    long middle = from + (to - from) / 2;
+    executor.Execute(Sum, std::ref(executor), std::ref(sum), from, middle);
+    executor.Execute(Sum, std::ref(executor), std::ref(sum), middle, to);
+}
+
+TEST(WorkStealingExecutorTest, NestedTasksFinishBeforeStop) {
+    std::atomic<long> sum(0);
+    const long n = 1 << 18;
+    {
+        WorkStealingExecutor executor("test", 4);
+        ASSERT_TRUE(executor.Execute(Sum, std::ref(executor), std::ref(sum), 0, n));
+        executor.Stop(true);
+    }
+    EXPECT_EQ(n * (n - 1) / 2, sum.load());
+}
+
+TEST(WorkStealingExecutorTest, SleepingThreadsWakeUpForNewTasks) {
+    std::atomic<int> done(0);
+    WorkStealingExecutor executor("test", 2);
+    for (int round = 0; round < 100; round++) {
+        ASSERT_TRUE(executor.Execute([&done] { done++; }));
+        while (done.load() != round + 1) {
+            std::this_thread::yield();
+        }
+    }
+    executor.Stop(true);
+}
@@ -0,0 +1,67 @@
+#include "gtest/gtest.h"
+#include <string>
+
+#include <afina/execute/Cas.h>
+#include <afina/execute/Get.h>
+#include <afina/execute/Increment.h>
+#include <afina/execute/Set.h>
+
+#include "storage/SimpleLRU.h"
+#include "storage/StripedLRU.h"
+
+using namespace Afina;
+using namespace Afina::Backend;
+using namespace Afina::Execute;
+
+// Returns <cas unique> of the only item in gets response
+static uint64_t Version(const std::string &out) {
+    size_t end = out.find("\r\n");
+    size_t begin = out.rfind(' ', end);
+    return std::stoull(out.substr(begin + 1, end - begin - 1));
+}
+
+TEST(CasTest, GetsThenCas) {
+    StripedLRU storage;
+    std::string out;
+    Cas("KEY1", 0, 0, 1).Execute(storage, "val", out);
+    EXPECT_EQ("NOT_FOUND", out);
+
+    Set("KEY1", 5, 0).Execute(storage, "val1", out);
+    Get({"KEY1"}, true).Execute(storage, "", out);
+    uint64_t version = Version(out);
+    EXPECT_EQ("VALUE KEY1 5 4 " + std::to_string(version) + "\r\nval1\r\nEND", out);
+
+    // Plain get doesn't show version
+    Get({"KEY1"}).Execute(storage, "", out);
+    EXPECT_EQ("VALUE KEY1 5 4\r\nval1\r\nEND", out);
+
+    Cas("KEY1", 6, 0, version).Execute(storage, "val2", out);
+    EXPECT_EQ("STORED", out);
+    Cas("KEY1", 6, 0, version).Execute(storage, "val3", out);
+    EXPECT_EQ("EXISTS", out);
+
+    Get({"KEY1"}, true).Execute(storage, "", out);
+    EXPECT_NE(version, Version(out));
+    EXPECT_EQ(0, out.find("VALUE KEY1 6 4 "));
+
+    // Any write changes version
+    version = Version(out);
+    Set("KEY2", 0, 0).Execute(storage, "1", out);
+    Get({"KEY2"}, true).Execute(storage, "", out);
+    uint64_t counter_version = Version(out);
+    Increment("KEY2", 1, false).Execute(storage, "", out);
+    Cas("KEY2", 0, 0, counter_version).Execute(storage, "10", out);
+    EXPECT_EQ("EXISTS", out);
+}
+
+TEST(CasTest, DefaultRendering) {
+    SimpleLRU storage;
+    std::string out;
+    Set("KEY1", 3, 0).Execute(storage, "val1", out);
+
+    std::string own, base;
+    ASSERT_TRUE(storage.AppendValue("KEY1", KeyHash::Of("KEY1"), own, true));
+    ASSERT_TRUE(storage.Storage::AppendValue("KEY1", KeyHash::Of("KEY1"), base, true));
+    EXPECT_EQ(own, base);
+    EXPECT_EQ("VALUE KEY1 3 4 1\r\nval1\r\n", own);
+}
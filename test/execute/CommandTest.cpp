@@ -0,0 +1,35 @@
+#include "gtest/gtest.h"
+#include <string>
+
+#include <afina/execute/Get.h>
+#include <afina/execute/Set.h>
+
+#include "storage/SimpleLRU.h"
+
+using namespace Afina;
+using namespace Afina::Backend;
+using namespace Afina::Execute;
+
+TEST(CommandTest, BlockTerminatorIsStripped) {
+    SimpleLRU storage;
+    std::string out, block = "val\r\n";
+    Set("KEY1", 0, 0).ExecuteBlock(storage, block, out);
+    EXPECT_EQ("STORED", out);
+
+    std::string none;
+    Get({"KEY1"}).ExecuteBlock(storage, none, out);
+    EXPECT_EQ("VALUE KEY1 0 3\r\nval\r\nEND", out);
+}
+
+// Client that sent wrong byte count must not get wrong bytes stored
+TEST(CommandTest, BadDataChunk) {
+    SimpleLRU storage;
+    std::string out;
+    for (std::string block : {"vall\r", "va\r\n\r", "\n"}) {
+        Set("KEY1", 0, 0).ExecuteBlock(storage, block, out);
+        EXPECT_EQ("CLIENT_ERROR bad data chunk", out);
+    }
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("KEY1", value));
+}
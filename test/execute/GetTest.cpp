@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+#include <memory>
+#include <string>
+
+#include <afina/execute/Get.h>
+#include <afina/execute/LeaseGet.h>
+#include <afina/execute/Set.h>
+
+#include "storage/SimpleLRU.h"
+#include "storage/StripedLRU.h"
+
+using namespace Afina;
+using namespace Afina::Backend;
+using namespace Afina::Execute;
+
+TEST(GetTest, RendersFlags) {
+    SimpleLRU storage;
+    std::string out;
+    Set("KEY1", 42, 0).Execute(storage, "val1", out);
+    ASSERT_EQ("STORED", out);
+    Set("KEY2", 0, 0).Execute(storage, "", out);
+
+    Get({"KEY1", "KEY3", "KEY2"}).Execute(storage, "", out);
+    EXPECT_EQ("VALUE KEY1 42 4\r\nval1\r\nVALUE KEY2 0 0\r\n\r\nEND", out);
+
+    // Header follows value updates
+    Set("KEY1", 7, 0).Execute(storage, "longer value", out);
+    Get({"KEY1"}).Execute(storage, "", out);
+    EXPECT_EQ("VALUE KEY1 7 12\r\nlonger value\r\nEND", out);
+}
+
+TEST(GetTest, DefaultRendering) {
+    // Striped storage renders the same output through its shards
+    StripedLRU striped;
+    std::string out;
+    Set("KEY1", 3, 0).Execute(striped, "val1", out);
+    Get({"KEY1"}).Execute(striped, "", out);
+    EXPECT_EQ("VALUE KEY1 3 4\r\nval1\r\nEND", out);
+
+    // Base implementation formats block out of Get
+    std::string block;
+    ASSERT_TRUE(striped.Storage::AppendValue("KEY1", KeyHash::Of("KEY1"), block, false));
+    EXPECT_EQ("VALUE KEY1 3 4\r\nval1\r\n", block);
+}
+
+TEST(GetTest, LeaseGetRendersFlags) {
+    SimpleLRU storage;
+    std::string out;
+    Set("KEY1", 42, 0).Execute(storage, "val1", out);
+    Set("KEY2", 0, 0).Execute(storage, "val2", out);
+
+    LeaseGet({"KEY1"}, {KeyHash::Of("KEY1")}).Execute(storage, "", out);
+    EXPECT_EQ("VALUE KEY1 42 4\r\nval1\r\nEND", out);
+
+    // Deleted key: the first client gets a lease, the next one the value with its flags
+    storage.Delete("KEY1");
+    LeaseGet({"KEY1"}, {KeyHash::Of("KEY1")}).Execute(storage, "", out);
+    EXPECT_EQ(0, out.compare(0, 11, "LEASE KEY1 "));
+    LeaseGet({"KEY1", "KEY2"}, {KeyHash::Of("KEY1"), KeyHash::Of("KEY2")}).Execute(storage, "", out);
+    EXPECT_EQ("STALE KEY1 42 4\r\nval1\r\nVALUE KEY2 0 4\r\nval2\r\nEND", out);
+}
@@ -0,0 +1,39 @@
+#include "gtest/gtest.h"
+#include <string>
+
+#include <afina/execute/Get.h>
+#include <afina/execute/Increment.h>
+#include <afina/execute/Set.h>
+
+#include "storage/SimpleLRU.h"
+
+using namespace Afina;
+using namespace Afina::Backend;
+using namespace Afina::Execute;
+
+TEST(IncrementTest, Replies) {
+    SimpleLRU storage;
+    std::string out;
+    Increment("KEY1", 1, false).Execute(storage, "", out);
+    EXPECT_EQ("NOT_FOUND", out);
+
+    Set("KEY1", 5, 0).Execute(storage, "10", out);
+    Increment("KEY1", 95, false).Execute(storage, "", out);
+    EXPECT_EQ("105", out);
+    Increment("KEY1", 200, true).Execute(storage, "", out);
+    EXPECT_EQ("0", out);
+
+    // Flags survive the update, header follows new length
+    Increment("KEY1", 1234, false).Execute(storage, "", out);
+    Get({"KEY1"}).Execute(storage, "", out);
+    EXPECT_EQ("VALUE KEY1 5 4\r\n1234\r\nEND", out);
+
+    Set("KEY2", 0, 0).Execute(storage, "abc", out);
+    Increment("KEY2", 1, false).Execute(storage, "", out);
+    EXPECT_EQ("CLIENT_ERROR cannot increment or decrement non-numeric value", out);
+
+    SimpleLRU small(5);
+    Set("KEY1", 0, 0).Execute(small, "9", out);
+    Increment("KEY1", 1, false).Execute(small, "", out);
+    EXPECT_EQ("SERVER_ERROR out of memory storing object", out);
+}
@@ -0,0 +1,33 @@
+#include "gtest/gtest.h"
+#include <string>
+
+#include <afina/execute/Get.h>
+#include <afina/execute/InvalidateTag.h>
+#include <afina/execute/Set.h>
+
+#include "storage/CompactLRU.h"
+#include "storage/SimpleLRU.h"
+
+using namespace Afina;
+using namespace Afina::Backend;
+using namespace Afina::Execute;
+
+TEST(InvalidateTagTest, Replies) {
+    SimpleLRU storage;
+    std::string out;
+
+    Set tagged("KEY1", 0, 0);
+    tagged.Tag({KeyHash::Of("user:1"), KeyHash::Of("feed")});
+    tagged.Execute(storage, "abc", out);
+    Set("KEY2", 0, 0).Execute(storage, "def", out);
+
+    InvalidateTag({"feed"}, {KeyHash::Of("feed")}).Execute(storage, "", out);
+    EXPECT_EQ("INVALIDATED", out);
+    Get({"KEY1", "KEY2"}).Execute(storage, "", out);
+    EXPECT_EQ("VALUE KEY2 0 3\r\ndef\r\nEND", out);
+
+    // Storage without tags support
+    CompactLRU compact;
+    InvalidateTag({"feed"}, {KeyHash::Of("feed")}).Execute(compact, "", out);
+    EXPECT_EQ("SERVER_ERROR tags are not supported", out);
+}
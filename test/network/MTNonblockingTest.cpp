@@ -0,0 +1,171 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <afina/logging/Config.h>
+
+#include "logging/ServiceImpl.h"
+#include "network/mt_nonblocking/ServerImpl.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+using namespace Afina;
+using namespace Afina::Backend;
+
+namespace {
+
+// Storage that takes its time to render the key "slow"
+class SlowStorage : public ThreadSafeSimplLRU {
+public:
+    SlowStorage() : ThreadSafeSimplLRU(1024 * 1024) {}
+
+    bool AppendValue(const std::string &key, uint64_t hash, std::string &out, bool versioned) const override {
+        if (key == "slow") {
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        }
+        return ThreadSafeSimplLRU::AppendValue(key, hash, out, versioned);
+    }
+};
+
+// Loggers are registered globally, so that service is created once for all the tests
+std::shared_ptr<Logging::Service> Quiet() {
+    static std::shared_ptr<Logging::Service> service;
+    if (!service) {
+        auto config = std::make_shared<Logging::Config>();
+        Logging::Appender &console = config->appenders["console"];
+        console.type = Logging::Appender::Type::STDERR;
+        console.color = false;
+        Logging::Logger &logger = config->loggers["root"];
+        logger.level = Logging::Logger::Level::CRITICAL;
+        logger.appenders.push_back("console");
+        service = std::make_shared<Logging::ServiceImpl>(config);
+        service->Start();
+    }
+    return service;
+}
+
+// Server on a free port, stopped once goes out of scope
+class Server {
+public:
+    Server(uint32_t workers, uint32_t executors) : _storage(std::make_shared<SlowStorage>()) {
+        for (port = 20000 + getpid() % 20000;; port++) {
+            _server.reset(new Network::MTnonblock::ServerImpl(_storage, Quiet(), executors));
+            try {
+                _server->Start(port, 1, workers);
+                break;
+            } catch (std::runtime_error &) {
+                _server.reset();
+            }
+        }
+    }
+
+    ~Server() {
+        _server->Stop();
+        _server->Join();
+    }
+
+    uint16_t port;
+
+private:
+    std::shared_ptr<SlowStorage> _storage;
+    std::unique_ptr<Network::MTnonblock::ServerImpl> _server;
+};
+
+// Sends request and reads until the expected number of bytes arrives or the peer closes
+std::string Exchange(uint16_t port, const std::string &request, std::size_t expected) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(sock, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == -1) {
+        close(sock);
+        return "";
+    }
+
+    std::string response;
+    std::thread reader([sock, expected, &response]() {
+        char buffer[4096];
+        ssize_t n;
+        while (response.size() < expected && (n = read(sock, buffer, sizeof(buffer))) > 0) {
+            response.append(buffer, n);
+        }
+    });
+    for (std::size_t sent = 0; sent < request.size();) {
+        ssize_t n = write(sock, request.data() + sent, request.size() - sent);
+        if (n <= 0) {
+            break;
+        }
+        sent += n;
+    }
+    reader.join();
+    close(sock);
+    return response;
+}
+
+} // namespace
+
+TEST(MTNonblockingTest, PipelinedResponsesKeepOrder) {
+    Server server(2, 4);
+
+    // Clients come and go while others pipeline, so that connections are added and removed concurrently
+    const int clients = 8, commands = 2000;
+    std::vector<std::string> responses(clients), expected(clients);
+    std::vector<std::thread> threads;
+    for (int c = 0; c < clients; c++) {
+        std::string request;
+        for (int i = 0; i < commands; i++) {
+            std::string key = "key" + std::to_string(c) + ":" + std::to_string(i);
+            std::string value = "value" + std::to_string(i);
+            request += "set " + key + " 0 0 " + std::to_string(value.size()) + "\r\n" + value + "\r\n";
+            request += "get " + key + "\r\n";
+            expected[c] += "STORED\r\n";
+            expected[c] += "VALUE " + key + " 0 " + std::to_string(value.size()) + "\r\n" + value + "\r\nEND\r\n";
+        }
+        threads.emplace_back([&server, &responses, &expected, request, c]() {
+            for (int i = 0; i < 20; i++) {
+                Exchange(server.port, "get short\r\n", 5);
+            }
+            responses[c] = Exchange(server.port, request, expected[c].size());
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    for (int c = 0; c < clients; c++) {
+        EXPECT_EQ(expected[c], responses[c]) << "client " << c;
+    }
+}
+
+// Block of wrong size is rejected in its turn, bytes after it are parsed as the next command
+TEST(MTNonblockingTest, BadDataChunk) {
+    for (uint32_t executors : {0, 2}) {
+        Server server(1, executors);
+        std::string expected = "STORED\r\nCLIENT_ERROR bad data chunk\r\nVALUE key 0 1\r\nx\r\nEND\r\n";
+        EXPECT_EQ(expected, Exchange(server.port, "set key 0 0 1\r\nx\r\nset key 0 0 2\r\nabc\nget key\r\n",
+                                     expected.size()));
+    }
+}
+
+TEST(MTNonblockingTest, SlowCommandDoesntHoldOthers) {
+    // The only I/O thread stays free while the pool runs slow command
+    Server server(1, 2);
+    std::thread slow([&server]() { EXPECT_EQ("END\r\n", Exchange(server.port, "get slow\r\n", 5)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ("STORED\r\n", Exchange(server.port, "set fast 0 0 1\r\nx\r\n", 8));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_LT(elapsed, std::chrono::milliseconds(300));
+    slow.join();
+}
@@ -3,8 +3,14 @@
 #include <memory>
 #include <string>
 
+#include <afina/Hash.h>
 #include <afina/execute/Add.h>
+#include <afina/execute/Cas.h>
+#include <afina/execute/Delete.h>
 #include <afina/execute/Get.h>
+#include <afina/execute/Increment.h>
+#include <afina/execute/InvalidateTag.h>
+#include <afina/execute/LeaseSet.h>
 #include <afina/execute/Set.h>
 #include <afina/execute/Stats.h>
 
@@ -33,6 +39,7 @@ TEST(MemcachedParserTest, SimpleSet) {
 
     Execute::Set *tmp = reinterpret_cast<Execute::Set *>(cmd.get());
     ASSERT_EQ("foo", tmp->key());
+    ASSERT_EQ(KeyHash::Of("foo"), tmp->hash());
     ASSERT_EQ(0, tmp->flags());
     ASSERT_EQ(0, tmp->expire());
 }
@@ -74,11 +81,39 @@ TEST(MemcachedParserTest, SimpleGet) {
     ASSERT_EQ(0, value_size);
 
     Execute::Get *tmp = reinterpret_cast<Execute::Get *>(cmd.get());
-    std::vector<std::string> keys = tmp->keys();
+    Execute::Get::keys_type keys = tmp->keys();
     ASSERT_EQ(3, keys.size());
     ASSERT_EQ("ke", keys[0]);
     ASSERT_EQ("key2", keys[1]);
     ASSERT_EQ("super_long_key", keys[2]);
+
+    Execute::Get::hashes_type hashes = tmp->hashes();
+    ASSERT_EQ(3, hashes.size());
+    ASSERT_EQ(KeyHash::Of("ke"), hashes[0]);
+    ASSERT_EQ(KeyHash::Of("key2"), hashes[1]);
+    ASSERT_EQ(KeyHash::Of("super_long_key"), hashes[2]);
+}
+
+// Verify key hash doesn't depend on how input was splitted between Parse calls
+TEST(MemcachedParserTest, KeyHashSplitInput) {
+    Protocol::Parser parser;
+    const std::string input = "get a_rather_long_key_name short\r\n";
+
+    size_t consumed = 0, total = 0;
+    for (size_t i = 0; i < input.size(); i += 3) {
+        parser.Parse(input.substr(i, 3), consumed);
+        total += consumed;
+    }
+    ASSERT_EQ(input.size(), total);
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+
+    Execute::Get *tmp = reinterpret_cast<Execute::Get *>(cmd.get());
+    ASSERT_EQ(2, tmp->hashes().size());
+    ASSERT_EQ(KeyHash::Of("a_rather_long_key_name"), tmp->hashes()[0]);
+    ASSERT_EQ(KeyHash::Of("short"), tmp->hashes()[1]);
 }
 
 TEST(MemcachedParserTest, Stats) {
@@ -98,3 +133,178 @@ TEST(MemcachedParserTest, Stats) {
     Execute::Stats *tmp = reinterpret_cast<Execute::Stats *>(cmd.get());
     ASSERT_FALSE(tmp == nullptr);
 }
+
+TEST(MemcachedParserTest, LeaseSet) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    bool cmd_avail = parser.Parse("lset foo 3 0 6 18446744073709551615\r\nfooval\r\n", consumed);
+    ASSERT_TRUE(cmd_avail);
+    ASSERT_EQ(37, consumed);
+    ASSERT_EQ("lset", parser.Name());
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(6, value_size);
+
+    Execute::LeaseSet *tmp = reinterpret_cast<Execute::LeaseSet *>(cmd.get());
+    ASSERT_EQ("foo", tmp->key());
+    ASSERT_EQ(3, tmp->flags());
+    ASSERT_EQ(18446744073709551615ULL, tmp->token());
+}
+
+TEST(MemcachedParserTest, Delete) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    bool cmd_avail = parser.Parse("delete foo\r\n", consumed);
+    ASSERT_TRUE(cmd_avail);
+    ASSERT_EQ(12, consumed);
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(0, value_size);
+
+    Execute::Delete *tmp = reinterpret_cast<Execute::Delete *>(cmd.get());
+    ASSERT_EQ("foo", tmp->key());
+    ASSERT_EQ(KeyHash::Of("foo"), tmp->hash());
+}
+
+TEST(MemcachedParserTest, SoftExpireTime) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    bool cmd_avail = parser.Parse("set foo 0 300 6 60\r\nfooval\r\n", consumed);
+    ASSERT_TRUE(cmd_avail);
+    ASSERT_EQ(20, consumed);
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(6, value_size);
+
+    Execute::Set *tmp = reinterpret_cast<Execute::Set *>(cmd.get());
+    ASSERT_EQ(300, tmp->expire());
+    ASSERT_EQ(60, tmp->soft_expire());
+    ASSERT_LT(tmp->item_info().soft_expire, tmp->item_info().expire);
+
+    parser.Reset();
+    cmd_avail = parser.Parse("lset foo 0 0 6 42 60\r\n", consumed);
+    ASSERT_TRUE(cmd_avail);
+    cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+
+    Execute::LeaseSet *lset = reinterpret_cast<Execute::LeaseSet *>(cmd.get());
+    ASSERT_EQ(42, lset->token());
+    ASSERT_EQ(60, lset->soft_expire());
+}
+
+TEST(MemcachedParserTest, IncrementDecrement) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    bool cmd_avail = parser.Parse("incr foo 18446744073709551615\r\n", consumed);
+    ASSERT_TRUE(cmd_avail);
+    ASSERT_EQ(31, consumed);
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(0, value_size);
+
+    Execute::Increment *tmp = reinterpret_cast<Execute::Increment *>(cmd.get());
+    ASSERT_EQ("foo", tmp->key());
+    ASSERT_EQ(KeyHash::Of("foo"), tmp->hash());
+    ASSERT_EQ(18446744073709551615ULL, tmp->delta());
+    ASSERT_FALSE(tmp->decrement());
+
+    parser.Reset();
+    cmd_avail = parser.Parse("decr foo 7\r\n", consumed);
+    ASSERT_TRUE(cmd_avail);
+    cmd = parser.Build(value_size);
+    tmp = reinterpret_cast<Execute::Increment *>(cmd.get());
+    ASSERT_EQ(7, tmp->delta());
+    ASSERT_TRUE(tmp->decrement());
+
+    parser.Reset();
+    ASSERT_THROW(parser.Parse("incr foo 18446744073709551616\r\n", consumed), std::runtime_error);
+    parser.Reset();
+    ASSERT_THROW(parser.Parse("incr foo -1\r\n", consumed), std::runtime_error);
+}
+
+TEST(MemcachedParserTest, GetsCas) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    bool cmd_avail = parser.Parse("gets foo bar\r\n", consumed);
+    ASSERT_TRUE(cmd_avail);
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    Execute::Get *gets = reinterpret_cast<Execute::Get *>(cmd.get());
+    ASSERT_EQ(2, gets->keys().size());
+    ASSERT_TRUE(gets->versioned());
+
+    parser.Reset();
+    cmd_avail = parser.Parse("cas foo 3 0 6 18446744073709551615 60\r\nfooval\r\n", consumed);
+    ASSERT_TRUE(cmd_avail);
+    ASSERT_EQ(39, consumed);
+    cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(6, value_size);
+
+    Execute::Cas *cas = reinterpret_cast<Execute::Cas *>(cmd.get());
+    ASSERT_EQ("foo", cas->key());
+    ASSERT_EQ(3, cas->flags());
+    ASSERT_EQ(18446744073709551615ULL, cas->cas());
+    ASSERT_EQ(60, cas->soft_expire());
+
+    parser.Reset();
+    ASSERT_THROW(parser.Parse("cas foo 3 0 6 18446744073709551616\r\n", consumed), std::runtime_error);
+}
+
+TEST(MemcachedParserTest, Tags) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    bool cmd_avail = parser.Parse("set foo 0 0 6 60 #user:1 #feed\r\nfooval\r\n", consumed);
+    ASSERT_TRUE(cmd_avail);
+    ASSERT_EQ(32, consumed);
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(6, value_size);
+
+    Execute::Set *set = reinterpret_cast<Execute::Set *>(cmd.get());
+    ASSERT_EQ(60, set->soft_expire());
+    ASSERT_EQ(2, set->item_info().tags.size());
+    ASSERT_EQ(KeyHash::Of("user:1"), set->item_info().tags[0]);
+    ASSERT_EQ(KeyHash::Of("feed"), set->item_info().tags[1]);
+
+    parser.Reset();
+    cmd_avail = parser.Parse("cas foo 0 0 6 5 #feed\r\n", consumed);
+    ASSERT_TRUE(cmd_avail);
+    cmd = parser.Build(value_size);
+    Execute::Cas *cas = reinterpret_cast<Execute::Cas *>(cmd.get());
+    ASSERT_EQ(5, cas->cas());
+    ASSERT_EQ(1, cas->tags().size());
+
+    parser.Reset();
+    cmd_avail = parser.Parse("invalidate_tag user:1 feed\r\n", consumed);
+    ASSERT_TRUE(cmd_avail);
+    cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(0, value_size);
+    Execute::InvalidateTag *invalidate = reinterpret_cast<Execute::InvalidateTag *>(cmd.get());
+    ASSERT_EQ(2, invalidate->tags().size());
+    ASSERT_EQ(KeyHash::Of("feed"), invalidate->hashes()[1]);
+
+    parser.Reset();
+    ASSERT_THROW(parser.Parse("set foo 0 0 6 # \r\n", consumed), std::runtime_error);
+    parser.Reset();
+    ASSERT_THROW(parser.Parse("set foo 0 0 6 #a 60\r\n", consumed), std::runtime_error);
+}
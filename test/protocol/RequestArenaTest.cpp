@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <sys/uio.h>
+
+#include <afina/Storage.h>
+#include <afina/allocator/Arena.h>
+#include <afina/execute/Command.h>
+
+#include <protocol/Parser.h>
+
+using namespace Afina;
+
+// Number of heap allocations made by the test binary so far
+static size_t allocations = 0;
+
+void *operator new(std::size_t size) {
+    allocations++;
+    void *p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+// Storage keeping single value under any key, so that only allocations of the request path are counted
+class FixedStorage : public Storage {
+public:
+    FixedStorage() : value("value that takes more than small string") {}
+
+    bool Put(const std::string &key, const std::string &value) override { return true; }
+    bool PutIfAbsent(const std::string &key, const std::string &value) override { return false; }
+    bool Set(const std::string &key, const std::string &value) override { return true; }
+    bool Delete(const std::string &key) override { return false; }
+    bool Get(const std::string &key, std::string &value) const override {
+        value.assign(this->value);
+        return true;
+    }
+
+    bool AppendValue(const std::string &key, uint64_t hash, std::string &out, bool versioned) const override {
+        RenderHeader(key, 0, value.size(), out);
+        out.append(value).append("\r\n");
+        return true;
+    }
+
+    const std::string value;
+};
+
+// Feeds requests through the same steps nonblocking connection makes
+class RequestLoop {
+public:
+    RequestLoop() : arena(4096), arg_remains(0) {}
+
+    void Run(const char *input, std::size_t size) {
+        while (size > 0) {
+            if (!command) {
+                std::size_t parsed = 0;
+                if (parser.Parse(input, size, parsed)) {
+                    command = parser.Build(arg_remains, arena);
+                    if (arg_remains > 0) {
+                        arg_remains += 2;
+                    }
+                }
+                input += parsed;
+                size -= parsed;
+            }
+
+            if (command && arg_remains > 0) {
+                std::size_t to_read = std::min(arg_remains, size);
+                argument.append(input, to_read);
+                input += to_read;
+                size -= to_read;
+                arg_remains -= to_read;
+            }
+
+            if (command && arg_remains == 0) {
+                if (argument.size() >= 2) {
+                    argument.resize(argument.size() - 2);
+                }
+                command->Execute(storage, argument, result);
+
+                struct iovec response;
+                response.iov_len = result.size() + 2;
+                response.iov_base = arena.allocate(response.iov_len);
+                std::memcpy(response.iov_base, result.data(), result.size());
+                std::memcpy(static_cast<char *>(response.iov_base) + result.size(), "\r\n", 2);
+                responses.push_back(response);
+
+                command.reset();
+                argument.resize(0);
+                parser.Reset();
+            }
+        }
+    }
+
+    // Everything is written out to the given string
+    void Flush(std::string &out) {
+        for (auto &response : responses) {
+            out.append(static_cast<char *>(response.iov_base), response.iov_len);
+        }
+        responses.clear();
+        arena.Reset();
+    }
+
+    FixedStorage storage;
+    Allocator::Arena arena;
+    Protocol::Parser parser;
+    Allocator::Arena::ptr<Execute::Command> command;
+    std::size_t arg_remains;
+    std::string argument;
+    std::string result;
+    std::vector<struct iovec> responses;
+};
+
+} // namespace
+
+// Tagged writes are not here: list of tags is handed over to storage, which keeps it
+TEST(RequestArenaTest, SteadyStateMakesNoAllocations) {
+    const std::string requests = "set key 0 0 40\r\n0123456789012345678901234567890123456789\r\n"
+                                 "get key other_key\r\n"
+                                 "gets key\r\n"
+                                 "delete key\r\n"
+                                 "add key 0 0 5 60\r\nvalue\r\n";
+    const std::string expected = "STORED\r\n"
+                                 "VALUE key 0 39\r\nvalue that takes more than small string\r\n"
+                                 "VALUE other_key 0 39\r\nvalue that takes more than small string\r\nEND\r\n"
+                                 "VALUE key 0 39\r\nvalue that takes more than small string\r\nEND\r\n"
+                                 "NOT_FOUND\r\n"
+                                 "NOT_STORED\r\n";
+
+    RequestLoop loop;
+    std::string out;
+    out.reserve(expected.size());
+
+    // The first rounds grow buffers up to the size requests need
+    for (int i = 0; i < 3; i++) {
+        out.clear();
+        loop.Run(requests.data(), requests.size());
+        loop.Flush(out);
+        ASSERT_EQ(expected, out);
+    }
+
+    size_t before = allocations;
+    for (int i = 0; i < 100; i++) {
+        out.clear();
+        loop.Run(requests.data(), requests.size());
+        loop.Flush(out);
+    }
+    EXPECT_EQ(before, allocations);
+    EXPECT_EQ(expected, out);
+}
+
+TEST(RequestArenaTest, PipelinedRequestsAreKeptUntilFlush) {
+    RequestLoop loop;
+    std::string requests;
+    std::string expected;
+    for (int i = 0; i < 1000; i++) {
+        requests += "get key" + std::to_string(i) + "\r\n";
+        expected += "VALUE key" + std::to_string(i) + " 0 39\r\nvalue that takes more than small string\r\nEND\r\n";
+    }
+
+    // Requests are split at every byte
+    for (char c : requests) {
+        loop.Run(&c, 1);
+    }
+    EXPECT_GT(loop.arena.Capacity(), 4096);
+
+    std::string out;
+    loop.Flush(out);
+    ASSERT_EQ(expected, out);
+    EXPECT_EQ(0, loop.arena.Used());
+}
@@ -0,0 +1,145 @@
+#include "gtest/gtest.h"
+#include <string>
+
+#include <afina/Hash.h>
+
+#include "storage/CompactLRU.h"
+
+using namespace Afina;
+using namespace Afina::Backend;
+
+static std::string StatOf(const Storage &storage, const std::string &name) {
+    std::vector<std::pair<std::string, std::string>> stats;
+    storage.GetStats(stats);
+    for (auto &stat : stats) {
+        if (stat.first == name) {
+            return stat.second;
+        }
+    }
+    return "";
+}
+
+TEST(CompactLRUTest, PutGet) {
+    CompactLRU storage;
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY1", "other"));
+    EXPECT_TRUE(storage.Set("KEY2", "val22"));
+    EXPECT_FALSE(storage.Set("KEY3", "val3"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("val1", value);
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ("val22", value);
+
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Delete("KEY1"));
+    EXPECT_EQ("1", StatOf(storage, "curr_items"));
+}
+
+TEST(CompactLRUTest, BigValueMovesClass) {
+    CompactLRU storage;
+
+    EXPECT_TRUE(storage.Put("KEY", "small"));
+    EXPECT_TRUE(storage.Put("KEY", std::string(100000, 'x')));
+    EXPECT_TRUE(storage.Put("OTHER", "small"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY", value));
+    EXPECT_EQ(std::string(100000, 'x'), value);
+    EXPECT_FALSE(storage.Put("HUGE", std::string(CompactLRU::kPageSize, 'x')));
+    EXPECT_EQ("2", StatOf(storage, "curr_items"));
+}
+
+TEST(CompactLRUTest, Eviction) {
+    CompactLRU storage(CompactLRU::kPageSize);
+
+    const int count = 20000;
+    for (int i = 0; i < count; i++) {
+        std::string key = "KEY" + std::to_string(i);
+        ASSERT_TRUE(storage.Put(key, std::string(100, 'a' + i % 26)));
+
+        // Keeps the first key hot
+        std::string value;
+        EXPECT_TRUE(storage.Get("KEY0", value));
+    }
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY0", value));
+    EXPECT_TRUE(storage.Get("KEY" + std::to_string(count - 1), value));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_NE("0", StatOf(storage, "evictions"));
+    EXPECT_EQ("1", StatOf(storage, "compact_pages"));
+}
+
+TEST(CompactLRUTest, PageStealing) {
+    CompactLRU storage(2 * CompactLRU::kPageSize);
+
+    // Small items take all the pages
+    for (int i = 0; i < 50000; i++) {
+        ASSERT_TRUE(storage.Put("KEY" + std::to_string(i), std::string(100, 'a')));
+    }
+    EXPECT_EQ("2", StatOf(storage, "compact_pages"));
+
+    // Size mix shifts, big items still find a place
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TRUE(storage.Put("BIG" + std::to_string(i), std::string(50000, 'b')));
+    }
+
+    std::string value;
+    for (int i = 0; i < 10; i++) {
+        EXPECT_TRUE(storage.Get("BIG" + std::to_string(i), value));
+        EXPECT_EQ(std::string(50000, 'b'), value);
+    }
+
+    // Only one page of small items is gone
+    EXPECT_GT(std::stoull(StatOf(storage, "curr_items")), 1000);
+    EXPECT_EQ("2", StatOf(storage, "compact_pages"));
+}
+
+TEST(CompactLRUTest, Expiration) {
+    CompactLRU storage;
+
+    ItemInfo info;
+    info.expire = ItemInfo::Now() - 1;
+    EXPECT_TRUE(storage.Put("OLD", KeyHash::Of("OLD"), "val", info));
+    info.expire = ItemInfo::Now() + 60000;
+    info.flags = 42;
+    EXPECT_TRUE(storage.Put("NEW", KeyHash::Of("NEW"), "val", info));
+
+    std::string value;
+    ItemInfo got;
+    EXPECT_FALSE(storage.Get("OLD", KeyHash::Of("OLD"), value, got));
+    EXPECT_TRUE(storage.PutIfAbsent("OLD", "again"));
+    EXPECT_TRUE(storage.Get("NEW", KeyHash::Of("NEW"), value, got));
+    EXPECT_EQ(42, got.flags);
+    EXPECT_EQ(info.expire, got.expire);
+}
+
+TEST(CompactLRUTest, IncrementAndCas) {
+    CompactLRU storage;
+    uint64_t hash = KeyHash::Of("KEY");
+
+    uint64_t result = 0;
+    EXPECT_EQ(Storage::CounterStatus::kNotFound, storage.Increment("KEY", hash, 1, false, result));
+    EXPECT_TRUE(storage.Put("KEY", "10"));
+    EXPECT_EQ(Storage::CounterStatus::kOk, storage.Increment("KEY", hash, 5, false, result));
+    EXPECT_EQ(15, result);
+    EXPECT_EQ(Storage::CounterStatus::kOk, storage.Increment("KEY", hash, 20, true, result));
+    EXPECT_EQ(0, result);
+
+    std::string value;
+    ItemInfo info;
+    EXPECT_TRUE(storage.Get("KEY", hash, value, info));
+    EXPECT_EQ("0", value);
+    EXPECT_EQ(Storage::CasStatus::kExists, storage.CompareAndSwap("KEY", hash, "1", ItemInfo(), info.cas + 1));
+    EXPECT_EQ(Storage::CasStatus::kStored, storage.CompareAndSwap("KEY", hash, "1", ItemInfo(), info.cas));
+    EXPECT_EQ(Storage::CasStatus::kExists, storage.CompareAndSwap("KEY", hash, "2", ItemInfo(), info.cas));
+    EXPECT_EQ(Storage::CasStatus::kNotFound, storage.CompareAndSwap("NONE", KeyHash::Of("NONE"), "2", ItemInfo(), 1));
+
+    EXPECT_TRUE(storage.Put("TEXT", "abc"));
+    EXPECT_EQ(Storage::CounterStatus::kNotNumber, storage.Increment("TEXT", KeyHash::Of("TEXT"), 1, false, result));
+}
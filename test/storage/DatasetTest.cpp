@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <unistd.h>
+
+#include "storage/DatasetBuilder.h"
+#include "storage/DatasetStorage.h"
+#include "storage/MappedDataset.h"
+
+using namespace Afina::Backend;
+
+static std::string DatasetPath(const std::string &name) {
+    return "/tmp/afina-test-" + name + "-" + std::to_string(getpid());
+}
+
+TEST(DatasetTest, BuildAndGet) {
+    std::string path = DatasetPath("get");
+
+    DatasetBuilder builder;
+    for (int i = 0; i < 10000; i++) {
+        builder.Add("KEY" + std::to_string(i), "val" + std::to_string(i));
+    }
+    builder.Add("empty", "");
+    builder.Add("KEY0", "replaced");
+    builder.Write(path);
+
+    MappedDataset dataset(path);
+    EXPECT_EQ(10001, dataset.count());
+
+    std::string value;
+    EXPECT_TRUE(dataset.Get("KEY0", value));
+    EXPECT_EQ("replaced", value);
+    for (int i = 1; i < 10000; i++) {
+        ASSERT_TRUE(dataset.Get("KEY" + std::to_string(i), value));
+        EXPECT_EQ("val" + std::to_string(i), value);
+    }
+    EXPECT_TRUE(dataset.Get("empty", value));
+    EXPECT_EQ("", value);
+
+    for (int i = 10000; i < 11000; i++) {
+        EXPECT_FALSE(dataset.Get("KEY" + std::to_string(i), value));
+    }
+    unlink(path.c_str());
+}
+
+TEST(DatasetTest, RejectsBroken) {
+    std::string path = DatasetPath("broken");
+    {
+        std::ofstream out(path);
+        out << "definitely not a dataset, but long enough to have a header in it, isn't it?";
+    }
+    EXPECT_THROW(MappedDataset dataset(path), std::runtime_error);
+    unlink(path.c_str());
+}
+
+TEST(DatasetTest, StorageSwap) {
+    std::string path = DatasetPath("swap");
+
+    DatasetBuilder first;
+    first.Add("KEY1", "old");
+    first.Write(path);
+
+    DatasetStorage storage(path);
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("old", value);
+    EXPECT_FALSE(storage.Put("KEY1", "new"));
+    EXPECT_FALSE(storage.Reload());
+
+    DatasetBuilder second;
+    second.Add("KEY1", "new");
+    second.Add("KEY2", "val2");
+    second.Write(path);
+
+    EXPECT_TRUE(storage.Reload());
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("new", value);
+    EXPECT_TRUE(storage.Get("KEY2", value));
+
+    // Broken file doesn't replace dataset in use
+    {
+        std::ofstream out(path + ".tmp");
+        out << "broken";
+    }
+    rename((path + ".tmp").c_str(), path.c_str());
+    EXPECT_THROW(storage.Reload(), std::runtime_error);
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ("val2", value);
+
+    unlink(path.c_str());
+}
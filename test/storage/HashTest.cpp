@@ -0,0 +1,79 @@
+#include "gtest/gtest.h"
+#include <set>
+#include <string>
+
+#include <afina/Hash.h>
+
+using namespace Afina;
+
+// Reference SipHash-1-3 with key 00 01 .. 0f over message 00 01 .. len-1
+TEST(HashTest, KnownAnswers) {
+    const HashSeed seed = {0x0706050403020100ULL, 0x0f0e0d0c0b0a0908ULL};
+    const struct {
+        size_t len;
+        uint64_t hash;
+    } vectors[] = {
+        {0, 0xabac0158050fc4dcULL},  {1, 0xc9f49bf37d57ca93ULL},  {7, 0xd3927d989bb11140ULL},
+        {8, 0x369095118d299a8eULL},  {15, 0xd320d86d2a519956ULL}, {16, 0xcc4fdd1a7d908b66ULL},
+        {63, 0x9d199062b7bbb3a8ULL},
+    };
+
+    std::string message;
+    for (int i = 0; i < 64; i++) {
+        message.push_back(char(i));
+    }
+
+    for (auto &v : vectors) {
+        KeyHash h(seed);
+        h.Update(message.data(), v.len);
+        EXPECT_EQ(v.hash, h.Digest()) << "length " << v.len;
+    }
+}
+
+// Hash must not depend on how key was splitted between Update calls
+TEST(HashTest, StreamingMatchesOneShot) {
+    const std::string key = "some key that is longer than several words";
+    const uint64_t expected = KeyHash::Of(key);
+
+    for (size_t split = 0; split <= key.size(); split++) {
+        KeyHash h;
+        h.Update(key.data(), split);
+        h.Update(key.data() + split, key.size() - split);
+        EXPECT_EQ(expected, h.Digest());
+    }
+
+    KeyHash h;
+    for (char c : key) {
+        h.Update(c);
+    }
+    EXPECT_EQ(expected, h.Digest());
+}
+
+TEST(HashTest, ResetReusesInstance) {
+    KeyHash h;
+    h.Update("first", 5);
+    h.Reset();
+    h.Update("second", 6);
+    EXPECT_EQ(KeyHash::Of("second"), h.Digest());
+}
+
+TEST(HashTest, LengthMatters) {
+    EXPECT_NE(KeyHash::Of(std::string("")), KeyHash::Of(std::string(1, '\0')));
+    EXPECT_NE(KeyHash::Of(std::string(7, '\0')), KeyHash::Of(std::string(8, '\0')));
+}
+
+// The same key must hash differently under different seeds
+TEST(HashTest, SeedMatters) {
+    HashSeed a = {1, 2}, b = {1, 3};
+    std::set<uint64_t> different;
+    for (int i = 0; i < 100; i++) {
+        std::string key = "key" + std::to_string(i);
+
+        KeyHash ha(a), hb(b);
+        ha.Update(key.data(), key.size());
+        hb.Update(key.data(), key.size());
+        EXPECT_NE(ha.Digest(), hb.Digest());
+        different.insert(ha.Digest());
+    }
+    EXPECT_EQ(100, different.size());
+}
@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <afina/Hash.h>
+
+#include "storage/Keyspaces.h"
+#include "storage/SimpleLRU.h"
+#include "storage/StripedLRU.h"
+
+using namespace Afina;
+using namespace Afina::Backend;
+
+TEST(KeyspacesTest, RoutesByPrefix) {
+    auto fallback = std::make_shared<SimpleLRU>(1024);
+    auto users = std::make_shared<SimpleLRU>(1024);
+    Keyspaces storage(fallback);
+    storage.Add("users", users);
+
+    EXPECT_TRUE(storage.Put("users:1", "alice"));
+    EXPECT_TRUE(storage.Put("user:1", "bob"));
+    EXPECT_TRUE(storage.Put("plain", "carol"));
+
+    std::string value;
+    EXPECT_TRUE(users->Get("users:1", value));
+    EXPECT_EQ("alice", value);
+    EXPECT_FALSE(fallback->Get("users:1", value));
+    EXPECT_TRUE(fallback->Get("user:1", value));
+    EXPECT_TRUE(fallback->Get("plain", value));
+
+    EXPECT_TRUE(storage.Get("users:1", value));
+    EXPECT_EQ("alice", value);
+    EXPECT_TRUE(storage.Delete("users:1"));
+    EXPECT_FALSE(users->Get("users:1", value));
+
+    EXPECT_THROW(storage.Add("users", users), std::runtime_error);
+    EXPECT_THROW(storage.Add("a:b", users), std::runtime_error);
+}
+
+TEST(KeyspacesTest, NoisyTenantIsolated) {
+    Keyspaces storage(std::make_shared<SimpleLRU>(1024));
+    storage.Add("hot", std::make_shared<SimpleLRU>(1024));
+    storage.Add("bulk", std::make_shared<StripedLRU>(1024, 2));
+
+    for (int i = 0; i < 10; i++) {
+        storage.Put("hot:" + std::to_string(i), "value");
+    }
+
+    // Bulk load is many times the quota of its keyspace
+    for (int i = 0; i < 1000; i++) {
+        storage.Put("bulk:" + std::to_string(i), "some bulk value");
+    }
+
+    std::string value;
+    for (int i = 0; i < 10; i++) {
+        EXPECT_TRUE(storage.Get("hot:" + std::to_string(i), value));
+    }
+    EXPECT_FALSE(storage.Get("bulk:0", value));
+    EXPECT_TRUE(storage.Get("bulk:999", value));
+
+    std::vector<std::pair<std::string, std::string>> stats;
+    storage.GetStats(stats);
+    bool found = false;
+    for (auto &stat : stats) {
+        if (stat.first == "keyspace:hot:curr_items") {
+            EXPECT_EQ("10", stat.second);
+            found = true;
+        }
+    }
+    EXPECT_TRUE(found);
+}
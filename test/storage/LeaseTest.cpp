@@ -0,0 +1,163 @@
+#include "gtest/gtest.h"
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <afina/Hash.h>
+
+#include "storage/SimpleLRU.h"
+
+using namespace Afina;
+using namespace Afina::Backend;
+
+TEST(LeaseTest, FirstMissGetsLease) {
+    SimpleLRU storage;
+    uint64_t hash = KeyHash::Of("KEY1");
+
+    std::string value;
+    ItemInfo info;
+    uint64_t token = 0, other = 0;
+    ASSERT_EQ(Storage::LeaseStatus::kGranted, storage.GetLeased("KEY1", hash, value, info, token));
+    EXPECT_NE(0, token);
+
+    // Everybody else has to wait
+    EXPECT_EQ(Storage::LeaseStatus::kHotMiss, storage.GetLeased("KEY1", hash, value, info, other));
+    EXPECT_FALSE(storage.PutLeased("KEY1", hash, "val0", ItemInfo(), token + 1));
+
+    EXPECT_TRUE(storage.PutLeased("KEY1", hash, "val1", ItemInfo(), token));
+    EXPECT_EQ(Storage::LeaseStatus::kHit, storage.GetLeased("KEY1", hash, value, info, other));
+    EXPECT_EQ("val1", value);
+
+    // Lease is single use
+    EXPECT_FALSE(storage.PutLeased("KEY1", hash, "val2", ItemInfo(), token));
+}
+
+TEST(LeaseTest, WriteRevokesLease) {
+    SimpleLRU storage;
+    uint64_t hash = KeyHash::Of("KEY1");
+
+    std::string value;
+    ItemInfo info;
+    uint64_t token = 0;
+    ASSERT_EQ(Storage::LeaseStatus::kGranted, storage.GetLeased("KEY1", hash, value, info, token));
+
+    storage.Put("KEY1", "fresh");
+    storage.Delete("KEY1");
+
+    // Value loaded before write is stale and must be rejected
+    EXPECT_FALSE(storage.PutLeased("KEY1", hash, "old", ItemInfo(), token));
+}
+
+TEST(LeaseTest, StaleValueAfterDelete) {
+    SimpleLRU storage;
+    uint64_t hash = KeyHash::Of("KEY1");
+
+    storage.Put("KEY1", "val1");
+    storage.Delete("KEY1");
+
+    std::string value;
+    ItemInfo info;
+    uint64_t token = 0, other = 0;
+    ASSERT_EQ(Storage::LeaseStatus::kGranted, storage.GetLeased("KEY1", hash, value, info, token));
+    ASSERT_EQ(Storage::LeaseStatus::kStale, storage.GetLeased("KEY1", hash, value, info, other));
+    EXPECT_EQ("val1", value);
+
+    EXPECT_TRUE(storage.PutLeased("KEY1", hash, "val2", ItemInfo(), token));
+    ASSERT_EQ(Storage::LeaseStatus::kHit, storage.GetLeased("KEY1", hash, value, info, other));
+    EXPECT_EQ("val2", value);
+}
+
+TEST(LeaseTest, LeaseExpires) {
+    SimpleLRU storage(1024, 20, 20);
+    uint64_t hash = KeyHash::Of("KEY1");
+
+    std::string value;
+    ItemInfo info;
+    uint64_t token = 0, next = 0;
+    ASSERT_EQ(Storage::LeaseStatus::kGranted, storage.GetLeased("KEY1", hash, value, info, token));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+
+    // Lease holder is gone, next one gets its own lease
+    ASSERT_EQ(Storage::LeaseStatus::kGranted, storage.GetLeased("KEY1", hash, value, info, next));
+    EXPECT_NE(token, next);
+    EXPECT_FALSE(storage.PutLeased("KEY1", hash, "val1", ItemInfo(), token));
+    EXPECT_TRUE(storage.PutLeased("KEY1", hash, "val1", ItemInfo(), next));
+}
+
+TEST(LeaseTest, SoftExpiredServedStale) {
+    SimpleLRU storage;
+    uint64_t hash = KeyHash::Of("KEY1");
+
+    ItemInfo info;
+    info.soft_expire = ItemInfo::Now() - 1;
+    storage.Put("KEY1", hash, "val1", info);
+
+    // Everybody gets value, only the first one is asked to refresh it
+    std::string value;
+    uint64_t token = 0, other = 0;
+    ASSERT_EQ(Storage::LeaseStatus::kRefresh, storage.GetLeased("KEY1", hash, value, info, token));
+    EXPECT_EQ("val1", value);
+    EXPECT_NE(0, token);
+
+    value.clear();
+    ASSERT_EQ(Storage::LeaseStatus::kStale, storage.GetLeased("KEY1", hash, value, info, other));
+    EXPECT_EQ("val1", value);
+
+    // Plain get doesn't care about soft TTL
+    EXPECT_TRUE(storage.Get("KEY1", hash, value));
+
+    EXPECT_TRUE(storage.PutLeased("KEY1", hash, "val2", ItemInfo(), token));
+    ASSERT_EQ(Storage::LeaseStatus::kHit, storage.GetLeased("KEY1", hash, value, info, other));
+    EXPECT_EQ("val2", value);
+}
+
+// Keys sharing hash have separate leases and stale values
+TEST(LeaseTest, CollidingKeysDontShareLeases) {
+    SimpleLRU storage;
+    const uint64_t hash = 42;
+
+    storage.Put("KEY1", hash, "val1", ItemInfo());
+    storage.Delete("KEY1", hash);
+
+    std::string value;
+    ItemInfo info;
+    uint64_t token1 = 0, token2 = 0, other = 0;
+    ASSERT_EQ(Storage::LeaseStatus::kGranted, storage.GetLeased("KEY1", hash, value, info, token1));
+    ASSERT_EQ(Storage::LeaseStatus::kGranted, storage.GetLeased("KEY2", hash, value, info, token2));
+
+    // Stale value of KEY1 is never served for KEY2
+    value.clear();
+    EXPECT_EQ(Storage::LeaseStatus::kHotMiss, storage.GetLeased("KEY2", hash, value, info, other));
+    EXPECT_EQ("", value);
+    EXPECT_EQ(Storage::LeaseStatus::kStale, storage.GetLeased("KEY1", hash, value, info, other));
+    EXPECT_EQ("val1", value);
+
+    // Write of KEY2 doesn't revoke lease on KEY1
+    storage.Put("KEY2", hash, "val2", ItemInfo());
+    EXPECT_FALSE(storage.PutLeased("KEY2", hash, "old", ItemInfo(), token2));
+    EXPECT_TRUE(storage.PutLeased("KEY1", hash, "new", ItemInfo(), token1));
+}
+
+TEST(LeaseTest, FlagsAreReturned) {
+    SimpleLRU storage;
+    uint64_t hash = KeyHash::Of("KEY1");
+
+    ItemInfo info;
+    info.flags = 42;
+    storage.Put("KEY1", hash, "val1", info);
+
+    std::string value;
+    uint64_t token = 0, other = 0;
+    ItemInfo got;
+    ASSERT_EQ(Storage::LeaseStatus::kHit, storage.GetLeased("KEY1", hash, value, got, token));
+    EXPECT_EQ(42, got.flags);
+
+    // Value retired by delete keeps its flags too
+    storage.Delete("KEY1");
+    ASSERT_EQ(Storage::LeaseStatus::kGranted, storage.GetLeased("KEY1", hash, value, got, token));
+    got = ItemInfo();
+    ASSERT_EQ(Storage::LeaseStatus::kStale, storage.GetLeased("KEY1", hash, value, got, other));
+    EXPECT_EQ("val1", value);
+    EXPECT_EQ(42, got.flags);
+}
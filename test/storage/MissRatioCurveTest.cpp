@@ -0,0 +1,146 @@
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <afina/Hash.h>
+
+#include "storage/MissRatioCurve.h"
+#include "storage/MissRatioSampler.h"
+#include "storage/SimpleLRU.h"
+
+using namespace Afina;
+using namespace Afina::Backend;
+
+// Returns estimated hit ratio of the cache of given size
+static double HitRatio(const std::vector<std::pair<uint64_t, double>> &curve, uint64_t size) {
+    double ratio = 0;
+    for (auto &point : curve) {
+        if (point.first <= size) {
+            ratio = point.second;
+        }
+    }
+    return ratio;
+}
+
+// Fixed key hash, so that the same keys are sampled on every run unlike with seeded KeyHash
+static uint64_t Mix(uint64_t key) {
+    key += 0x9e3779b97f4a7c15ULL;
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    return key ^ (key >> 31);
+}
+
+TEST(MissRatioCurveTest, CyclicScanExact) {
+    // Every key is sampled, 100 keys of 10 bytes are read in a loop: LRU of 1000+ bytes hits all but the
+    // first round, smaller one never hits
+    MissRatioCurve curve(1.0);
+    for (int round = 0; round < 10; round++) {
+        for (uint64_t key = 1; key <= 100; key++) {
+            curve.Reference(key << 8, 10);
+        }
+    }
+
+    std::vector<std::pair<uint64_t, double>> points;
+    EXPECT_EQ(1000, curve.Curve(points));
+    EXPECT_DOUBLE_EQ(0.0, HitRatio(points, 512));
+    EXPECT_DOUBLE_EQ(0.9, HitRatio(points, 1024));
+}
+
+TEST(MissRatioCurveTest, SampledEstimate) {
+    // Skewed workload over 100000 keys, sampled at 5%: estimate has to match the exact curve closely
+    std::mt19937_64 rng(42);
+    std::vector<double> cdf;
+    double sum = 0;
+    for (int i = 1; i <= 100000; i++) {
+        sum += 1.0 / std::pow(i, 0.6);
+        cdf.push_back(sum);
+    }
+
+    MissRatioCurve exact(1.0, 1 << 20), sampled(0.05);
+    for (int i = 0; i < 400000; i++) {
+        double x = std::uniform_real_distribution<double>(0, sum)(rng);
+        uint64_t key = std::lower_bound(cdf.begin(), cdf.end(), x) - cdf.begin();
+        uint64_t hash = Mix(key);
+        exact.Reference(hash, 100);
+        if (sampled.Sampled(hash)) {
+            sampled.Reference(hash, 100);
+        }
+    }
+
+    std::vector<std::pair<uint64_t, double>> exact_points, sampled_points;
+    exact.Curve(exact_points);
+    sampled.Curve(sampled_points);
+    for (uint64_t size = 1 << 16; size <= (1 << 24); size <<= 1) {
+        EXPECT_NEAR(HitRatio(exact_points, size), HitRatio(sampled_points, size), 0.05) << size;
+    }
+}
+
+TEST(MissRatioCurveTest, BoundedTracking) {
+    MissRatioCurve curve(1.0, 1000);
+    for (uint64_t key = 1; key <= 100000; key++) {
+        curve.Reference(key << 8, 10);
+    }
+    EXPECT_LT(curve.rate(), 0.05);
+}
+
+TEST(MissRatioCurveTest, SamplerStats) {
+    MissRatioSampler storage(std::make_shared<SimpleLRU>(1 << 20), 1.0);
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 50; i++) {
+            std::string key = "KEY" + std::to_string(i), value;
+            if (!storage.Get(key, value)) {
+                storage.Put(key, "value");
+            }
+        }
+    }
+
+    std::vector<std::pair<std::string, std::string>> stats;
+    storage.GetStats(stats);
+    bool references = false, ratio = false;
+    for (auto &stat : stats) {
+        if (stat.first == "mrc_references") {
+            EXPECT_EQ("150", stat.second);
+            references = true;
+        } else if (stat.first.compare(0, 14, "mrc_hit_ratio:") == 0) {
+            ratio = true;
+        }
+    }
+    EXPECT_TRUE(references);
+    EXPECT_TRUE(ratio);
+}
+
+// Block rendered for the client and the plain read measure the item the same way, by key and value only
+TEST(MissRatioCurveTest, SamplerItemSize) {
+    for (bool rendered : {false, true}) {
+        MissRatioSampler storage(std::make_shared<SimpleLRU>(1 << 20), 1.0);
+        for (int round = 0; round < 10; round++) {
+            // 64 items of 16 bytes fit into 1024 bytes exactly
+            for (int i = 10; i < 74; i++) {
+                std::string key = "KEY" + std::to_string(i), value = "abcdefghijk", out;
+                if (round == 0) {
+                    storage.Put(key, value);
+                } else if (rendered) {
+                    EXPECT_TRUE(storage.AppendValue(key, KeyHash::Of(key), out, true));
+                } else {
+                    EXPECT_TRUE(storage.Get(key, value));
+                }
+            }
+        }
+
+        std::vector<std::pair<std::string, std::string>> stats;
+        storage.GetStats(stats);
+        std::string ratio;
+        for (auto &stat : stats) {
+            if (stat.first == "mrc_hit_ratio:1024") {
+                ratio = stat.second;
+            }
+        }
+        EXPECT_EQ("1.0000", ratio.substr(0, 6)) << rendered;
+    }
+}
@@ -0,0 +1,237 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <afina/Loader.h>
+
+#include "storage/ProcessLoader.h"
+#include "storage/ReadThrough.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+using namespace Afina;
+using namespace Afina::Backend;
+
+namespace {
+
+// Loader that knows keys starting with "db:" and blocks until released
+class FakeLoader : public Afina::Loader {
+public:
+    FakeLoader(bool blocked = false) : released(!blocked), calls(0) {}
+
+    bool Load(const std::string &key, std::string &value) override {
+        calls++;
+        while (!released.load()) {
+            std::this_thread::yield();
+        }
+        if (key.compare(0, 3, "db:") != 0) {
+            return false;
+        }
+        value = "loaded " + key;
+        return true;
+    }
+
+    std::atomic<bool> released;
+    std::atomic<int> calls;
+};
+
+// Loader that fails first call with something that isn't std::exception
+class ThrowingLoader : public FakeLoader {
+public:
+    bool Load(const std::string &key, std::string &value) override {
+        if (calls.load() == 0) {
+            calls++;
+            throw 42;
+        }
+        return FakeLoader::Load(key, value);
+    }
+};
+
+// Storage that can't cache anything
+class FullStorage : public ThreadSafeSimplLRU {
+public:
+    using ThreadSafeSimplLRU::PutIfAbsent;
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, const ItemInfo &info) override {
+        throw std::bad_alloc();
+    }
+};
+
+std::string GetStat(const Storage &storage, const std::string &name) {
+    std::vector<std::pair<std::string, std::string>> stats;
+    storage.GetStats(stats);
+    for (auto &stat : stats) {
+        if (stat.first == name) {
+            return stat.second;
+        }
+    }
+    return "";
+}
+
+} // namespace
+
+TEST(ReadThroughTest, LoadOnMiss) {
+    auto loader = std::make_shared<FakeLoader>();
+    ReadThrough storage(std::make_shared<ThreadSafeSimplLRU>(), loader);
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("db:key", value));
+    EXPECT_EQ("loaded db:key", value);
+
+    // Second time value comes from cache
+    EXPECT_TRUE(storage.Get("db:key", value));
+    EXPECT_EQ(1, loader->calls.load());
+
+    EXPECT_FALSE(storage.Get("other", value));
+    EXPECT_EQ("1", GetStat(storage, "loader_misses"));
+}
+
+TEST(ReadThroughTest, CachedValueWins) {
+    auto loader = std::make_shared<FakeLoader>();
+    ReadThrough storage(std::make_shared<ThreadSafeSimplLRU>(), loader);
+
+    storage.Put("db:key", "cached");
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("db:key", value));
+    EXPECT_EQ("cached", value);
+    EXPECT_EQ(0, loader->calls.load());
+}
+
+TEST(ReadThroughTest, CoalesceConcurrentMisses) {
+    const int n_threads = 8;
+    auto loader = std::make_shared<FakeLoader>(true);
+    ReadThrough storage(std::make_shared<ThreadSafeSimplLRU>(), loader);
+
+    std::vector<std::string> results(n_threads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < n_threads; i++) {
+        threads.emplace_back([&storage, &results, i] { storage.Get("db:hot", results[i]); });
+    }
+
+    // All but one must be waiting for the first loader call to finish
+    while (GetStat(storage, "loader_coalesced") != std::to_string(n_threads - 1)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    loader->released.store(true);
+
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(1, loader->calls.load());
+    for (auto &result : results) {
+        EXPECT_EQ("loaded db:hot", result);
+    }
+    EXPECT_EQ("0.8750", GetStat(storage, "loader_coalescing_ratio"));
+}
+
+// Keys sharing hash must not wait for each other nor share loader call
+TEST(ReadThroughTest, CollidingKeysLoadSeparately) {
+    auto loader = std::make_shared<FakeLoader>(true);
+    ReadThrough storage(std::make_shared<ThreadSafeSimplLRU>(), loader);
+
+    std::string a, b;
+    std::thread ta([&storage, &a] { storage.Get("db:a", 42, a); });
+    std::thread tb([&storage, &b] { storage.Get("db:b", 42, b); });
+    while (loader->calls.load() != 2) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    loader->released.store(true);
+    ta.join();
+    tb.join();
+
+    EXPECT_EQ("loaded db:a", a);
+    EXPECT_EQ("loaded db:b", b);
+    EXPECT_EQ("0", GetStat(storage, "loader_coalesced"));
+}
+
+TEST(ReadThroughTest, WaitersGiveUpAfterTimeout) {
+    auto loader = std::make_shared<FakeLoader>(true);
+    ReadThrough storage(std::make_shared<ThreadSafeSimplLRU>(), loader, std::chrono::milliseconds(20));
+
+    std::string owner_value;
+    std::thread owner([&storage, &owner_value] { storage.Get("db:slow", owner_value); });
+    while (loader->calls.load() != 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("db:slow", value));
+    EXPECT_EQ("1", GetStat(storage, "loader_wait_timeouts"));
+
+    loader->released.store(true);
+    owner.join();
+    EXPECT_EQ("loaded db:slow", owner_value);
+}
+
+// Write that lands during load must not be overwritten or undone by the loaded value
+TEST(ReadThroughTest, WriteCancelsLoad) {
+    auto backend = std::make_shared<ThreadSafeSimplLRU>();
+    for (int deleted = 0; deleted < 2; deleted++) {
+        auto loader = std::make_shared<FakeLoader>(true);
+        ReadThrough storage(backend, loader);
+        backend->Delete("db:key");
+
+        std::string loaded;
+        std::thread reader([&storage, &loaded] { storage.Get("db:key", loaded); });
+        while (loader->calls.load() != 1) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        storage.Put("db:key", "written");
+        if (deleted) {
+            storage.Delete("db:key");
+        }
+        loader->released.store(true);
+        reader.join();
+        EXPECT_EQ("loaded db:key", loaded);
+
+        std::string value;
+        if (deleted) {
+            EXPECT_FALSE(backend->Get("db:key", value));
+        } else {
+            EXPECT_TRUE(backend->Get("db:key", value));
+            EXPECT_EQ("written", value);
+        }
+    }
+}
+
+// Failed load must not leave the key with a load nobody finishes, or next misses would wait for it
+TEST(ReadThroughTest, FailedLoadReleasesKey) {
+    auto loader = std::make_shared<ThrowingLoader>();
+    ReadThrough storage(std::make_shared<ThreadSafeSimplLRU>(), loader);
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("db:key", value));
+    EXPECT_EQ("1", GetStat(storage, "loader_errors"));
+
+    EXPECT_TRUE(storage.Get("db:key", value));
+    EXPECT_EQ("loaded db:key", value);
+    EXPECT_EQ("0", GetStat(storage, "loader_coalesced"));
+
+    auto full = std::make_shared<FakeLoader>();
+    ReadThrough uncached(std::make_shared<FullStorage>(), full);
+    for (int i = 0; i < 2; i++) {
+        EXPECT_THROW(uncached.Get("db:key", value), std::bad_alloc);
+    }
+    EXPECT_EQ(2, full->calls.load());
+    EXPECT_EQ("0", GetStat(uncached, "loader_coalesced"));
+}
+
+// Program gets key as argument, so `sleep 10` hangs for 10 seconds
+TEST(ReadThroughTest, HungProgramIsKilled) {
+    ProcessLoader loader("sleep", std::chrono::milliseconds(50));
+
+    auto start = std::chrono::steady_clock::now();
+    std::string value;
+    EXPECT_THROW(loader.Load("10", value), std::runtime_error);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+
+    ProcessLoader echo("echo");
+    EXPECT_TRUE(echo.Load("value", value));
+    EXPECT_EQ("value\n", value);
+}
@@ -0,0 +1,222 @@
+#include "gtest/gtest.h"
+#include <cstdlib>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <afina/Hash.h>
+
+#include "storage/SharedLRU.h"
+
+using namespace Afina;
+using namespace Afina::Backend;
+
+static const size_t kSegmentSize = 4 * 1024 * 1024;
+
+static std::string SegmentPath(const std::string &name) {
+    return "/tmp/afina-test-" + name + "-" + std::to_string(getpid());
+}
+
+TEST(SharedLRUTest, PutGet) {
+    std::string path = SegmentPath("putget");
+    {
+        SharedLRU storage(path, kSegmentSize);
+        EXPECT_EQ(SharedLRU::Attach::kCreated, storage.attach());
+
+        EXPECT_TRUE(storage.Put("KEY1", "val1"));
+        EXPECT_TRUE(storage.Put("KEY2", "val2"));
+        EXPECT_FALSE(storage.PutIfAbsent("KEY1", "other"));
+        EXPECT_TRUE(storage.Set("KEY2", "val22"));
+        EXPECT_FALSE(storage.Set("KEY3", "val3"));
+
+        std::string value;
+        EXPECT_TRUE(storage.Get("KEY1", value));
+        EXPECT_EQ("val1", value);
+        EXPECT_TRUE(storage.Get("KEY2", value));
+        EXPECT_EQ("val22", value);
+
+        EXPECT_TRUE(storage.Delete("KEY1"));
+        EXPECT_FALSE(storage.Get("KEY1", value));
+        EXPECT_FALSE(storage.Delete("KEY1"));
+    }
+    unlink(path.c_str());
+}
+
+TEST(SharedLRUTest, Evicts) {
+    std::string path = SegmentPath("evicts");
+    {
+        SharedLRU storage(path, kSegmentSize);
+        std::string value(1000, 'x');
+        for (int i = 0; i < 10000; i++) {
+            EXPECT_TRUE(storage.Put("KEY" + std::to_string(i), value));
+        }
+
+        std::string res;
+        EXPECT_FALSE(storage.Get("KEY0", res));
+        EXPECT_TRUE(storage.Get("KEY9999", res));
+        EXPECT_EQ(value, res);
+    }
+    unlink(path.c_str());
+}
+
+TEST(SharedLRUTest, ReattachClean) {
+    std::string path = SegmentPath("clean");
+    {
+        SharedLRU storage(path, kSegmentSize);
+        for (int i = 0; i < 100; i++) {
+            storage.Put("KEY" + std::to_string(i), "val" + std::to_string(i));
+        }
+    }
+    {
+        SharedLRU storage(path, kSegmentSize);
+        EXPECT_EQ(SharedLRU::Attach::kClean, storage.attach());
+        for (int i = 0; i < 100; i++) {
+            std::string value;
+            EXPECT_TRUE(storage.Get("KEY" + std::to_string(i), value));
+            EXPECT_EQ("val" + std::to_string(i), value);
+        }
+    }
+    unlink(path.c_str());
+}
+
+TEST(SharedLRUTest, RecoverAfterCrash) {
+    std::string path = SegmentPath("crash");
+
+    // Child dies without any cleanup, segment is left dirty
+    pid_t pid = fork();
+    ASSERT_NE(-1, pid);
+    if (pid == 0) {
+        SharedLRU *storage = new SharedLRU(path, kSegmentSize);
+        for (int i = 0; i < 100; i++) {
+            storage->Put("KEY" + std::to_string(i), "val" + std::to_string(i));
+        }
+        storage->Delete("KEY0");
+        _exit(0);
+    }
+    int status;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    ASSERT_TRUE(WIFEXITED(status));
+
+    {
+        SharedLRU storage(path, kSegmentSize);
+        EXPECT_EQ(SharedLRU::Attach::kRecovered, storage.attach());
+
+        std::string value;
+        EXPECT_FALSE(storage.Get("KEY0", value));
+        for (int i = 1; i < 100; i++) {
+            EXPECT_TRUE(storage.Get("KEY" + std::to_string(i), value));
+            EXPECT_EQ("val" + std::to_string(i), value);
+        }
+
+        // Freed chunks are reused
+        EXPECT_TRUE(storage.Put("KEY0", "new"));
+        EXPECT_TRUE(storage.Get("KEY0", value));
+        EXPECT_EQ("new", value);
+    }
+    unlink(path.c_str());
+}
+
+// Runs in a separate process started by ReindexForeignSeed, does nothing otherwise
+TEST(SharedLRUTest, FillForeignSegment) {
+    const char *path = std::getenv("AFINA_TEST_SEGMENT");
+    if (path == nullptr) {
+        return;
+    }
+
+    SharedLRU storage(path, kSegmentSize);
+    for (int i = 0; i < 100; i++) {
+        storage.Put("KEY" + std::to_string(i), "val" + std::to_string(i));
+    }
+}
+
+// Segment written by the process with another hash seed is indexed again with the seed of this one
+TEST(SharedLRUTest, ReindexForeignSeed) {
+    std::string path = SegmentPath("seed");
+
+    pid_t pid = fork();
+    ASSERT_NE(-1, pid);
+    if (pid == 0) {
+        setenv("AFINA_TEST_SEGMENT", path.c_str(), 1);
+        execl("/proc/self/exe", "runStorageTests", "--gtest_filter=SharedLRUTest.FillForeignSegment", nullptr);
+        _exit(1);
+    }
+    int status;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(0, WEXITSTATUS(status));
+
+    for (int attach = 0; attach < 2; attach++) {
+        SharedLRU storage(path, kSegmentSize);
+        EXPECT_EQ(SharedLRU::Attach::kClean, storage.attach());
+        for (int i = 0; i < 100; i++) {
+            std::string key = "KEY" + std::to_string(i), value;
+            EXPECT_TRUE(storage.Get(key, KeyHash::Of(key), value));
+            EXPECT_EQ("val" + std::to_string(i), value);
+        }
+        EXPECT_TRUE(storage.Put("KEY100", "val100"));
+    }
+    unlink(path.c_str());
+}
+
+TEST(SharedLRUTest, SingleOwner) {
+    std::string path = SegmentPath("owner");
+    {
+        SharedLRU storage(path, kSegmentSize);
+        EXPECT_THROW(SharedLRU(path, kSegmentSize), std::runtime_error);
+    }
+    unlink(path.c_str());
+}
+
+TEST(SharedLRUTest, Increment) {
+    std::string path = SegmentPath("incr");
+    {
+        SharedLRU storage(path, kSegmentSize);
+        ItemInfo info;
+        info.flags = 4;
+        storage.Put("KEY1", KeyHash::Of("KEY1"), "99", info);
+
+        uint64_t result;
+        EXPECT_EQ(Storage::CounterStatus::kOk, storage.Increment("KEY1", KeyHash::Of("KEY1"), 1, false, result));
+        EXPECT_EQ(100, result);
+
+        std::string value;
+        ItemInfo got;
+        EXPECT_TRUE(storage.Get("KEY1", KeyHash::Of("KEY1"), value, got));
+        EXPECT_EQ("100", value);
+        EXPECT_EQ(4, got.flags);
+
+        storage.Put("KEY2", "abc");
+        EXPECT_EQ(Storage::CounterStatus::kNotNumber, storage.Increment("KEY2", KeyHash::Of("KEY2"), 1, false, result));
+        EXPECT_EQ(Storage::CounterStatus::kNotFound, storage.Increment("KEY3", KeyHash::Of("KEY3"), 1, false, result));
+    }
+    unlink(path.c_str());
+}
+
+TEST(SharedLRUTest, CasSurvivesReattach) {
+    std::string path = SegmentPath("cas");
+    ItemInfo info;
+    {
+        SharedLRU storage(path, kSegmentSize);
+        storage.Put("KEY1", KeyHash::Of("KEY1"), "val1", ItemInfo());
+        std::string value;
+        EXPECT_TRUE(storage.Get("KEY1", KeyHash::Of("KEY1"), value, info));
+        EXPECT_NE(0, info.cas);
+    }
+    {
+        SharedLRU storage(path, kSegmentSize);
+        EXPECT_EQ(SharedLRU::Attach::kClean, storage.attach());
+        EXPECT_EQ(Storage::CasStatus::kExists,
+                  storage.CompareAndSwap("KEY1", KeyHash::Of("KEY1"), "val2", ItemInfo(), info.cas + 1));
+        EXPECT_EQ(Storage::CasStatus::kStored,
+                  storage.CompareAndSwap("KEY1", KeyHash::Of("KEY1"), "val2", ItemInfo(), info.cas));
+
+        // Versions keep growing after restart
+        std::string value;
+        ItemInfo got;
+        EXPECT_TRUE(storage.Get("KEY1", KeyHash::Of("KEY1"), value, got));
+        EXPECT_EQ("val2", value);
+        EXPECT_GT(got.cas, info.cas);
+    }
+    unlink(path.c_str());
+}
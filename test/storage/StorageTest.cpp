@@ -1,7 +1,11 @@
 #include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
 #include <iomanip>
 #include <iostream>
+#include <map>
 #include <set>
+#include <thread>
 #include <vector>
 
 #include <afina/execute/Add.h>
@@ -11,7 +15,9 @@
 #include <afina/execute/Set.h>
 
 #include "storage/SimpleLRU.h"
+#include "storage/StripedLRU.h"
 
+using namespace Afina;
 using namespace Afina::Backend;
 using namespace Afina::Execute;
 using namespace std;
@@ -52,6 +58,60 @@ TEST(StorageTest, PutIfAbsent) {
     EXPECT_TRUE(value == "val1");
 }
 
+TEST(StorageTest, PutIfAbsentNew) {
+    SimpleLRU storage;
+
+    EXPECT_TRUE(storage.PutIfAbsent("KEY1", "val1"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_TRUE(value == "val1");
+}
+
+TEST(StorageTest, DeleteThenPut) {
+    SimpleLRU storage;
+
+    storage.Put("KEY1", "val1");
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Delete("KEY1"));
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("KEY1", value));
+
+    storage.Put("KEY1", "val2");
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_TRUE(value == "val2");
+}
+
+TEST(StorageTest, HashedKey) {
+    SimpleLRU storage;
+    uint64_t hash = Afina::KeyHash::Of("KEY1");
+
+    storage.Put("KEY1", hash, "val1");
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_TRUE(value == "val1");
+
+    EXPECT_TRUE(storage.Set("KEY1", hash, "val2"));
+    EXPECT_TRUE(storage.Get("KEY1", hash, value));
+    EXPECT_TRUE(value == "val2");
+}
+
+TEST(StorageTest, StripedPutGet) {
+    StripedLRU storage(4 * 1024, 4);
+
+    for (int i = 0; i < 100; ++i) {
+        storage.Put("KEY" + std::to_string(i), "val" + std::to_string(i));
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        std::string value;
+        EXPECT_TRUE(storage.Get("KEY" + std::to_string(i), value));
+        EXPECT_TRUE(value == "val" + std::to_string(i));
+    }
+}
+
 std::string pad_space(const std::string &s, size_t length) {
     std::string result = s;
     result.resize(length, ' ');
@@ -108,3 +168,365 @@ TEST(StorageTest, MaxTest) {
         EXPECT_FALSE(storage.Get(key, res));
     }
 }
+
+TEST(StorageTest, ExpiredIsAbsent) {
+    SimpleLRU storage;
+    uint64_t hash = KeyHash::Of("KEY1");
+
+    ItemInfo info;
+    info.expire = ItemInfo::Deadline(-1);
+    EXPECT_TRUE(storage.Put("KEY1", hash, "val1", info));
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Set("KEY1", hash, "val2", ItemInfo()));
+    EXPECT_TRUE(storage.PutIfAbsent("KEY1", hash, "val3", ItemInfo()));
+
+    ItemInfo got;
+    EXPECT_TRUE(storage.Get("KEY1", hash, value, got));
+    EXPECT_EQ("val3", value);
+    EXPECT_EQ(0, got.expire);
+}
+
+TEST(StorageTest, SweepReclaimsExpired) {
+    SimpleLRU storage;
+
+    ItemInfo info;
+    info.expire = ItemInfo::Now() + 20;
+    for (int i = 0; i < 10; i++) {
+        std::string key = "KEY" + std::to_string(i);
+        storage.Put(key, KeyHash::Of(key), "val", i % 2 ? info : ItemInfo());
+    }
+
+    EXPECT_EQ(0, storage.Sweep(1024));
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    EXPECT_EQ(5, storage.Sweep(1024));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY0", value));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+}
+
+TEST(StorageTest, Increment) {
+    SimpleLRU storage;
+    uint64_t result;
+    EXPECT_EQ(Storage::CounterStatus::kNotFound, storage.Increment("KEY1", KeyHash::Of("KEY1"), 1, false, result));
+
+    ItemInfo info;
+    info.flags = 9;
+    storage.Put("KEY1", KeyHash::Of("KEY1"), "18446744073709551614", info);
+    EXPECT_EQ(Storage::CounterStatus::kOk, storage.Increment("KEY1", KeyHash::Of("KEY1"), 3, false, result));
+    EXPECT_EQ(1, result);
+    EXPECT_EQ(Storage::CounterStatus::kOk, storage.Increment("KEY1", KeyHash::Of("KEY1"), 5, true, result));
+    EXPECT_EQ(0, result);
+
+    std::string value;
+    ItemInfo got;
+    EXPECT_TRUE(storage.Get("KEY1", KeyHash::Of("KEY1"), value, got));
+    EXPECT_EQ("0", value);
+    EXPECT_EQ(9, got.flags);
+
+    storage.Put("KEY2", "12a");
+    EXPECT_EQ(Storage::CounterStatus::kNotNumber, storage.Increment("KEY2", KeyHash::Of("KEY2"), 1, false, result));
+    storage.Put("KEY2", "18446744073709551616");
+    EXPECT_EQ(Storage::CounterStatus::kNotNumber, storage.Increment("KEY2", KeyHash::Of("KEY2"), 1, false, result));
+}
+
+TEST(StorageTest, IncrementChangesLength) {
+    SimpleLRU storage;
+    const uint64_t hash = KeyHash::Of("KEY1");
+    storage.Put("KEY1", "100");
+
+    // Shorter digits keep header, size and version in sync
+    uint64_t result;
+    std::string out;
+    EXPECT_TRUE(storage.AppendValue("KEY1", hash, out, true));
+    EXPECT_EQ(Storage::CounterStatus::kOk, storage.Increment("KEY1", hash, 91, true, result));
+    EXPECT_EQ(9, result);
+    std::string shrunk;
+    EXPECT_TRUE(storage.AppendValue("KEY1", hash, shrunk, true));
+    EXPECT_EQ("VALUE KEY1 0 1 2\r\n9\r\n", shrunk);
+
+    std::vector<std::pair<std::string, std::string>> stats;
+    storage.GetStats(stats);
+    std::map<std::string, std::string> by_name(stats.begin(), stats.end());
+    EXPECT_EQ("5", by_name["bytes"]);
+
+    // Longer ones take the regular write
+    EXPECT_EQ(Storage::CounterStatus::kOk, storage.Increment("KEY1", hash, 991, false, result));
+    out.clear();
+    EXPECT_TRUE(storage.AppendValue("KEY1", hash, out, false));
+    EXPECT_EQ("VALUE KEY1 0 4\r\n1000\r\n", out);
+}
+
+// Counter that gets longer than the storage can take stays as it was
+TEST(StorageTest, IncrementDoesntFit) {
+    SimpleLRU storage(5);
+    const uint64_t hash = KeyHash::Of("KEY1");
+    EXPECT_TRUE(storage.Put("KEY1", "9"));
+
+    uint64_t result = 0;
+    EXPECT_EQ(Storage::CounterStatus::kNotStored, storage.Increment("KEY1", hash, 1, false, result));
+    EXPECT_EQ(0, result);
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("9", value);
+
+    EXPECT_EQ(Storage::CounterStatus::kOk, storage.Increment("KEY1", hash, 8, true, result));
+    EXPECT_EQ(1, result);
+}
+
+TEST(StorageTest, StripedHotCounter) {
+    StripedLRU storage(4 * 1024, 1);
+    const uint64_t hash = KeyHash::Of("HITS");
+    storage.Put("HITS", "0");
+
+    const int threads = 8, ops = 20000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&storage, hash]() {
+            uint64_t result;
+            for (int i = 0; i < ops; i++) {
+                ASSERT_EQ(Storage::CounterStatus::kOk, storage.Increment("HITS", hash, 1, false, result));
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    // Read folds all pending increments
+    std::string value;
+    EXPECT_TRUE(storage.Get("HITS", value));
+    EXPECT_EQ(std::to_string(threads * ops), value);
+
+    // Decrement and overwrite see the exact value
+    uint64_t result;
+    EXPECT_EQ(Storage::CounterStatus::kOk, storage.Increment("HITS", hash, 1, true, result));
+    EXPECT_EQ(uint64_t(threads * ops - 1), result);
+    storage.Put("HITS", "5");
+    EXPECT_EQ(Storage::CounterStatus::kOk, storage.Increment("HITS", hash, 1, false, result));
+    EXPECT_EQ(6, result);
+    EXPECT_TRUE(storage.Delete("HITS"));
+    EXPECT_EQ(Storage::CounterStatus::kNotFound, storage.Increment("HITS", hash, 1, false, result));
+}
+
+// Lets tests make counter hot without relying on lock contention
+class HotLRU : public ThreadSafeSimplLRU {
+public:
+    HotLRU(size_t max_size) : ThreadSafeSimplLRU(max_size) {}
+    using ThreadSafeSimplLRU::Promote;
+};
+
+TEST(StorageTest, HotCounterIsMonotonic) {
+    HotLRU storage(4 * 1024);
+    const uint64_t hash = KeyHash::Of("HITS");
+    storage.Put("HITS", "0");
+    ASSERT_TRUE(storage.Promote("HITS", hash));
+
+    // Call that starts after another one returned must see its increment
+    const int threads = 8, ops = 20000;
+    std::atomic<uint64_t> last(0);
+    std::atomic<bool> done(false);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&storage, &last, hash]() {
+            uint64_t result;
+            for (int i = 0; i < ops; i++) {
+                uint64_t before = last.load();
+                ASSERT_EQ(Storage::CounterStatus::kOk, storage.Increment("HITS", hash, 1, false, result));
+                ASSERT_GT(result, before);
+                uint64_t seen = last.load();
+                while (seen < result && !last.compare_exchange_weak(seen, result)) {
+                }
+            }
+        });
+    }
+
+    // Reads fold increments concurrently, stored value never goes backwards either
+    std::thread reader([&storage, &done]() {
+        uint64_t prev = 0;
+        std::string value;
+        while (!done.load()) {
+            ASSERT_TRUE(storage.Get("HITS", value));
+            uint64_t current = std::stoull(value);
+            ASSERT_GE(current, prev);
+            prev = current;
+        }
+    });
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    done = true;
+    reader.join();
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("HITS", value));
+    EXPECT_EQ(std::to_string(threads * ops), value);
+    EXPECT_EQ(uint64_t(threads * ops), last.load());
+}
+
+TEST(StorageTest, HotCounterFollowsKey) {
+    HotLRU storage(64);
+    uint64_t result;
+
+    // Expired
+    const uint64_t hash = KeyHash::Of("HITS");
+    ItemInfo info;
+    info.expire = ItemInfo::Now() + 50;
+    storage.Put("HITS", hash, "1", info);
+    ASSERT_TRUE(storage.Promote("HITS", hash));
+    EXPECT_EQ(Storage::CounterStatus::kOk, storage.Increment("HITS", hash, 1, false, result));
+    EXPECT_EQ(2, result);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(Storage::CounterStatus::kNotFound, storage.Increment("HITS", hash, 1, false, result));
+
+    // Evicted, pending increments go along with the key
+    storage.Put("HITS", "1");
+    ASSERT_TRUE(storage.Promote("HITS", hash));
+    EXPECT_EQ(Storage::CounterStatus::kOk, storage.Increment("HITS", hash, 1, false, result));
+    for (int i = 0; i < 10; i++) {
+        storage.Put("KEY" + std::to_string(i), "value");
+    }
+    std::string value;
+    EXPECT_FALSE(storage.Get("HITS", value));
+    EXPECT_EQ(Storage::CounterStatus::kNotFound, storage.Increment("HITS", hash, 1, false, result));
+
+    // Deleted, then written again starts from the new value
+    storage.Put("HITS", "1");
+    ASSERT_TRUE(storage.Promote("HITS", hash));
+    EXPECT_EQ(Storage::CounterStatus::kOk, storage.Increment("HITS", hash, 1, false, result));
+    EXPECT_TRUE(storage.Delete("HITS"));
+    EXPECT_EQ(Storage::CounterStatus::kNotFound, storage.Increment("HITS", hash, 1, false, result));
+    storage.Put("HITS", "10");
+    EXPECT_EQ(Storage::CounterStatus::kOk, storage.Increment("HITS", hash, 1, false, result));
+    EXPECT_EQ(11, result);
+
+    // Tagged counters are never kept outside
+    info = ItemInfo();
+    info.tags.push_back(KeyHash::Of("tag"));
+    storage.Put("HITS", hash, "1", info);
+    EXPECT_FALSE(storage.Promote("HITS", hash));
+}
+
+TEST(StorageTest, DeduplicatedValues) {
+    SimpleLRU storage(4 * 1024);
+    storage.Deduplicate(100);
+
+    // Ten copies of 1000 bytes fit into 4KB only when shared
+    std::string blob(1000, 'x');
+    for (int i = 0; i < 10; i++) {
+        EXPECT_TRUE(storage.Put("KEY" + std::to_string(i), blob));
+    }
+    storage.Put("SMALL", "small value");
+
+    std::string value;
+    for (int i = 0; i < 10; i++) {
+        EXPECT_TRUE(storage.Get("KEY" + std::to_string(i), value));
+        EXPECT_EQ(blob, value);
+    }
+
+    std::vector<std::pair<std::string, std::string>> stats;
+    storage.GetStats(stats);
+    std::map<std::string, std::string> by_name(stats.begin(), stats.end());
+    EXPECT_EQ("1", by_name["dedup_values"]);
+    EXPECT_EQ("9000", by_name["dedup_saved_bytes"]);
+    EXPECT_EQ(std::to_string(10 * 4 + 5 + 1000 + 11), by_name["bytes"]);
+
+    // Writes replace the reference only, other keys keep the old value
+    std::string other(1000, 'y');
+    EXPECT_TRUE(storage.Set("KEY0", other));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_TRUE(storage.Put("KEY1", value + "tail"));
+
+    EXPECT_TRUE(storage.Get("KEY0", value));
+    EXPECT_EQ(other, value);
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ(blob + "tail", value);
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ(blob, value);
+
+    // The last reference frees the value
+    for (int i = 2; i < 10; i++) {
+        EXPECT_TRUE(storage.Delete("KEY" + std::to_string(i)));
+    }
+    stats.clear();
+    storage.GetStats(stats);
+    by_name = std::map<std::string, std::string>(stats.begin(), stats.end());
+    EXPECT_EQ("2", by_name["dedup_values"]);
+    EXPECT_EQ("0", by_name["dedup_saved_bytes"]);
+    EXPECT_EQ(std::to_string(4 + 4 + 5 + 1000 + 1004 + 11), by_name["bytes"]);
+}
+
+TEST(StorageTest, DeduplicatedValueEvictsNothing) {
+    SimpleLRU storage(2100);
+    storage.Deduplicate(100);
+
+    std::string blob(1000, 'x'), other(1000, 'y');
+    EXPECT_TRUE(storage.Put("A", blob));
+    EXPECT_TRUE(storage.Put("B", other));
+    EXPECT_TRUE(storage.Put("S", "s"));
+
+    // Value already in the pool costs only the key, so both writes fit without eviction
+    EXPECT_TRUE(storage.Put("C", blob));
+    EXPECT_TRUE(storage.Set("S", blob));
+
+    std::string value;
+    for (const char *key : {"A", "B", "C", "S"}) {
+        EXPECT_TRUE(storage.Get(key, value)) << key;
+    }
+}
+
+TEST(StorageTest, TagInvalidation) {
+    SimpleLRU storage(4096);
+
+    ItemInfo user, both;
+    user.tags = {KeyHash::Of("user:1")};
+    both.tags = {KeyHash::Of("user:1"), KeyHash::Of("lang:ru")};
+    for (int i = 0; i < 10; i++) {
+        std::string key = "KEY" + std::to_string(i);
+        storage.Put(key, KeyHash::Of(key), "val", i % 3 == 0 ? ItemInfo() : (i % 3 == 1 ? user : both));
+    }
+
+    std::string value;
+    EXPECT_TRUE(storage.InvalidateTag(KeyHash::Of("lang:ru")));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Get("KEY2", value));
+    EXPECT_FALSE(storage.Set("KEY2", "new"));
+
+    // Items written after invalidation carry the tag just fine
+    EXPECT_TRUE(storage.PutIfAbsent("KEY2", KeyHash::Of("KEY2"), "new", both));
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ("new", value);
+
+    EXPECT_TRUE(storage.InvalidateTag(KeyHash::Of("user:1")));
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(i % 3 == 0, storage.Get("KEY" + std::to_string(i), value));
+    }
+
+    // Reads don't free invalidated items, sweep does
+    EXPECT_EQ(6, storage.Sweep(1024));
+    std::vector<std::pair<std::string, std::string>> stats;
+    storage.GetStats(stats);
+    EXPECT_EQ("curr_items", stats[0].first);
+    EXPECT_EQ("4", stats[0].second);
+}
+
+TEST(StorageTest, StripedTagInvalidation) {
+    StripedLRU storage(1024 * 1024, 8);
+
+    ItemInfo info;
+    info.tags = {KeyHash::Of("profile:42")};
+    for (int i = 0; i < 200; i++) {
+        std::string key = "derived:" + std::to_string(i);
+        ASSERT_TRUE(storage.Put(key, KeyHash::Of(key), "val", info));
+    }
+    storage.Put("other", "val");
+
+    EXPECT_TRUE(storage.InvalidateTag(KeyHash::Of("profile:42")));
+    std::string value;
+    for (int i = 0; i < 200; i++) {
+        EXPECT_FALSE(storage.Get("derived:" + std::to_string(i), value));
+    }
+    EXPECT_TRUE(storage.Get("other", value));
+}
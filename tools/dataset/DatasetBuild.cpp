@@ -0,0 +1,85 @@
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "storage/DatasetBuilder.h"
+
+using namespace Afina::Backend;
+
+namespace {
+
+// Reads the next "<key> <bytes>\n<data>\n" record, returns false at the end of input
+bool ReadRecord(FILE *in, std::string &key, std::string &value, size_t &line) {
+    key.clear();
+    int c;
+    while ((c = fgetc(in)) != EOF && c != ' ' && c != '\n') {
+        key.push_back(char(c));
+    }
+    line++;
+    if (c == EOF && key.empty()) {
+        return false;
+    }
+    if (c != ' ' || key.empty()) {
+        throw std::runtime_error("Malformed record header at line " + std::to_string(line));
+    }
+
+    size_t bytes = 0;
+    bool digits = false;
+    while ((c = fgetc(in)) >= '0' && c <= '9') {
+        bytes = bytes * 10 + (c - '0');
+        digits = true;
+    }
+    if (c != '\n' || !digits) {
+        throw std::runtime_error("Malformed record size at line " + std::to_string(line));
+    }
+
+    value.resize(bytes);
+    if (bytes > 0 && fread(&value[0], 1, bytes, in) != bytes) {
+        throw std::runtime_error("Truncated value of " + key);
+    }
+    for (size_t i = 0; i < bytes; i++) {
+        line += value[i] == '\n';
+    }
+    if (fgetc(in) != '\n') {
+        throw std::runtime_error("Value of " + key + " is not terminated by new line");
+    }
+    line++;
+    return true;
+}
+
+} // namespace
+
+// Builds dataset file for "mapped" storage out of key/value dump
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <dump|-> <dataset>" << std::endl;
+        std::cerr << "Dump is a sequence of records: <key> <bytes>\\n<data>\\n" << std::endl;
+        return 1;
+    }
+
+    std::string input = argv[1];
+    FILE *in = input == "-" ? stdin : fopen(input.c_str(), "rb");
+    if (in == nullptr) {
+        std::cerr << "Failed to open " << input << std::endl;
+        return 1;
+    }
+
+    try {
+        DatasetBuilder builder;
+        std::string key, value;
+        size_t line = 0;
+        while (ReadRecord(in, key, value, line)) {
+            builder.Add(key, value);
+        }
+
+        builder.Write(argv[2]);
+        std::cout << "Written " << builder.count() << " records to " << argv[2] << std::endl;
+    } catch (std::exception &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}